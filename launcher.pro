@@ -7,7 +7,7 @@
 #          published by the Free Software Foundation.
 #
 
-QT += core gui widgets
+QT += core gui widgets sql
 
 TARGET = launcher
 TEMPLATE = app
@@ -34,7 +34,11 @@ SOURCES += \
     src/systemhotkey.cpp \
     src/searchexpression.cpp \
     src/xmlitemsource.cpp \
+    src/fastxmlitemsource.cpp \
     src/csvitemsource.cpp \
+    src/jsonitemsource.cpp \
+    src/sqliteitemsource.cpp \
+    src/gzipdevice.cpp \
     src/searchwindow.cpp \
     src/linkitem.cpp \
     src/importitem.cpp \
@@ -43,11 +47,18 @@ SOURCES += \
     src/importitemreader.cpp \
     src/searchitemproxymodel.cpp \
     src/searchitemfiltermodel.cpp \
+    src/searchitempagemodel.cpp \
     src/itemsourceeditor.cpp \
     src/itemsourcehighlighter.cpp \
     src/itemsourceposition.cpp \
     src/searchbarwidget.cpp \
-    src/item.cpp
+    src/item.cpp \
+    src/catalogsnapshot.cpp \
+    src/catalogitemsource.cpp \
+    src/itemarena.cpp \
+    src/itempalette.cpp \
+    src/itemsourcestatistics.cpp \
+    src/stringpool.cpp
 
 HEADERS += \
     src/itemdelegate.h \
@@ -59,8 +70,12 @@ HEADERS += \
     src/searchexpression.h \
     src/itemsource.h \
     src/xmlitemsource.h \
+    src/fastxmlitemsource.h \
     src/itemsourcefactory.h \
     src/csvitemsource.h \
+    src/jsonitemsource.h \
+    src/sqliteitemsource.h \
+    src/gzipdevice.h \
     src/searchwindow.h \
     src/linkitem.h \
     src/item.h \
@@ -74,23 +89,31 @@ HEADERS += \
     src/importitemreader.h \
     src/searchitemproxymodel.h \
     src/searchitemfiltermodel.h \
+    src/searchitempagemodel.h \
     src/itemsourceeditor.h \
     src/itemsourcehighlighter.h \
     src/itemsourceposition.h \
     src/metatype.h \
     src/searchbarwidget.h \
-    src/searchresultwidget.h
+    src/searchresultwidget.h \
+    src/catalogsnapshot.h \
+    src/catalogitemsource.h \
+    src/itemarena.h \
+    src/itempalette.h \
+    src/itemsourcestatistics.h \
+    src/stringpool.h
 
 RESOURCES += \
     resources/resources.qrc
 
 unix {
-   LIBS += -lxcb
+   LIBS += -lxcb -lz
    QT += x11extras
 }
 
 win32 {
    LIBS += user32.lib
+   INCLUDEPATH += $$[QT_INSTALL_HEADERS]/QtZlib
    RC_ICONS  = resources/images/logo.ico
 }
 
@@ -10,14 +10,19 @@
 #include <QHideEvent>
 #include <QSettings>
 #include <QShowEvent>
+#include <QThread>
 
 #include "application.h"
+#include "catalogitemsource.h"
 #include "csvitemsource.h"
 #include "event.h"
+#include "fastxmlitemsource.h"
 #include "importgroupitem.h"
 #include "importitem.h"
+#include "jsonitemsource.h"
 #include "linkgroupitem.h"
 #include "linkitem.h"
+#include "sqliteitemsource.h"
 #include "xmlitemsource.h"
 
 Application::Application(int& argc, char** argv) : QApplication(argc, argv),
@@ -33,8 +38,33 @@ Application::Application(int& argc, char** argv) : QApplication(argc, argv),
    itemFactory_.declare<LinkItem>(Item::Type::Link, tr("Link Item"));
    itemFactory_.declare<LinkGroupItem>(Item::Type::LinkGroup, tr("Link Group Item"));
 
+   itemSourceFactory_.declare<CatalogItemSource>(QStringLiteral("application/x-launcher-catalog"));
    itemSourceFactory_.declare<CsvItemSource>(QStringLiteral("text/csv"));
-   itemSourceFactory_.declare<XmlItemSource>(QStringLiteral("text/xml"));
+   itemSourceFactory_.declare<JsonItemSource>(QStringLiteral("application/json"));
+   itemSourceFactory_.declare<SqliteItemSource>(QStringLiteral("application/vnd.sqlite3"));
+
+   //
+   // The application has no meta-object of its own, so its settings are read using their full
+   // keys rather than keys derived from the class name (which would be QApplication).
+   //
+
+   SqliteItemSource::setSearchLimit(setting<int>(QStringLiteral("Application/sqliteSearchLimit"), SqliteItemSource::searchLimit()));
+
+   //
+   // The XML parser specialized for the schema is opt-in; both parsers yield identical items.
+   //
+
+   fastXmlParser_ = setting<bool>(QStringLiteral("Application/fastXmlParser"), false);
+   if (fastXmlParser_)
+   {
+      FastXmlItemSource::setThreadCount(setting<int>(QStringLiteral("Application/parserThreadCount"), QThread::idealThreadCount()));
+
+      itemSourceFactory_.declare<FastXmlItemSource>(QStringLiteral("text/xml"));
+   }
+   else
+   {
+      itemSourceFactory_.declare<XmlItemSource>(QStringLiteral("text/xml"));
+   }
 }
 
 void Application::updateGeometry(QWidget* widget, const QRect& defaultGeometry)
@@ -78,6 +78,16 @@ public:
       return setting<Type>(settingKey_(object, key), defaultValue);
    }
 
+   /*!
+    * Returns \a true if XML files are read using the parser specialized for the schema
+    * (FastXmlItemSource) as selected by the Application/fastXmlParser setting on construction;
+    * \a false otherwise.
+    */
+   bool isFastXmlParser() const
+   {
+      return fastXmlParser_;
+   }
+
    /*!
     * Updates the geometry for the widget \a widget to the stored geometry or the default
     * geometry \a defaultGeometry if no geometry is stored.
@@ -90,6 +100,11 @@ private:
     */
    QSettings settings_;
 
+   /*!
+    * Is \a true if XML files are read using the parser specialized for the schema.
+    */
+   bool fastXmlParser_ = false;
+
    /*!
     * The item factory.
     */
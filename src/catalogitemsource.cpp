@@ -0,0 +1,331 @@
+/*!
+ * \file catalogitemsource.cpp
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include <QBuffer>
+#include <QColor>
+#include <QDataStream>
+#include <QHash>
+#include <QObject>
+
+#include "catalogitemsource.h"
+#include "linkgroupitem.h"
+#include "linkitem.h"
+#include "stringpool.h"
+
+namespace {
+
+/*!
+ * The magic number identifying a compiled catalog file.
+ */
+static const quint32 CATALOG_MAGIC_ = 0x4c434154; // 'LCAT'
+
+/*!
+ * The data stream version used for the compiled catalog.
+ */
+static const QDataStream::Version CATALOG_STREAM_VERSION_ = QDataStream::Qt_5_6;
+
+/*!
+ * The string index denoting no string.
+ */
+static const quint32 NO_STRING_ = std::numeric_limits<quint32>::max();
+
+/*!
+ * \brief A link item with its effective properties, as stored in a compiled catalog.
+ */
+struct CatalogItem
+{
+   /*!
+    * The index of the name.
+    */
+   quint32 name = NO_STRING_;
+   /*!
+    * The index of the link.
+    */
+   quint32 link = NO_STRING_;
+   /*!
+    * The index of the color name or NO_STRING_ if the item has no color.
+    */
+   quint32 color = NO_STRING_;
+   /*!
+    * The indices of the tags.
+    */
+   QVector<quint32> tags;
+};
+
+/*!
+ * \brief A table of distinct strings, each referenced by its index.
+ */
+class StringTable
+{
+public:
+   /*!
+    * Returns the index of the string \a string, adding it to the table if not yet present.
+    */
+   quint32 index(const QString& string)
+   {
+      auto stringIndex = stringIndices_.constFind(string);
+      if (stringIndex != stringIndices_.constEnd())
+      {
+         return stringIndex.value();
+      }
+
+      strings_.append(string);
+
+      return stringIndices_.insert(string, static_cast<quint32>(strings_.size() - 1)).value();
+   }
+
+   /*!
+    * Returns the strings of the table, in the order of their indices.
+    */
+   const QVector<QString>& strings() const
+   {
+      return strings_;
+   }
+
+private:
+   /*!
+    * The strings of the table.
+    */
+   QVector<QString> strings_;
+   /*!
+    * The index of each string of the table.
+    */
+   QHash<QString, quint32> stringIndices_;
+};
+
+} // namespace
+
+bool CatalogItemSource::read(QIODevice* device, const QString& identifier)
+{
+   bool result = false;
+
+   ItemSource::setIdentifier(identifier);
+
+   if (device != nullptr)
+   {
+      //
+      // Read the content in place if the device is a buffer, and read it otherwise.
+      //
+
+      auto deviceBuffer = qobject_cast<QBuffer*>(device);
+
+      const QByteArray& content = ((deviceBuffer != nullptr) ? (deviceBuffer->data()) : (device->readAll()));
+
+      result = read(content.constData(), content.size(), identifier);
+   }
+
+   return result;
+}
+
+bool CatalogItemSource::read(const char* data, qint64 size, const QString& identifier)
+{
+   ItemSource::setIdentifier(identifier);
+
+   if (size > std::numeric_limits<int>::max())
+   {
+      errorString_ = QObject::tr("Compiled catalog too large");
+
+      return false;
+   }
+
+   auto content = QByteArray::fromRawData(data, static_cast<int>(size));
+
+   QDataStream stream(content);
+   stream.setVersion(CATALOG_STREAM_VERSION_);
+
+   quint32 magic = 0;
+   quint32 version = 0;
+   quint32 stringCount = 0;
+
+   stream >> magic >> version >> stringCount;
+
+   if ((stream.status() != QDataStream::Ok) || (magic != CATALOG_MAGIC_) || (version != Version))
+   {
+      errorString_ = QObject::tr("Compiled catalog format mismatch");
+
+      return false;
+   }
+
+   //
+   // Intern each distinct string once, so the items share the strings without looking them up.
+   //
+
+   QVector<QString> strings;
+   strings.reserve(static_cast<int>(std::min(stringCount, static_cast<quint32>(size / sizeof(quint32)))));
+
+   for (quint32 stringIndex = 0; ((stream.status() == QDataStream::Ok) && (stringIndex < stringCount)); ++stringIndex)
+   {
+      QString string;
+      stream >> string;
+
+      strings.append(StringPool::intern(string));
+   }
+
+   auto string = [&strings](quint32 stringIndex, bool* valid)
+   {
+      if (stringIndex == NO_STRING_)
+      {
+         return QString();
+      }
+
+      if (stringIndex >= static_cast<quint32>(strings.size()))
+      {
+         *valid = false;
+
+         return QString();
+      }
+
+      return strings[static_cast<int>(stringIndex)];
+   };
+
+   quint32 itemCount = 0;
+   stream >> itemCount;
+
+   bool valid = (stream.status() == QDataStream::Ok);
+   for (quint32 itemIndex = 0; ((valid) && (itemIndex < itemCount)); ++itemIndex)
+   {
+      quint32 name = NO_STRING_;
+      quint32 link = NO_STRING_;
+      quint32 color = NO_STRING_;
+      quint32 tagCount = 0;
+
+      stream >> name >> link >> color >> tagCount;
+
+      auto item = createItem<LinkItem>();
+      item->setName(string(name, &valid));
+      item->setLink(string(link, &valid));
+      item->setBrushIndex(ItemPalette::index(string(color, &valid)));
+
+      QStringList tags;
+      for (quint32 tagIndex = 0; ((stream.status() == QDataStream::Ok) && (tagIndex < tagCount)); ++tagIndex)
+      {
+         quint32 tag = NO_STRING_;
+         stream >> tag;
+
+         tags.append(string(tag, &valid));
+      }
+      item->setTags(tags);
+
+      valid = (valid && (stream.status() == QDataStream::Ok));
+
+      appendItem(this, item);
+   }
+
+   if (!valid)
+   {
+      errorString_ = QObject::tr("Compiled catalog corrupt");
+   }
+
+   return valid;
+}
+
+bool CatalogItemSource::write(QIODevice* device) const
+{
+   QVector<const LinkItem*> linkItems;
+   linkItems.reserve(itemCount());
+
+   for (const auto& item : items())
+   {
+      if (auto linkItem = Item::cast<LinkItem>(item))
+      {
+         linkItems.append(linkItem);
+      }
+   }
+
+   return write(device, linkItems);
+}
+
+bool CatalogItemSource::write(QIODevice* device, const QVector<const LinkItem*>& items)
+{
+   Q_ASSERT(device != nullptr);
+
+   //
+   // Resolve the effective tags and color of each item, just as the search model does, and sort
+   // the items by name, so the catalog is read in the order the items are displayed.
+   //
+
+   StringTable stringTable;
+
+   QVector<CatalogItem> catalogItems;
+   catalogItems.reserve(items.size());
+
+   QVector<const LinkItem*> sortedItems = items;
+   std::stable_sort(sortedItems.begin(), sortedItems.end(), [](const LinkItem* left, const LinkItem* right)
+   {
+      return (QString::compare(left->name(), right->name(), Qt::CaseInsensitive) < 0);
+   });
+
+   for (auto item : sortedItems)
+   {
+      QStringList tags = item->tags();
+      QBrush brush = item->brush();
+
+      for (auto parentItem = item->parent<LinkGroupItem>(); parentItem != nullptr; parentItem = parentItem->parent<LinkGroupItem>())
+      {
+         tags.append(parentItem->tags());
+
+         if (brush.style() == Qt::NoBrush)
+         {
+            brush = parentItem->brush();
+         }
+      }
+
+      tags.sort(Qt::CaseInsensitive);
+      tags.removeDuplicates();
+
+      CatalogItem catalogItem;
+      catalogItem.name = stringTable.index(item->name());
+      catalogItem.link = stringTable.index(item->link());
+      catalogItem.color = ((brush.style() != Qt::NoBrush) ? (stringTable.index(brush.color().name(QColor::HexArgb))) : (NO_STRING_));
+
+      for (const auto& tag : tags)
+      {
+         catalogItem.tags.append(stringTable.index(tag));
+      }
+
+      catalogItems.append(catalogItem);
+   }
+
+   QDataStream stream(device);
+   stream.setVersion(CATALOG_STREAM_VERSION_);
+
+   stream << CATALOG_MAGIC_ << Version << static_cast<quint32>(stringTable.strings().size());
+
+   for (const auto& string : stringTable.strings())
+   {
+      stream << string;
+   }
+
+   stream << static_cast<quint32>(catalogItems.size());
+
+   for (const auto& catalogItem : catalogItems)
+   {
+      stream << catalogItem.name << catalogItem.link << catalogItem.color << static_cast<quint32>(catalogItem.tags.size());
+
+      for (auto tag : catalogItem.tags)
+      {
+         stream << tag;
+      }
+   }
+
+   return (stream.status() == QDataStream::Ok);
+}
+
+QString CatalogItemSource::errorString() const
+{
+   return errorString_;
+}
+
+QPoint CatalogItemSource::errorPosition() const
+{
+   return QPoint();
+}
@@ -0,0 +1,74 @@
+/*!
+ * \file catalogitemsource.h
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#ifndef CATALOGITEMSOURCE_H
+#define CATALOGITEMSOURCE_H
+
+#include <QVector>
+
+#include "itemsource.h"
+
+class LinkItem;
+
+/*!
+ * \brief An item source represented as compiled catalog.
+ *
+ * A compiled catalog is a flattened, read-only catalog produced from a fully resolved catalog
+ * (see ItemModel::write()). It contains a table of the distinct strings and the link items only,
+ * each with its effective tags (including the tags of the groups it was contained in) and its
+ * effective color, sorted by name. Neither imports nor groups remain, so the catalog is read
+ * without any further resolution. Environment variables in links are kept unresolved, so they
+ * are resolved by each client reading the catalog.
+ */
+class CatalogItemSource : public ItemSource
+{
+public:
+   /*!
+    * The version of the compiled catalog format. Any change to the format must increase the
+    * version.
+    */
+   static const quint32 Version = 1;
+
+   /*!
+    * \reimp
+    */
+   bool read(QIODevice* device, const QString& identifier) override;
+   /*!
+    * \reimp
+    */
+   bool read(const char* data, qint64 size, const QString& identifier) override;
+   /*!
+    * \reimp
+    */
+   bool write(QIODevice* device) const override;
+
+   /*!
+    * Writes a compiled catalog containing the link items \a items to the device \a device and
+    * returns \a true if the catalog could be written; \a false otherwise. The effective tags and
+    * color of each item are resolved from the groups it is contained in.
+    */
+   static bool write(QIODevice* device, const QVector<const LinkItem*>& items);
+
+   /*!
+    * \reimp
+    */
+   QString errorString() const override;
+   /*!
+    * \reimp
+    */
+   QPoint errorPosition() const override;
+
+private:
+   /*!
+    * The compiled catalog error.
+    */
+   QString errorString_;
+};
+
+#endif // CATALOGITEMSOURCE_H
@@ -0,0 +1,684 @@
+/*!
+ * \file catalogsnapshot.cpp
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#include <limits>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStringList>
+
+#include "application.h"
+#include "catalogsnapshot.h"
+#include "importgroupitem.h"
+#include "importitem.h"
+#include "itemsource.h"
+#include "linkgroupitem.h"
+#include "linkitem.h"
+#include "stringpool.h"
+
+namespace {
+
+/*!
+ * The magic number identifying a snapshot file.
+ */
+static const quint32 SNAPSHOT_MAGIC_ = 0x4c534e50; // 'LSNP'
+
+/*!
+ * The data stream version used for the snapshot.
+ */
+static const QDataStream::Version SNAPSHOT_STREAM_VERSION_ = QDataStream::Qt_5_6;
+
+/*!
+ * Returns \a true if the XML parser specialized for the schema is used; \a false otherwise.
+ */
+bool isFastXmlParser()
+{
+   return static_cast<Application*>(Application::instance())->isFastXmlParser();
+}
+
+/*!
+ * Writes the item \a item and all its children to the stream \a stream.
+ */
+void writeItem(QDataStream& stream, const Item* item);
+
+/*!
+ * Writes the children of the group item \a groupItem to the stream \a stream.
+ */
+void writeItems(QDataStream& stream, const GroupItem* groupItem)
+{
+   stream << static_cast<quint32>(groupItem->itemCount());
+
+   for (const auto& item : groupItem->items())
+   {
+      writeItem(stream, item);
+   }
+}
+
+void writeItem(QDataStream& stream, const Item* item)
+{
+   stream << static_cast<quint8>(item->type());
+
+   if (auto linkItem = Item::cast<LinkItem>(item))
+   {
+      stream << linkItem->name()
+             << linkItem->link()
+             << static_cast<qint32>(linkItem->linkPosition().lineNumber())
+             << static_cast<qint32>(linkItem->linkPosition().columnNumber())
+             << static_cast<qint32>(linkItem->linkPosition().size())
+             << linkItem->brush()
+             << linkItem->tags();
+   }
+   else if (auto linkGroupItem = Item::cast<LinkGroupItem>(item))
+   {
+      stream << linkGroupItem->name()
+             << linkGroupItem->tags()
+             << linkGroupItem->brush();
+
+      writeItems(stream, linkGroupItem);
+   }
+   else if (auto importGroupItem = Item::cast<ImportGroupItem>(item))
+   {
+      writeItems(stream, importGroupItem);
+   }
+   else if (auto importItem = Item::cast<ImportItem>(item))
+   {
+      stream << importItem->file()
+             << importItem->mimeType()
+             << importItem->contentEncoding();
+   }
+}
+
+/*!
+ * Reads an item of the item source \a itemSource from the stream \a stream and appends it to
+ * the group item \a parent. Returns \a true if the item could be read; \a false otherwise.
+ */
+bool readItem(QDataStream& stream, ItemSource* itemSource, GroupItem* parent);
+
+/*!
+ * Reads the children of the group item \a groupItem of the item source \a itemSource from the
+ * stream \a stream. Returns \a true if the children could be read; \a false otherwise.
+ */
+bool readItems(QDataStream& stream, ItemSource* itemSource, GroupItem* groupItem)
+{
+   quint32 itemCount = 0;
+   stream >> itemCount;
+
+   bool result = (stream.status() == QDataStream::Ok);
+   for (quint32 itemIndex = 0; ((result) && (itemIndex < itemCount)); ++itemIndex)
+   {
+      result = readItem(stream, itemSource, groupItem);
+   }
+
+   return result;
+}
+
+bool readItem(QDataStream& stream, ItemSource* itemSource, GroupItem* parent)
+{
+   quint8 type = 0;
+   stream >> type;
+
+   bool result = (stream.status() == QDataStream::Ok);
+   if (result)
+   {
+      switch (static_cast<Item::Type>(type))
+      {
+      case Item::Type::Link:
+      {
+         QString name;
+         QString link;
+         qint32 lineNumber = 0;
+         qint32 columnNumber = 0;
+         qint32 size = 0;
+         QBrush brush;
+         QStringList tags;
+
+         stream >> name >> link >> lineNumber >> columnNumber >> size >> brush >> tags;
+
+         auto item = itemSource->createItem<LinkItem>();
+         item->setName(StringPool::intern(name));
+         item->setResolvedLink(link);
+         item->setLinkPosition(ItemSourcePosition(lineNumber, columnNumber, size));
+         item->setBrush(brush);
+         item->setTags(StringPool::intern(tags));
+
+         parent->insertItem(item, parent->itemCount());
+
+         break;
+      }
+      case Item::Type::LinkGroup:
+      {
+         QString name;
+         QStringList tags;
+         QBrush brush;
+
+         stream >> name >> tags >> brush;
+
+         auto item = itemSource->createItem<LinkGroupItem>();
+         item->setName(StringPool::intern(name));
+         item->setTags(StringPool::intern(tags));
+         item->setBrush(brush);
+
+         parent->insertItem(item, parent->itemCount());
+
+         result = readItems(stream, itemSource, item);
+
+         break;
+      }
+      case Item::Type::ImportGroup:
+      {
+         auto item = itemSource->createItem<ImportGroupItem>();
+
+         parent->insertItem(item, parent->itemCount());
+
+         result = readItems(stream, itemSource, item);
+
+         break;
+      }
+      case Item::Type::Import:
+      {
+         QString file;
+         QString mimeType;
+         QString contentEncoding;
+
+         stream >> file >> mimeType >> contentEncoding;
+
+         auto item = itemSource->createItem<ImportItem>(file, StringPool::intern(mimeType));
+         item->setContentEncoding(StringPool::intern(contentEncoding));
+
+         parent->insertItem(item, parent->itemCount());
+
+         break;
+      }
+      default:
+      {
+         result = false;
+
+         break;
+      }
+      }
+   }
+
+   return (result && (stream.status() == QDataStream::Ok));
+}
+
+} // namespace
+
+CatalogSnapshot::CatalogSnapshot(const QString& itemSourceFile) : itemSourceFile_(QFileInfo(itemSourceFile).absoluteFilePath())
+{
+   //
+   // The snapshot is stored in the cache location, named after the hash of the absolute path of
+   // the item source file, so different catalogs do not share a snapshot.
+   //
+
+   fileName_ = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/") +
+               QString::fromLatin1(QCryptographicHash::hash(itemSourceFile_.toUtf8(), QCryptographicHash::Sha1).toHex()) +
+               QStringLiteral(".snapshot");
+}
+
+bool CatalogSnapshot::read()
+{
+   itemSources_.clear();
+   dependencies_.clear();
+
+   QFile file(fileName_);
+   if (!file.open(QIODevice::ReadOnly))
+   {
+      errorString_ = file.errorString();
+
+      return false;
+   }
+
+   if (file.size() > std::numeric_limits<int>::max())
+   {
+      errorString_ = QObject::tr("Snapshot too large");
+
+      return false;
+   }
+
+   //
+   // Map the snapshot into memory, so it is not copied before being decoded. If the file cannot
+   // be mapped (for instance because it resides on a file system not supporting it) fall back to
+   // reading it.
+   //
+
+   QByteArray content;
+
+   auto fileData = file.map(0, file.size());
+   if (fileData != nullptr)
+   {
+      content = QByteArray::fromRawData(reinterpret_cast<const char*>(fileData), static_cast<int>(file.size()));
+   }
+   else
+   {
+      content = file.readAll();
+   }
+
+   QDataStream stream(content);
+   stream.setVersion(SNAPSHOT_STREAM_VERSION_);
+
+   bool result = readHeader_(stream);
+
+   //
+   // Read the item sources, one for each dependency.
+   //
+
+   for (const auto& dependency : dependencies_)
+   {
+      if (!result)
+      {
+         break;
+      }
+
+      std::unique_ptr<ItemSource> itemSource = static_cast<Application*>(Application::instance())->itemSourceFactory()->create(dependency.mimeType);
+      if (itemSource)
+      {
+         itemSource->setIdentifier(dependency.identifier);
+
+         result = readItems(stream, itemSource.get(), itemSource.get());
+         if (result)
+         {
+            itemSources_.push_back(std::move(itemSource));
+         }
+         else
+         {
+            errorString_ = QObject::tr("Snapshot corrupt");
+         }
+      }
+      else
+      {
+         result = false;
+
+         errorString_ = QObject::tr("Invalid MIME type: ").append(dependency.mimeType);
+      }
+   }
+
+   if (fileData != nullptr)
+   {
+      file.unmap(fileData);
+   }
+
+   if (!result)
+   {
+      itemSources_.clear();
+      dependencies_.clear();
+   }
+
+   return result;
+}
+
+bool CatalogSnapshot::isCurrent(const QVector<Dependency>& dependencies)
+{
+   itemSources_.clear();
+   dependencies_.clear();
+
+   //
+   // Just the header is read, which is validated as by read(), and the dependencies recorded
+   // must match the dependencies supplied, including their content hashes.
+   //
+
+   QFile file(fileName_);
+   if (!file.open(QIODevice::ReadOnly))
+   {
+      return false;
+   }
+
+   QDataStream stream(&file);
+   stream.setVersion(SNAPSHOT_STREAM_VERSION_);
+
+   bool result = ((readHeader_(stream)) && (dependencies_.size() == dependencies.size()));
+   for (int dependencyIndex = 0; ((result) && (dependencyIndex < dependencies.size())); ++dependencyIndex)
+   {
+      const auto& snapshotDependency = dependencies_.at(dependencyIndex);
+      const auto& dependency = dependencies.at(dependencyIndex);
+
+      result = ((snapshotDependency.file == dependency.file) &&
+                (snapshotDependency.identifier == dependency.identifier) &&
+                (snapshotDependency.mimeType == dependency.mimeType) &&
+                (snapshotDependency.size == dependency.size) &&
+                (snapshotDependency.lastModified.toMSecsSinceEpoch() == dependency.lastModified.toMSecsSinceEpoch()) &&
+                (snapshotDependency.hash == dependency.hash) &&
+                (snapshotDependency.hashSize == dependency.hashSize));
+   }
+
+   dependencies_.clear();
+
+   return result;
+}
+
+bool CatalogSnapshot::readHeader_(QDataStream& stream)
+{
+   //
+   // Validate the header, which must match the magic number, the version and the item source
+   // file the snapshot has been created for.
+   //
+
+   quint32 magic = 0;
+   quint32 version = 0;
+   QString itemSourceFile;
+
+   stream >> magic >> version >> itemSourceFile;
+
+   bool result = ((stream.status() == QDataStream::Ok) && (magic == SNAPSHOT_MAGIC_) && (version == Version) && (itemSourceFile == itemSourceFile_));
+   if (!result)
+   {
+      errorString_ = QObject::tr("Snapshot format or source mismatch");
+   }
+
+   //
+   // Validate the settings affecting the items read, and the value of each environment variable
+   // the links have been resolved with, which must be (or not be) defined just as before.
+   //
+
+   if (result)
+   {
+      bool processEnvironmentDeferred = false;
+      bool fastXmlParser = false;
+
+      stream >> processEnvironmentDeferred >> fastXmlParser;
+
+      result = ((stream.status() == QDataStream::Ok) &&
+                (processEnvironmentDeferred == Item::isProcessEnvironmentDeferred()) &&
+                (fastXmlParser == isFastXmlParser()));
+      if (!result)
+      {
+         errorString_ = QObject::tr("Snapshot settings changed");
+      }
+   }
+
+   quint32 processEnvironmentCount = 0;
+   if (result)
+   {
+      stream >> processEnvironmentCount;
+   }
+
+   for (quint32 processEnvironmentIndex = 0; ((result) && (processEnvironmentIndex < processEnvironmentCount)); ++processEnvironmentIndex)
+   {
+      QString name;
+      QString value;
+
+      stream >> name >> value;
+
+      result = ((stream.status() == QDataStream::Ok) &&
+                (value.isNull() == Item::processEnvironmentValue(name).isNull()) &&
+                (value == Item::processEnvironmentValue(name)));
+      if (!result)
+      {
+         errorString_ = QObject::tr("Snapshot environment changed: ").append(name);
+      }
+   }
+
+   quint32 dependencyCount = 0;
+   if (result)
+   {
+      stream >> dependencyCount;
+   }
+
+   //
+   // Validate the dependencies, which must still exist and must match in size and modification
+   // time. The content hash is not validated here, as this would require reading all of the
+   // files, which is exactly what the snapshot is meant to avoid; use CatalogSnapshotValidator.
+   //
+
+   for (quint32 dependencyIndex = 0; ((result) && (dependencyIndex < dependencyCount)); ++dependencyIndex)
+   {
+      Dependency dependency;
+      qint64 lastModified = 0;
+
+      stream >> dependency.file >> dependency.identifier >> dependency.mimeType >> dependency.size >> lastModified >> dependency.hash >> dependency.hashSize;
+
+      dependency.lastModified = QDateTime::fromMSecsSinceEpoch(lastModified);
+
+      QFileInfo dependencyFileInfo(dependency.file);
+
+      result = ((stream.status() == QDataStream::Ok) &&
+                (dependencyFileInfo.exists()) &&
+                (dependencyFileInfo.size() == dependency.size) &&
+                (dependencyFileInfo.lastModified().toMSecsSinceEpoch() == lastModified));
+      if (result)
+      {
+         dependencies_.append(dependency);
+      }
+      else
+      {
+         errorString_ = QObject::tr("Snapshot dependency changed: ").append(dependency.file);
+      }
+   }
+
+   return result;
+}
+
+bool CatalogSnapshot::write(const QVector<const ItemSource*>& itemSources, const QVector<Dependency>& dependencies)
+{
+   Q_ASSERT(itemSources.size() == dependencies.size());
+
+   QDir().mkpath(QFileInfo(fileName_).absolutePath());
+
+   QSaveFile file(fileName_);
+   if (!file.open(QIODevice::WriteOnly))
+   {
+      errorString_ = file.errorString();
+
+      return false;
+   }
+
+   QDataStream stream(&file);
+   stream.setVersion(SNAPSHOT_STREAM_VERSION_);
+
+   stream << SNAPSHOT_MAGIC_ << Version << itemSourceFile_;
+
+   //
+   // Links are stored as they have been resolved, so the snapshot depends on the settings and the
+   // environment variables they have been resolved with; deferred links are stored unresolved.
+   //
+
+   stream << Item::isProcessEnvironmentDeferred() << isFastXmlParser();
+
+   QStringList processEnvironmentReferences;
+   if (!Item::isProcessEnvironmentDeferred())
+   {
+      processEnvironmentReferences = Item::processEnvironmentReferences();
+   }
+
+   stream << static_cast<quint32>(processEnvironmentReferences.size());
+
+   for (const auto& processEnvironmentReference : processEnvironmentReferences)
+   {
+      stream << processEnvironmentReference << Item::processEnvironmentValue(processEnvironmentReference);
+   }
+
+   stream << static_cast<quint32>(dependencies.size());
+
+   for (const auto& dependency : dependencies)
+   {
+      stream << dependency.file
+             << dependency.identifier
+             << dependency.mimeType
+             << dependency.size
+             << dependency.lastModified.toMSecsSinceEpoch()
+             << dependency.hash
+             << dependency.hashSize;
+   }
+
+   for (const auto& itemSource : itemSources)
+   {
+      //
+      // The items of searchable item sources are created on demand, so none are stored.
+      //
+
+      if (itemSource->isSearchable())
+      {
+         stream << static_cast<quint32>(0);
+      }
+      else
+      {
+         writeItems(stream, itemSource);
+      }
+   }
+
+   //
+   // A snapshot exceeding 2 GiB could not be read again, so it is not written at all.
+   //
+
+   if ((stream.status() == QDataStream::Ok) && (file.size() > std::numeric_limits<int>::max()))
+   {
+      file.cancelWriting();
+
+      errorString_ = QObject::tr("Snapshot too large");
+
+      return false;
+   }
+
+   bool result = ((stream.status() == QDataStream::Ok) && (file.commit()));
+   if (!result)
+   {
+      errorString_ = file.errorString();
+   }
+
+   return result;
+}
+
+void CatalogSnapshot::remove()
+{
+   QFile::remove(fileName_);
+}
+
+std::vector<std::unique_ptr<ItemSource>> CatalogSnapshot::releaseItemSources()
+{
+   return std::move(itemSources_);
+}
+
+QByteArray CatalogSnapshot::hash(const QByteArray& content)
+{
+   return QCryptographicHash::hash(content, QCryptographicHash::Sha1);
+}
+
+QByteArray CatalogSnapshot::hash(const char* data, qint64 size)
+{
+   QCryptographicHash hash(QCryptographicHash::Sha1);
+
+   //
+   // QCryptographicHash::addData() takes the size as int, so add the content in chunks.
+   //
+
+   while (size > 0)
+   {
+      int chunkSize = static_cast<int>(qMin(size, static_cast<qint64>(std::numeric_limits<int>::max())));
+
+      hash.addData(data, chunkSize);
+
+      data += chunkSize;
+      size -= chunkSize;
+   }
+
+   return hash.result();
+}
+
+void CatalogSnapshotWriter::run()
+{
+   {
+      QMutexLocker locker(&mutex_);
+
+      if (!canceled_)
+      {
+         //
+         // A snapshot taken from the same dependencies is not written again, for instance when
+         // the catalog is reloaded although the files have just been touched.
+         //
+
+         CatalogSnapshot snapshot(itemSourceFile_);
+         if (snapshot.isCurrent(dependencies_))
+         {
+            qInfo() << "snapshot unchanged" << snapshot.fileName();
+         }
+         else if (snapshot.write(itemSources_, dependencies_))
+         {
+            qInfo() << "write snapshot" << snapshot.fileName();
+         }
+         else
+         {
+            qWarning() << "write snapshot failed" << snapshot.fileName() << snapshot.errorString();
+         }
+      }
+   }
+
+   emit finished();
+}
+
+void CatalogSnapshotWriter::cancel()
+{
+   QMutexLocker locker(&mutex_);
+
+   canceled_ = true;
+}
+
+void CatalogSnapshotValidator::run()
+{
+   for (const auto& dependency : dependencies_)
+   {
+      //
+      // The hash is calculated over the raw content of the file, just as the import item reader
+      // does, mapping the file into memory if possible. If the hash covers just the start of the
+      // file just that part is read, and the size and the modification time are validated as
+      // well, as they are the only indication of a change to the rest of the file.
+      //
+
+      QFile file(dependency.file);
+      if (!file.open(QIODevice::ReadOnly))
+      {
+         emit dependencyChanged(dependency.file);
+
+         return;
+      }
+
+      QByteArray hash;
+
+      if (dependency.hashSize >= 0)
+      {
+         if ((file.size() != dependency.size) || (QFileInfo(file).lastModified().toMSecsSinceEpoch() != dependency.lastModified.toMSecsSinceEpoch()))
+         {
+            emit dependencyChanged(dependency.file);
+
+            return;
+         }
+
+         hash = CatalogSnapshot::hash(file.read(dependency.hashSize));
+      }
+      else
+      {
+         auto fileData = ((file.size() > 0) ? (file.map(0, file.size())) : (nullptr));
+         if (fileData != nullptr)
+         {
+            hash = CatalogSnapshot::hash(reinterpret_cast<const char*>(fileData), file.size());
+
+            file.unmap(fileData);
+         }
+         else
+         {
+            hash = CatalogSnapshot::hash(file.readAll());
+         }
+      }
+
+      if (hash != dependency.hash)
+      {
+         emit dependencyChanged(dependency.file);
+
+         return;
+      }
+   }
+
+   emit dependenciesValid();
+}
@@ -0,0 +1,300 @@
+/*!
+ * \file catalogsnapshot.h
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#ifndef CATALOGSNAPSHOT_H
+#define CATALOGSNAPSHOT_H
+
+#include <memory>
+#include <vector>
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QMutex>
+#include <QObject>
+#include <QRunnable>
+#include <QString>
+#include <QUuid>
+#include <QVector>
+
+class QDataStream;
+
+class ItemSource;
+
+/*!
+ * \brief A binary snapshot of a fully resolved catalog.
+ *
+ * The snapshot contains all item sources read for a catalog along with the metadata (size,
+ * modification time and content hash) of each file an item source was read from. The items are
+ * stored as a compact binary stream which is decoded into item sources on startup; this still
+ * allocates every item, but avoids parsing, resolving and validating any of the original
+ * sources.
+ *
+ * As links are stored with their environment variables resolved (and are restored as they are,
+ * without resolving them again), the snapshot also records the environment variables referenced
+ * by the catalog along with their values, and the settings
+ * affecting the items read (whether environment variables are deferred and which XML parser is
+ * used). A snapshot is rejected if the format version, any of these settings or variables or the
+ * metadata of any of the files it depends on does not match. Snapshots exceeding 2 GiB are not
+ * supported and are rejected as well.
+ */
+class CatalogSnapshot
+{
+public:
+   /*!
+    * The version of the snapshot format. Any change to the format must increase the version.
+    */
+   static const quint32 Version = 4;
+
+   /*!
+    * \brief A file the snapshot depends on.
+    */
+   struct Dependency
+   {
+      /*!
+       * The canonical path of the file.
+       */
+      QString file;
+      /*!
+       * The identifier the item source was read with.
+       */
+      QString identifier;
+      /*!
+       * The MIME type the item source was read with.
+       */
+      QString mimeType;
+      /*!
+       * The size of the file.
+       */
+      qint64 size = -1;
+      /*!
+       * The time the file was last modified.
+       */
+      QDateTime lastModified;
+      /*!
+       * The hash of the content of the file.
+       */
+      QByteArray hash;
+      /*!
+       * The number of bytes at the start of the file the hash covers or a negative value if the
+       * hash covers the whole content.
+       */
+      qint64 hashSize = -1;
+   };
+
+   /*!
+    * Constructs a snapshot for the catalog read from the item source file \a itemSourceFile.
+    */
+   explicit CatalogSnapshot(const QString& itemSourceFile);
+
+   /*!
+    * Returns the name of the file the snapshot is stored in.
+    */
+   QString fileName() const
+   {
+      return fileName_;
+   }
+
+   /*!
+    * Reads the snapshot and returns \a true if the snapshot could be read and is still valid;
+    * \a false otherwise.
+    */
+   bool read();
+   /*!
+    * Returns \a true if the snapshot exists, is still valid (as far as validated by read()) and
+    * has been taken from the dependencies \a dependencies, including their content hashes, so
+    * writing the snapshot would not change it; \a false otherwise. Just the header of the
+    * snapshot is read.
+    */
+   bool isCurrent(const QVector<Dependency>& dependencies);
+   /*!
+    * Writes the item sources \a itemSources along with their dependencies \a dependencies (one
+    * for each item source) to the snapshot and returns \a true if the snapshot could be written;
+    * \a false otherwise.
+    */
+   bool write(const QVector<const ItemSource*>& itemSources, const QVector<Dependency>& dependencies);
+   /*!
+    * Removes the snapshot.
+    */
+   void remove();
+
+   /*!
+    * Returns the item sources read and passes ownership to the caller.
+    */
+   std::vector<std::unique_ptr<ItemSource>> releaseItemSources();
+   /*!
+    * Returns the dependencies read, one for each item source.
+    */
+   const QVector<Dependency>& dependencies() const
+   {
+      return dependencies_;
+   }
+
+   /*!
+    * Returns the string representation of the last error that occurred.
+    */
+   QString errorString() const
+   {
+      return errorString_;
+   }
+
+   /*!
+    * Returns the hash for the content \a content as used for dependencies.
+    */
+   static QByteArray hash(const QByteArray& content);
+   /*!
+    * Returns the hash for the content \a data of size \a size as used for dependencies.
+    */
+   static QByteArray hash(const char* data, qint64 size);
+
+private:
+   /*!
+    * The item source file the catalog is read from.
+    */
+   QString itemSourceFile_;
+   /*!
+    * The name of the file the snapshot is stored in.
+    */
+   QString fileName_;
+
+   /*!
+    * The item sources read.
+    */
+   std::vector<std::unique_ptr<ItemSource>> itemSources_;
+   /*!
+    * The dependencies read.
+    */
+   QVector<Dependency> dependencies_;
+
+   /*!
+    * The last error that occurred.
+    */
+   QString errorString_;
+
+   /*!
+    * Reads and validates the header of the snapshot from the stream \a stream, which includes
+    * the settings, the environment variables and the dependencies, and returns \a true if the
+    * header is still valid; \a false otherwise.
+    */
+   bool readHeader_(QDataStream& stream);
+};
+
+/*!
+ * \brief A runnable writing a snapshot in the background.
+ *
+ * The item sources must neither be modified nor destroyed until the writer has finished or has
+ * been canceled.
+ */
+class CatalogSnapshotWriter : public QObject, public QRunnable
+{
+   Q_OBJECT
+
+public:
+   /*!
+    * Constructs a writer writing the item sources \a itemSources along with their dependencies
+    * \a dependencies to the snapshot for the item source file \a itemSourceFile.
+    */
+   CatalogSnapshotWriter(const QString& itemSourceFile, const QVector<const ItemSource*>& itemSources, const QVector<CatalogSnapshot::Dependency>& dependencies) :
+      itemSourceFile_(itemSourceFile), itemSources_(itemSources), dependencies_(dependencies)
+   {
+   }
+
+   /*!
+    * \reimp
+    */
+   void run() override;
+
+   /*!
+    * Cancels the writer, so the item sources are no longer accessed once this method returns. If
+    * the writer is currently running this method blocks until it has finished.
+    */
+   void cancel();
+
+signals:
+   /*!
+    * Is emitted when the writer has finished, whether or not the snapshot has been written.
+    */
+   void finished();
+
+private:
+   /*!
+    * The item source file the catalog has been read from.
+    */
+   QString itemSourceFile_;
+   /*!
+    * The item sources to be written.
+    */
+   QVector<const ItemSource*> itemSources_;
+   /*!
+    * The dependencies to be written, one for each item source.
+    */
+   QVector<CatalogSnapshot::Dependency> dependencies_;
+
+   /*!
+    * The mutex held while the snapshot is written.
+    */
+   QMutex mutex_;
+   /*!
+    * Is \a true if the writer has been canceled.
+    */
+   bool canceled_ = false;
+};
+
+/*!
+ * \brief A runnable revalidating the content hashes of the dependencies of a snapshot.
+ */
+class CatalogSnapshotValidator : public QObject, public QRunnable
+{
+   Q_OBJECT
+
+public:
+   /*!
+    * Constructs a validator for the dependencies \a dependencies. The supplied identifier is
+    * stored and can be retrieved using identifier().
+    */
+   CatalogSnapshotValidator(const QVector<CatalogSnapshot::Dependency>& dependencies, const QUuid& identifier) :
+      dependencies_(dependencies), identifier_(identifier)
+   {
+   }
+
+   /*!
+    * \reimp
+    */
+   void run() override;
+
+   /*!
+    * Returns the identifier of the validator.
+    */
+   const QUuid& identifier() const
+   {
+      return identifier_;
+   }
+
+signals:
+   /*!
+    * Is emitted when all dependencies are still valid.
+    */
+   void dependenciesValid();
+   /*!
+    * Is emitted when the dependency for the file \a file is no longer valid.
+    */
+   void dependencyChanged(const QString& file);
+
+private:
+   /*!
+    * The dependencies to be validated.
+    */
+   QVector<CatalogSnapshot::Dependency> dependencies_;
+
+   /*!
+    * The identifier to be used.
+    */
+   QUuid identifier_;
+};
+
+#endif // CATALOGSNAPSHOT_H
@@ -7,13 +7,191 @@
  *          published by the Free Software Foundation.
  */
 
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include <QBuffer>
+#include <QHash>
+#include <QIODevice>
+#include <QObject>
+
 #include "csvitemsource.h"
+#include "itempalette.h"
+#include "linkgroupitem.h"
+#include "linkitem.h"
+#include "stringpool.h"
 
-bool CsvItemSource::read(QIODevice* /* device */, const QString& identifier)
+namespace {
+
+/*!
+ * The field delimiter.
+ */
+static const char FIELD_DELIMITER_ = ',';
+/*!
+ * The quote character.
+ */
+static const char FIELD_QUOTE_ = '"';
+/*!
+ * The delimiter between multiple tags within a field.
+ */
+static const QChar TAG_DELIMITER_ = QLatin1Char(';');
+
+/*!
+ * \brief The columns an item is built from.
+ */
+enum class Column
 {
+   Name,
+   Url,
+   Tags,
+   Color,
+   Group,
+
+   Count
+};
+
+/*!
+ * \brief A field of a record.
+ */
+struct Field
+{
+   /*!
+    * The first byte of the field (excluding any quote).
+    */
+   const char* begin = nullptr;
+   /*!
+    * The byte past the last byte of the field (excluding any quote).
+    */
+   const char* end = nullptr;
+   /*!
+    * The line number of the field.
+    */
+   int lineNumber = 0;
+   /*!
+    * The first byte of the line the field begins on.
+    */
+   const char* lineBegin = nullptr;
+   /*!
+    * Is \a true if the field contains escaped quotes.
+    */
+   bool escaped = false;
+};
+
+/*!
+ * Returns \a true if the word \a word contains a byte equal to any byte of \a pattern, which
+ * is a byte repeated across the whole word.
+ */
+inline bool hasByte(quint64 word, quint64 pattern)
+{
+   auto x = (word ^ pattern);
+
+   return (((x - 0x0101010101010101ULL) & ~x & 0x8080808080808080ULL) != 0);
+}
+
+/*!
+ * Returns a pointer to the first field delimiter or line break in the range from \a begin to
+ * \a end or \a end if there is none. The range is scanned a word at a time.
+ */
+const char* findFieldEnd(const char* begin, const char* end)
+{
+   static const quint64 delimiterPattern = (0x0101010101010101ULL * static_cast<quint8>(FIELD_DELIMITER_));
+   static const quint64 lineFeedPattern = (0x0101010101010101ULL * static_cast<quint8>('\n'));
+   static const quint64 carriageReturnPattern = (0x0101010101010101ULL * static_cast<quint8>('\r'));
+
+   auto position = begin;
+
+   for (; (end - position) >= static_cast<std::ptrdiff_t>(sizeof(quint64)); position += sizeof(quint64))
+   {
+      quint64 word;
+      std::memcpy(&word, position, sizeof(word));
+
+      if (hasByte(word, delimiterPattern) || hasByte(word, lineFeedPattern) || hasByte(word, carriageReturnPattern))
+      {
+         break;
+      }
+   }
+
+   for (; position < end; ++position)
+   {
+      if ((*position == FIELD_DELIMITER_) || (*position == '\n') || (*position == '\r'))
+      {
+         break;
+      }
+   }
+
+   return position;
+}
+
+/*!
+ * Returns the number of UTF-16 code units the UTF-8 encoded range from \a begin to \a end is
+ * decoded to.
+ */
+int utf16Size(const char* begin, const char* end)
+{
+   int size = 0;
+
+   for (auto position = begin; position < end; ++position)
+   {
+      auto byte = static_cast<quint8>(*position);
+
+      if ((byte & 0xc0) != 0x80)
+      {
+         size += ((byte >= 0xf0) ? (2) : (1));
+      }
+   }
+
+   return size;
+}
+
+/*!
+ * Returns the content of the field \a field, decoded from UTF-8 and with any escaped quote
+ * unescaped, using the buffer \a buffer for unescaping.
+ */
+QString fieldString(const Field& field, QByteArray* buffer)
+{
+   if (!field.escaped)
+   {
+      return QString::fromUtf8(field.begin, static_cast<int>(field.end - field.begin));
+   }
+
+   buffer->clear();
+
+   for (auto position = field.begin; position < field.end; ++position)
+   {
+      buffer->append(*position);
+
+      if (*position == FIELD_QUOTE_)
+      {
+         ++position;
+      }
+   }
+
+   return QString::fromUtf8(*buffer);
+}
+
+} // namespace
+
+bool CsvItemSource::read(QIODevice* device, const QString& identifier)
+{
+   bool result = false;
+
    ItemSource::setIdentifier(identifier);
 
-   return false;
+   if (device != nullptr)
+   {
+      //
+      // Parse the content in place if the device is a buffer, and read it otherwise.
+      //
+
+      auto deviceBuffer = qobject_cast<QBuffer*>(device);
+
+      const QByteArray& content = ((deviceBuffer != nullptr) ? (deviceBuffer->data()) : (device->readAll()));
+
+      result = read(content.constData(), content.size(), identifier);
+   }
+
+   return result;
 }
 
 bool CsvItemSource::write(QIODevice* /* device */) const
@@ -23,10 +201,265 @@ bool CsvItemSource::write(QIODevice* /* device */) const
 
 QString CsvItemSource::errorString() const
 {
-   return QString();
+   return errorString_;
 }
 
 QPoint CsvItemSource::errorPosition() const
 {
-   return QPoint();
+   return errorPosition_;
+}
+
+bool CsvItemSource::read(const char* data, qint64 size, const QString& identifier)
+{
+   ItemSource::setIdentifier(identifier);
+
+   auto position = data;
+   auto end = (data + size);
+
+   //
+   // Skip the byte order mark, if any.
+   //
+
+   if ((size >= 3) && (std::memcmp(data, "\xef\xbb\xbf", 3) == 0))
+   {
+      position += 3;
+   }
+
+   int lineNumber = 1;
+   auto lineBegin = position;
+
+   std::vector<Field> record;
+   QByteArray fieldBuffer;
+
+   std::array<int, static_cast<std::size_t>(Column::Count)> columns;
+   columns.fill(-1);
+
+   QHash<QString, LinkGroupItem*> groups;
+
+   //
+   // Read record by record, field by field. Fields are just located, and only the fields which
+   // are actually mapped to a column are decoded.
+   //
+
+   for (bool header = true; position < end; header = false)
+   {
+      record.clear();
+
+      for (bool recordEnd = false; !recordEnd; )
+      {
+         Field field;
+         field.lineNumber = lineNumber;
+         field.lineBegin = lineBegin;
+
+         if ((position < end) && (*position == FIELD_QUOTE_))
+         {
+            //
+            // A quoted field ends at the next quote which is not followed by another quote, and
+            // may contain delimiters and line breaks.
+            //
+
+            field.begin = ++position;
+
+            for (;;)
+            {
+               auto quote = static_cast<const char*>(std::memchr(position, FIELD_QUOTE_, static_cast<std::size_t>(end - position)));
+               if (quote == nullptr)
+               {
+                  errorString_ = QObject::tr("Unterminated quoted field");
+                  errorPosition_ = {field.lineNumber, utf16Size(field.lineBegin, field.begin - 1)};
+
+                  return false;
+               }
+
+               for (auto lineFeed = position; (lineFeed = static_cast<const char*>(std::memchr(lineFeed, '\n', static_cast<std::size_t>(quote - lineFeed)))) != nullptr; )
+               {
+                  ++lineNumber;
+
+                  lineBegin = ++lineFeed;
+               }
+
+               if (((quote + 1) < end) && (quote[1] == FIELD_QUOTE_))
+               {
+                  field.escaped = true;
+
+                  position = (quote + 2);
+               }
+               else
+               {
+                  field.end = quote;
+
+                  position = (quote + 1);
+
+                  break;
+               }
+            }
+
+            if ((position < end) && (*position != FIELD_DELIMITER_) && (*position != '\n') && (*position != '\r'))
+            {
+               errorString_ = QObject::tr("Unexpected character after quoted field");
+               errorPosition_ = {lineNumber, utf16Size(lineBegin, position)};
+
+               return false;
+            }
+         }
+         else
+         {
+            field.begin = position;
+            field.end = position = findFieldEnd(position, end);
+         }
+
+         record.push_back(field);
+
+         //
+         // Advance past the delimiter, or the line break which ends the record.
+         //
+
+         if ((position < end) && (*position == FIELD_DELIMITER_))
+         {
+            ++position;
+         }
+         else
+         {
+            if ((position < end) && (*position == '\r'))
+            {
+               ++position;
+            }
+            if ((position < end) && (*position == '\n'))
+            {
+               ++position;
+            }
+
+            ++lineNumber;
+            lineBegin = position;
+
+            recordEnd = true;
+         }
+      }
+
+      if (header)
+      {
+         //
+         // Map the columns by their name.
+         //
+
+         for (std::size_t fieldIndex = 0; fieldIndex < record.size(); ++fieldIndex)
+         {
+            const auto& columnName = fieldString(record[fieldIndex], &fieldBuffer).trimmed().toLower();
+
+            if (columnName == QStringLiteral("name"))
+            {
+               columns[static_cast<std::size_t>(Column::Name)] = static_cast<int>(fieldIndex);
+            }
+            else if ((columnName == QStringLiteral("url")) || (columnName == QStringLiteral("link")))
+            {
+               columns[static_cast<std::size_t>(Column::Url)] = static_cast<int>(fieldIndex);
+            }
+            else if ((columnName == QStringLiteral("tags")) || (columnName == QStringLiteral("tag")))
+            {
+               columns[static_cast<std::size_t>(Column::Tags)] = static_cast<int>(fieldIndex);
+            }
+            else if ((columnName == QStringLiteral("color")) || (columnName == QStringLiteral("colour")))
+            {
+               columns[static_cast<std::size_t>(Column::Color)] = static_cast<int>(fieldIndex);
+            }
+            else if (columnName == QStringLiteral("group"))
+            {
+               columns[static_cast<std::size_t>(Column::Group)] = static_cast<int>(fieldIndex);
+            }
+         }
+
+         if ((columns[static_cast<std::size_t>(Column::Name)] < 0) || (columns[static_cast<std::size_t>(Column::Url)] < 0))
+         {
+            errorString_ = QObject::tr("No name or url column found");
+            errorPosition_ = {1, 0};
+
+            return false;
+         }
+
+         continue;
+      }
+
+      //
+      // Skip empty lines, which consist of a single empty field.
+      //
+
+      if ((record.size() == 1) && (record.front().begin == record.front().end))
+      {
+         continue;
+      }
+
+      auto column = [&record, &columns](Column column) -> const Field*
+      {
+         auto fieldIndex = columns[static_cast<std::size_t>(column)];
+
+         return (((fieldIndex >= 0) && (static_cast<std::size_t>(fieldIndex) < record.size())) ? (&record[static_cast<std::size_t>(fieldIndex)]) : (nullptr));
+      };
+
+      //
+      // Look up (or create) the group before the item, so a group is always allocated before
+      // the items it contains.
+      //
+
+      GroupItem* parent = this;
+
+      if (auto field = column(Column::Group))
+      {
+         const auto& groupName = fieldString(*field, &fieldBuffer).trimmed();
+         if (!groupName.isEmpty())
+         {
+            auto& group = groups[groupName];
+            if (group == nullptr)
+            {
+               group = createItem<LinkGroupItem>();
+               group->setName(StringPool::intern(groupName));
+
+               //
+               // Groups are filled as the records are read, so items are always inserted rather
+               // than appended, and the item source is never published while being read.
+               //
+
+               insertItem(group, itemCount());
+            }
+
+            parent = group;
+         }
+      }
+
+      auto item = createItem<LinkItem>();
+
+      if (auto field = column(Column::Name))
+      {
+         item->setName(StringPool::intern(fieldString(*field, &fieldBuffer).trimmed()));
+      }
+      if (auto field = column(Column::Url))
+      {
+         const auto& link = fieldString(*field, &fieldBuffer);
+
+         item->setLink(link);
+         item->setLinkPosition(ItemSourcePosition(field->lineNumber, utf16Size(field->lineBegin, field->begin), link.size()));
+      }
+      if (auto field = column(Column::Tags))
+      {
+         for (const auto& tag : fieldString(*field, &fieldBuffer).split(TAG_DELIMITER_, QString::SkipEmptyParts))
+         {
+            item->appendTag(StringPool::intern(tag.trimmed()));
+         }
+      }
+      if (auto field = column(Column::Color))
+      {
+         item->setBrushIndex(ItemPalette::index(fieldString(*field, &fieldBuffer).trimmed()));
+      }
+
+      parent->insertItem(item, parent->itemCount());
+   }
+
+   if (columns[static_cast<std::size_t>(Column::Name)] < 0)
+   {
+      errorString_ = QObject::tr("No header found");
+      errorPosition_ = {1, 0};
+
+      return false;
+   }
+
+   return true;
 }
@@ -12,10 +12,13 @@
 
 #include "itemsource.h"
 
-class QXmlStreamReader;
-
 /*!
- * \brief An item source represented as CSV file.
+ * \brief An item source represented as CSV file (RFC 4180).
+ *
+ * The first record is a header, naming the columns. The columns \a name and \a url (or \a link)
+ * are required, the columns \a tags (or \a tag), \a color (or \a colour) and \a group are
+ * optional; any other column is ignored. Multiple tags are separated by semicolons. Items
+ * sharing the same group are added to a group item of that name.
  */
 class CsvItemSource : public ItemSource
 {
@@ -24,6 +27,10 @@ public:
     * \reimp
     */
    bool read(QIODevice* device, const QString& identifier) override;
+   /*!
+    * \reimp
+    */
+   bool read(const char* data, qint64 size, const QString& identifier) override;
    /*!
     * \reimp
     */
@@ -37,6 +44,16 @@ public:
     * \reimp
     */
    QPoint errorPosition() const override;
+
+private:
+   /*!
+    * The CSV document error.
+    */
+   QString errorString_;
+   /*!
+    * The CSV document error position.
+    */
+   QPoint errorPosition_;
 };
 
 #endif // CSVITEMSOURCE_H
@@ -0,0 +1,1662 @@
+/*!
+ * \file fastxmlitemsource.cpp
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <QBuffer>
+#include <QDebug>
+#include <QIODevice>
+#include <QObject>
+#include <QPoint>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+
+#include "fastxmlitemsource.h"
+#include "importgroupitem.h"
+#include "importitem.h"
+#include "itempalette.h"
+#include "linkgroupitem.h"
+#include "linkitem.h"
+#include "stringpool.h"
+
+namespace {
+
+/*!
+ * The minimum size of a document to be read concurrently.
+ */
+static const qint64 DEFAULT_CONCURRENT_READ_SIZE_ = 8 * 1024 * 1024;
+/*!
+ * The minimum size of a chunk of a document read concurrently.
+ */
+static const qint64 DEFAULT_CHUNK_SIZE_ = 1024 * 1024;
+/*!
+ * The number of chunks per thread a document read concurrently is split into, so threads are
+ * kept busy even if chunks take a different amount of time to be read.
+ */
+static const int DEFAULT_CHUNKS_PER_THREAD_ = 4;
+
+/*!
+ * The number of threads used to read a single document.
+ */
+std::atomic<int> threadCount_(1);
+
+/*!
+ * The names of the elements of the schema.
+ */
+enum class ElementName
+{
+   Unknown, /*< An element not part of the schema. */
+   Items, /*< The \a items element. */
+   Group, /*< The \a group element. */
+   Item, /*< The \a item element. */
+   Name, /*< The \a name element. */
+   Url, /*< The \a url element. */
+   Tag, /*< The \a tag element. */
+   Color, /*< The \a color element. */
+   Import, /*< The \a import element. */
+   File /*< The \a file element. */
+};
+
+/*!
+ * Returns \a true if the name \a name of the size \a size equals the literal \a literal.
+ */
+template <std::size_t LiteralSize> bool nameEquals(const char* name, int size, const char (&literal)[LiteralSize])
+{
+   return ((size == static_cast<int>(LiteralSize - 1)) && (std::memcmp(name, literal, static_cast<std::size_t>(size)) == 0));
+}
+
+/*!
+ * Returns the element name for the (local) name \a name of the size \a size.
+ */
+ElementName elementName(const char* name, int size)
+{
+   //
+   // The sum of the size and the first character is distinct for all the names of the schema
+   // (modulo 32), so it is used as a perfect hash and just a single comparison is required.
+   //
+
+   switch ((size + static_cast<quint8>(*name)) & 31)
+   {
+   case 8: return (nameEquals(name, size, "color") ? (ElementName::Color) : (ElementName::Unknown));
+   case 10: return (nameEquals(name, size, "file") ? (ElementName::File) : (ElementName::Unknown));
+   case 12: return (nameEquals(name, size, "group") ? (ElementName::Group) : (ElementName::Unknown));
+   case 13: return (nameEquals(name, size, "item") ? (ElementName::Item) : (ElementName::Unknown));
+   case 14: return (nameEquals(name, size, "items") ? (ElementName::Items) : (ElementName::Unknown));
+   case 15: return (nameEquals(name, size, "import") ? (ElementName::Import) : (ElementName::Unknown));
+   case 18: return (nameEquals(name, size, "name") ? (ElementName::Name) : (ElementName::Unknown));
+   case 23: return (nameEquals(name, size, "tag") ? (ElementName::Tag) : (ElementName::Unknown));
+   case 24: return (nameEquals(name, size, "url") ? (ElementName::Url) : (ElementName::Unknown));
+   default: return ElementName::Unknown;
+   }
+}
+
+/*!
+ * Returns \a true if the character \a character is XML whitespace.
+ */
+inline bool isWhitespace(char character)
+{
+   return ((character == ' ') || (character == '\t') || (character == '\n') || (character == '\r'));
+}
+
+/*!
+ * Appends the code point \a codePoint encoded as UTF-8 to \a data.
+ */
+void appendUtf8(uint codePoint, QByteArray* data)
+{
+   if (codePoint < 0x80)
+   {
+      data->append(static_cast<char>(codePoint));
+   }
+   else if (codePoint < 0x800)
+   {
+      data->append(static_cast<char>(0xc0 | (codePoint >> 6)));
+      data->append(static_cast<char>(0x80 | (codePoint & 0x3f)));
+   }
+   else if (codePoint < 0x10000)
+   {
+      data->append(static_cast<char>(0xe0 | (codePoint >> 12)));
+      data->append(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f)));
+      data->append(static_cast<char>(0x80 | (codePoint & 0x3f)));
+   }
+   else
+   {
+      data->append(static_cast<char>(0xf0 | (codePoint >> 18)));
+      data->append(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f)));
+      data->append(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f)));
+      data->append(static_cast<char>(0x80 | (codePoint & 0x3f)));
+   }
+}
+
+/*!
+ * \brief A reader for XML documents of the launcher schema.
+ *
+ * The reader works in place on UTF-8 encoded data and follows the interface of the
+ * QXmlStreamReader as far as used by the item source, so the document is read the very same
+ * way. It checks the document for being well-formed as far as required to read it correctly,
+ * but it is not a validating reader. The line number is calculated only when requested.
+ */
+class FastXmlReader
+{
+public:
+   /*!
+    * Constructs a reader for the data \a data of the size \a size.
+    */
+   FastXmlReader(const char* data, qint64 size) : begin_(data), position_(data), end_(data + size), lineCountPosition_(data), lineBegin_(data), originLineBegin_(data)
+   {
+      if ((size >= 3) && (std::memcmp(data, "\xef\xbb\xbf", 3) == 0))
+      {
+         position_ += 3;
+      }
+   }
+   /*!
+    * Constructs a reader for the part of a document from \a begin to \a end, which contains
+    * the content of an element, but not the element itself. The part starts on the line with
+    * the number \a lineNumber, which begins at \a lineBegin.
+    */
+   FastXmlReader(const char* begin, const char* end, int lineNumber, const char* lineBegin) : begin_(begin), position_(begin), end_(end),
+      lineCountPosition_(begin), lineNumber_(lineNumber), lineBegin_(lineBegin), originLineNumber_(lineNumber), originLineBegin_(lineBegin)
+   {
+   }
+
+   /*!
+    * Returns \a true if the document is encoded as UTF-8 (or a subset of it); \a false if the
+    * document is declared or marked to be in a different encoding.
+    */
+   bool isUtf8() const
+   {
+      //
+      // Any document starting with a byte order mark other than the one for UTF-8 (or with a
+      // null character, indicating UTF-16 or UTF-32 without byte order mark) is not UTF-8.
+      //
+
+      auto size = (end_ - begin_);
+      if ((size >= 2) && (((static_cast<quint8>(begin_[0]) == 0xfe) && (static_cast<quint8>(begin_[1]) == 0xff)) ||
+                          ((static_cast<quint8>(begin_[0]) == 0xff) && (static_cast<quint8>(begin_[1]) == 0xfe)) ||
+                          (begin_[0] == '\0') || (begin_[1] == '\0')))
+      {
+         return false;
+      }
+
+      //
+      // Otherwise the encoding declared in the XML declaration, if any, is decisive.
+      //
+
+      static const char declaration[] = "<?xml";
+
+      if (((end_ - position_) < static_cast<qint64>(sizeof(declaration) - 1)) || (std::memcmp(position_, declaration, sizeof(declaration) - 1) != 0))
+      {
+         return true;
+      }
+
+      static const char declarationEnd[] = "?>";
+      static const char encoding[] = "encoding";
+
+      auto declarationEndPosition = std::search(position_, end_, declarationEnd, declarationEnd + sizeof(declarationEnd) - 1);
+      auto encodingPosition = std::search(position_, declarationEndPosition, encoding, encoding + sizeof(encoding) - 1);
+      if (encodingPosition == declarationEndPosition)
+      {
+         return true;
+      }
+
+      auto valueBegin = std::find_if(encodingPosition + sizeof(encoding) - 1, declarationEndPosition, [](char character) { return ((character == '"') || (character == '\'')); });
+      if (valueBegin == declarationEndPosition)
+      {
+         return true;
+      }
+
+      auto valueEnd = std::find(valueBegin + 1, declarationEndPosition, *valueBegin);
+
+      auto value = QByteArray(valueBegin + 1, static_cast<int>(valueEnd - valueBegin - 1)).toLower();
+
+      return ((value == "utf-8") || (value == "utf8") || (value == "us-ascii") || (value == "ascii"));
+   }
+
+   /*!
+    * Returns \a true if the document type declaration of the document has an internal subset,
+    * which may declare entities; \a false otherwise.
+    */
+   bool hasInternalSubset() const
+   {
+      static const char documentType[] = "<!DOCTYPE";
+
+      //
+      // Skip any comment and processing instruction preceding the document type declaration,
+      // which is followed by the root element.
+      //
+
+      for (auto position = std::find(position_, end_, '<'); position != end_; position = std::find(position, end_, '<'))
+      {
+         if ((end_ - position) < static_cast<qint64>(sizeof(documentType) - 1))
+         {
+            break;
+         }
+
+         if (std::memcmp(position, "<!--", 4) == 0)
+         {
+            static const char commentEnd[] = "-->";
+
+            position = std::search(position + 4, end_, commentEnd, commentEnd + sizeof(commentEnd) - 1);
+         }
+         else if (position[1] == '?')
+         {
+            static const char processingInstructionEnd[] = "?>";
+
+            position = std::search(position + 2, end_, processingInstructionEnd, processingInstructionEnd + sizeof(processingInstructionEnd) - 1);
+         }
+         else if (std::memcmp(position, documentType, sizeof(documentType) - 1) == 0)
+         {
+            auto subsetPosition = std::find_if(position, end_, [](char character) { return ((character == '[') || (character == '>')); });
+
+            return ((subsetPosition != end_) && (*subsetPosition == '['));
+         }
+         else
+         {
+            break;
+         }
+      }
+
+      return false;
+   }
+
+   /*!
+    * Reads until the next start element within the current element. Returns \a true if a start
+    * element has been read, \a false if the end of the current element has been read or an
+    * error occurred.
+    */
+   bool readNextStartElement()
+   {
+      if (hasError())
+      {
+         return false;
+      }
+
+      if (elementEmpty_)
+      {
+         elementEmpty_ = false;
+         elements_.pop_back();
+
+         return false;
+      }
+
+      for (;;)
+      {
+         auto markup = static_cast<const char*>(std::memchr(position_, '<', static_cast<std::size_t>(end_ - position_)));
+         if (markup == nullptr)
+         {
+            position_ = end_;
+
+            if (!elements_.empty())
+            {
+               raiseError(QObject::tr("Premature end of document"));
+            }
+
+            return false;
+         }
+
+         position_ = markup;
+
+         const char* dataBegin = nullptr;
+         const char* dataEnd = nullptr;
+
+         switch (readMarkup_(&dataBegin, &dataEnd))
+         {
+         case Markup_::StartElement: return true;
+         case Markup_::EndElement: return false;
+         case Markup_::Invalid: return false;
+         case Markup_::CharacterData: break;
+         case Markup_::Skipped: break;
+         }
+      }
+   }
+
+   /*!
+    * Returns the beginning of the start tag of the current element.
+    */
+   const char* elementBegin() const
+   {
+      return elementBegin_;
+   }
+   /*!
+    * Returns the current position.
+    */
+   const char* position() const
+   {
+      return position_;
+   }
+
+   /*!
+    * Returns the name of the current element.
+    */
+   ElementName name() const
+   {
+      return elementName_;
+   }
+
+   /*!
+    * Reads the text of the current element into \a text and reads until the end of the current
+    * element. Returns \a true if the text could be read; \a false otherwise.
+    */
+   bool readElementText(QString* text)
+   {
+      Q_ASSERT(text != nullptr);
+
+      if (hasError())
+      {
+         return false;
+      }
+
+      if (elementEmpty_)
+      {
+         elementEmpty_ = false;
+         elements_.pop_back();
+
+         text->clear();
+
+         return true;
+      }
+
+      //
+      // Text immediately followed by the end tag and containing neither entities nor carriage
+      // returns, which is by far the most common case, is decoded at once. Otherwise the text is
+      // decoded chunk by chunk, skipping comments and processing instructions.
+      //
+
+      auto markup = static_cast<const char*>(std::memchr(position_, '<', static_cast<std::size_t>(end_ - position_)));
+      if ((markup != nullptr) && ((end_ - markup) > 1) && (markup[1] == '/') &&
+          (std::find_if(position_, markup, [](char character) { return ((character == '&') || (character == '\r')); }) == markup))
+      {
+         auto textBegin = position_;
+
+         position_ = markup;
+
+         const char* dataBegin = nullptr;
+         const char* dataEnd = nullptr;
+
+         if (readMarkup_(&dataBegin, &dataEnd) != Markup_::EndElement)
+         {
+            return false;
+         }
+
+         *text = QString::fromUtf8(textBegin, static_cast<int>(markup - textBegin));
+
+         return true;
+      }
+
+      QByteArray decodedText;
+
+      for (;;)
+      {
+         markup = static_cast<const char*>(std::memchr(position_, '<', static_cast<std::size_t>(end_ - position_)));
+         if (markup == nullptr)
+         {
+            position_ = end_;
+
+            return raiseError(QObject::tr("Premature end of document"));
+         }
+
+         if (!decodeText_(markup, true, &decodedText))
+         {
+            return false;
+         }
+
+         const char* dataBegin = nullptr;
+         const char* dataEnd = nullptr;
+
+         switch (readMarkup_(&dataBegin, &dataEnd))
+         {
+         case Markup_::EndElement:
+         {
+            *text = QString::fromUtf8(decodedText);
+
+            return true;
+         }
+         case Markup_::CharacterData:
+         {
+            auto position = position_;
+
+            position_ = dataBegin;
+
+            decodeText_(dataEnd, false, &decodedText);
+
+            position_ = position;
+
+            break;
+         }
+         case Markup_::Skipped:
+         {
+            break;
+         }
+         case Markup_::StartElement:
+         {
+            return raiseError(QObject::tr("Expected character data"));
+         }
+         case Markup_::Invalid:
+         {
+            return false;
+         }
+         }
+      }
+   }
+
+   /*!
+    * Reads until the end of the current element, skipping any child elements.
+    */
+   void skipCurrentElement()
+   {
+      for (int depth = 1; ((depth > 0) && (!hasError())); )
+      {
+         depth += (readNextStartElement() ? (1) : (-1));
+      }
+   }
+
+   /*!
+    * Reads the value of the attribute \a name of the current element into \a value. Returns
+    * \a true if the current element has such an attribute; \a false otherwise.
+    */
+   bool attribute(const char* name, QString* value)
+   {
+      Q_ASSERT(value != nullptr);
+
+      auto nameSize = static_cast<int>(std::strlen(name));
+
+      for (const auto& attribute : attributes_)
+      {
+         if ((attribute.nameSize == nameSize) && (std::memcmp(attribute.name, name, static_cast<std::size_t>(nameSize)) == 0))
+         {
+            //
+            // The value is decoded starting at its position, which is always before the current
+            // position, so the current position is restored afterwards.
+            //
+
+            auto position = position_;
+
+            position_ = attribute.value;
+
+            QByteArray decodedValue;
+            bool result = decodeText_(attribute.value + attribute.valueSize, true, &decodedValue);
+
+            position_ = position;
+
+            if (result)
+            {
+               *value = QString::fromUtf8(decodedValue);
+            }
+
+            return result;
+         }
+      }
+
+      return false;
+   }
+
+   /*!
+    * Returns the line number of the current position.
+    */
+   int lineNumber()
+   {
+      countLines_();
+
+      return lineNumber_;
+   }
+   /*!
+    * Returns the column number of the current position, in UTF-16 code units.
+    */
+   int columnNumber()
+   {
+      countLines_();
+
+      int columnNumber = 0;
+
+      for (auto position = lineBegin_; position < position_; ++position)
+      {
+         auto byte = static_cast<quint8>(*position);
+
+         if ((byte & 0xc0) != 0x80)
+         {
+            columnNumber += ((byte >= 0xf0) ? (2) : (1));
+         }
+      }
+
+      return columnNumber;
+   }
+
+   /*!
+    * Records the error \a errorString at the current position and returns \a false.
+    */
+   bool raiseError(const QString& errorString)
+   {
+      if (errorString_.isNull())
+      {
+         errorString_ = errorString;
+         errorPosition_ = {lineNumber(), columnNumber()};
+      }
+
+      return false;
+   }
+
+   /*!
+    * Returns \a true if an error occurred; \a false otherwise.
+    */
+   bool hasError() const
+   {
+      return (!errorString_.isNull());
+   }
+   /*!
+    * Returns the error which occurred or a null string if no error has occurred.
+    */
+   QString errorString() const
+   {
+      return errorString_;
+   }
+   /*!
+    * Returns the position of the error which occurred.
+    */
+   QPoint errorPosition() const
+   {
+      return errorPosition_;
+   }
+
+private:
+   /*!
+    * The kind of markup read.
+    */
+   enum class Markup_
+   {
+      StartElement, /*< A start tag. */
+      EndElement, /*< An end tag. */
+      CharacterData, /*< A CDATA section. */
+      Skipped, /*< A comment, a processing instruction or a document type declaration. */
+      Invalid /*< Invalid markup, an error has been raised. */
+   };
+
+   /*!
+    * \brief An element, referring to its name in place.
+    */
+   struct Element_
+   {
+      /*!
+       * The (qualified) name of the element.
+       */
+      const char* name;
+      /*!
+       * The size of the name of the element.
+       */
+      int nameSize;
+   };
+
+   /*!
+    * \brief An attribute of the current element, referring to its name and value in place.
+    */
+   struct Attribute_
+   {
+      /*!
+       * The name of the attribute.
+       */
+      const char* name;
+      /*!
+       * The size of the name of the attribute.
+       */
+      int nameSize;
+      /*!
+       * The (undecoded) value of the attribute.
+       */
+      const char* value;
+      /*!
+       * The size of the value of the attribute.
+       */
+      int valueSize;
+   };
+
+   /*!
+    * The beginning of the data.
+    */
+   const char* begin_;
+   /*!
+    * The current position.
+    */
+   const char* position_;
+   /*!
+    * The end of the data.
+    */
+   const char* end_;
+   /*!
+    * The position up to which lines have been counted.
+    */
+   const char* lineCountPosition_;
+   /*!
+    * The line number of the line count position.
+    */
+   int lineNumber_ = 1;
+   /*!
+    * The beginning of the line of the line count position.
+    */
+   const char* lineBegin_;
+   /*!
+    * The line number of the beginning of the data.
+    */
+   int originLineNumber_ = 1;
+   /*!
+    * The beginning of the line of the beginning of the data.
+    */
+   const char* originLineBegin_;
+   /*!
+    * The open elements, the current element being the last one.
+    */
+   std::vector<Element_> elements_;
+   /*!
+    * The attributes of the current element.
+    */
+   std::vector<Attribute_> attributes_;
+   /*!
+    * The beginning of the start tag of the current element.
+    */
+   const char* elementBegin_ = nullptr;
+   /*!
+    * The name of the current element.
+    */
+   ElementName elementName_ = ElementName::Unknown;
+   /*!
+    * Is \a true if the current element is an empty element tag, which has no end tag.
+    */
+   bool elementEmpty_ = false;
+   /*!
+    * The error which occurred.
+    */
+   QString errorString_;
+   /*!
+    * The position of the error which occurred.
+    */
+   QPoint errorPosition_;
+
+   /*!
+    * Counts the lines up to the current position.
+    */
+   void countLines_()
+   {
+      if (position_ < lineCountPosition_)
+      {
+         lineNumber_ = originLineNumber_;
+         lineBegin_ = originLineBegin_;
+         lineCountPosition_ = begin_;
+      }
+
+      for (const char* lineFeed = nullptr; (lineFeed = static_cast<const char*>(std::memchr(lineCountPosition_, '\n', static_cast<std::size_t>(position_ - lineCountPosition_)))) != nullptr; )
+      {
+         ++lineNumber_;
+
+         lineBegin_ = lineCountPosition_ = (lineFeed + 1);
+      }
+
+      lineCountPosition_ = position_;
+   }
+
+   /*!
+    * Returns \a true if the data at the current position starts with \a literal.
+    */
+   template <std::size_t LiteralSize> bool startsWith_(const char (&literal)[LiteralSize]) const
+   {
+      return ((static_cast<std::size_t>(end_ - position_) >= (LiteralSize - 1)) && (std::memcmp(position_, literal, LiteralSize - 1) == 0));
+   }
+
+   /*!
+    * Skips the markup at the current position up to and including \a terminator. Returns
+    * \a true if the terminator has been found; raises the error \a errorString and returns
+    * \a false otherwise.
+    */
+   template <std::size_t TerminatorSize> bool skipTo_(const char (&terminator)[TerminatorSize], const QString& errorString)
+   {
+      auto terminatorPosition = std::search(position_, end_, terminator, terminator + TerminatorSize - 1);
+      if (terminatorPosition == end_)
+      {
+         return raiseError(errorString);
+      }
+
+      position_ = (terminatorPosition + TerminatorSize - 1);
+
+      return true;
+   }
+
+   /*!
+    * Skips any whitespace at the current position.
+    */
+   void skipWhitespace_()
+   {
+      for (; ((position_ < end_) && (isWhitespace(*position_))); ++position_)
+      {
+      }
+   }
+
+   /*!
+    * Reads the name at the current position, which is terminated by whitespace or any of the
+    * characters in \a terminators, and returns its end.
+    */
+   const char* readName_(const char* terminators)
+   {
+      auto nameEnd = position_;
+      for (; ((nameEnd < end_) && (!isWhitespace(*nameEnd)) && (std::strchr(terminators, *nameEnd) == nullptr)); ++nameEnd)
+      {
+      }
+
+      return nameEnd;
+   }
+
+   /*!
+    * Reads the markup starting with '<' at the current position. For a CDATA section the
+    * content is returned in \a dataBegin and \a dataEnd.
+    */
+   Markup_ readMarkup_(const char** dataBegin, const char** dataEnd)
+   {
+      Q_ASSERT(*position_ == '<');
+
+      if (startsWith_("</"))
+      {
+         return readEndTag_();
+      }
+      else if (startsWith_("<!--"))
+      {
+         return (skipTo_("-->", QObject::tr("Unterminated comment")) ? (Markup_::Skipped) : (Markup_::Invalid));
+      }
+      else if (startsWith_("<![CDATA["))
+      {
+         *dataBegin = (position_ + 9);
+
+         if (!skipTo_("]]>", QObject::tr("Unterminated CDATA section")))
+         {
+            return Markup_::Invalid;
+         }
+
+         *dataEnd = (position_ - 3);
+
+         return Markup_::CharacterData;
+      }
+      else if (startsWith_("<!"))
+      {
+         return readDocumentTypeDeclaration_();
+      }
+      else if (startsWith_("<?"))
+      {
+         return (skipTo_("?>", QObject::tr("Unterminated processing instruction")) ? (Markup_::Skipped) : (Markup_::Invalid));
+      }
+
+      return readStartTag_();
+   }
+
+   /*!
+    * Reads the start tag at the current position.
+    */
+   Markup_ readStartTag_()
+   {
+      elementBegin_ = position_++;
+
+      auto name = position_;
+      auto nameEnd = readName_("/>");
+      if (nameEnd == name)
+      {
+         raiseError(QObject::tr("Invalid element name"));
+
+         return Markup_::Invalid;
+      }
+
+      position_ = nameEnd;
+
+      attributes_.clear();
+
+      bool elementEmpty = false;
+
+      for (;;)
+      {
+         skipWhitespace_();
+
+         if (position_ >= end_)
+         {
+            raiseError(QObject::tr("Premature end of document"));
+
+            return Markup_::Invalid;
+         }
+         else if (*position_ == '>')
+         {
+            ++position_;
+
+            break;
+         }
+         else if (startsWith_("/>"))
+         {
+            position_ += 2;
+
+            elementEmpty = true;
+
+            break;
+         }
+
+         auto attributeName = position_;
+         auto attributeNameEnd = readName_("=/>");
+         if (attributeNameEnd == attributeName)
+         {
+            raiseError(QObject::tr("Expected '>' or '/>'"));
+
+            return Markup_::Invalid;
+         }
+
+         position_ = attributeNameEnd;
+
+         skipWhitespace_();
+
+         if ((position_ >= end_) || (*position_ != '='))
+         {
+            raiseError(QObject::tr("Expected '='"));
+
+            return Markup_::Invalid;
+         }
+
+         ++position_;
+
+         skipWhitespace_();
+
+         if ((position_ >= end_) || ((*position_ != '"') && (*position_ != '\'')))
+         {
+            raiseError(QObject::tr("Expected attribute value"));
+
+            return Markup_::Invalid;
+         }
+
+         auto attributeValue = (position_ + 1);
+         auto attributeValueEnd = static_cast<const char*>(std::memchr(attributeValue, *position_, static_cast<std::size_t>(end_ - attributeValue)));
+         if (attributeValueEnd == nullptr)
+         {
+            raiseError(QObject::tr("Premature end of document"));
+
+            return Markup_::Invalid;
+         }
+
+         attributes_.push_back({attributeName, static_cast<int>(attributeNameEnd - attributeName), attributeValue, static_cast<int>(attributeValueEnd - attributeValue)});
+
+         position_ = (attributeValueEnd + 1);
+      }
+
+      elements_.push_back({name, static_cast<int>(nameEnd - name)});
+
+      //
+      // Elements are dispatched by their local name, so namespace prefixes are ignored just as
+      // with the QXmlStreamReader.
+      //
+
+      auto localName = std::find(name, nameEnd, ':');
+      localName = ((localName != nameEnd) ? (localName + 1) : (name));
+
+      elementName_ = ((localName != nameEnd) ? (elementName(localName, static_cast<int>(nameEnd - localName))) : (ElementName::Unknown));
+      elementEmpty_ = elementEmpty;
+
+      return Markup_::StartElement;
+   }
+
+   /*!
+    * Reads the end tag at the current position, which must match the current element.
+    */
+   Markup_ readEndTag_()
+   {
+      position_ += 2;
+
+      auto name = position_;
+      auto nameEnd = readName_(">");
+
+      if ((elements_.empty()) ||
+          (elements_.back().nameSize != static_cast<int>(nameEnd - name)) ||
+          (std::memcmp(elements_.back().name, name, static_cast<std::size_t>(nameEnd - name)) != 0))
+      {
+         raiseError(QObject::tr("Opening and ending tag mismatch"));
+
+         return Markup_::Invalid;
+      }
+
+      position_ = nameEnd;
+
+      skipWhitespace_();
+
+      if ((position_ >= end_) || (*position_ != '>'))
+      {
+         raiseError(QObject::tr("Expected '>'"));
+
+         return Markup_::Invalid;
+      }
+
+      ++position_;
+
+      elements_.pop_back();
+
+      return Markup_::EndElement;
+   }
+
+   /*!
+    * Skips the document type declaration at the current position, including its internal
+    * subset, if any.
+    */
+   Markup_ readDocumentTypeDeclaration_()
+   {
+      if (!elements_.empty())
+      {
+         raiseError(QObject::tr("Unexpected document type declaration"));
+
+         return Markup_::Invalid;
+      }
+
+      int depth = 0;
+
+      for (position_ += 2; position_ < end_; ++position_)
+      {
+         if (*position_ == '[')
+         {
+            ++depth;
+         }
+         else if (*position_ == ']')
+         {
+            --depth;
+         }
+         else if ((*position_ == '>') && (depth <= 0))
+         {
+            ++position_;
+
+            return Markup_::Skipped;
+         }
+      }
+
+      raiseError(QObject::tr("Premature end of document"));
+
+      return Markup_::Invalid;
+   }
+
+   /*!
+    * Decodes the text from the current position up to \a end and appends it to \a text,
+    * normalizing line breaks and, if \a entities is \a true, resolving entity and character
+    * references. Returns \a true if the text could be decoded; \a false otherwise.
+    */
+   bool decodeText_(const char* end, bool entities, QByteArray* text)
+   {
+      while (position_ < end)
+      {
+         auto special = std::find_if(position_, end, [entities](char character) { return (((entities) && (character == '&')) || (character == '\r')); });
+
+         text->append(position_, static_cast<int>(special - position_));
+
+         position_ = special;
+
+         if (position_ == end)
+         {
+            break;
+         }
+         else if (*position_ == '\r')
+         {
+            text->append('\n');
+
+            position_ += ((((position_ + 1) < end) && (position_[1] == '\n')) ? (2) : (1));
+         }
+         else if (!decodeReference_(end, text))
+         {
+            return false;
+         }
+      }
+
+      return true;
+   }
+
+   /*!
+    * Decodes the entity or character reference at the current position, which must end before
+    * \a end, and appends the character it represents to \a text. Returns \a true if the
+    * reference is valid; \a false otherwise.
+    */
+   bool decodeReference_(const char* end, QByteArray* text)
+   {
+      Q_ASSERT(*position_ == '&');
+
+      auto referenceEnd = static_cast<const char*>(std::memchr(position_, ';', static_cast<std::size_t>(end - position_)));
+      if (referenceEnd == nullptr)
+      {
+         return raiseError(QObject::tr("Unterminated entity reference"));
+      }
+
+      auto reference = QByteArray::fromRawData(position_ + 1, static_cast<int>(referenceEnd - position_ - 1));
+
+      if (reference == "lt")
+      {
+         text->append('<');
+      }
+      else if (reference == "gt")
+      {
+         text->append('>');
+      }
+      else if (reference == "amp")
+      {
+         text->append('&');
+      }
+      else if (reference == "apos")
+      {
+         text->append('\'');
+      }
+      else if (reference == "quot")
+      {
+         text->append('"');
+      }
+      else if (reference.startsWith('#'))
+      {
+         bool result = false;
+
+         uint codePoint = ((reference.startsWith("#x")) ? (reference.mid(2).toUInt(&result, 16)) : (reference.mid(1).toUInt(&result, 10)));
+         if ((!result) || (codePoint == 0) || (codePoint > 0x10ffff) || ((codePoint >= 0xd800) && (codePoint <= 0xdfff)))
+         {
+            return raiseError(QObject::tr("Invalid character reference"));
+         }
+
+         appendUtf8(codePoint, text);
+      }
+      else
+      {
+         return raiseError(QObject::tr("Undefined entity"));
+      }
+
+      position_ = (referenceEnd + 1);
+
+      return true;
+   }
+};
+
+/*!
+ * Reads an item from the reader \a reader into the item source \a itemSource and adds it to the
+ * group item \a parent.
+ */
+void readItem(FastXmlReader& reader, ItemSource* itemSource, GroupItem* parent)
+{
+   auto item = itemSource->createItem<LinkItem>();
+
+   QString text;
+
+   while (reader.readNextStartElement())
+   {
+      switch (reader.name())
+      {
+      case ElementName::Name:
+      {
+         if (reader.readElementText(&text))
+         {
+            item->setName(StringPool::intern(text.trimmed()));
+         }
+
+         break;
+      }
+      case ElementName::Url:
+      {
+         ItemSourcePosition linkPosition;
+         linkPosition.setLineNumber(reader.lineNumber());
+         linkPosition.setColumnNumber(reader.columnNumber());
+
+         if (reader.readElementText(&text))
+         {
+            linkPosition.setSize(text.size());
+
+            item->setLink(text);
+            item->setLinkPosition(linkPosition);
+         }
+
+         break;
+      }
+      case ElementName::Color:
+      {
+         if (reader.readElementText(&text))
+         {
+            item->setBrushIndex(ItemPalette::index(text.trimmed()));
+         }
+
+         break;
+      }
+      case ElementName::Tag:
+      {
+         if (reader.readElementText(&text))
+         {
+            item->appendTag(StringPool::intern(text.trimmed()));
+         }
+
+         break;
+      }
+      default:
+      {
+         reader.skipCurrentElement();
+
+         break;
+      }
+      }
+   }
+
+   itemSource->appendItem(parent, item);
+}
+
+/*!
+ * Reads a group from the reader \a reader into the item source \a itemSource and adds it to the
+ * group item \a parent.
+ */
+void readGroup(FastXmlReader& reader, ItemSource* itemSource, GroupItem* parent)
+{
+   auto itemGroup = itemSource->createItem<LinkGroupItem>();
+
+   QString text;
+
+   while (reader.readNextStartElement())
+   {
+      switch (reader.name())
+      {
+      case ElementName::Item:
+      {
+         readItem(reader, itemSource, itemGroup);
+
+         break;
+      }
+      case ElementName::Name:
+      {
+         if (reader.readElementText(&text))
+         {
+            itemGroup->setName(StringPool::intern(text.trimmed()));
+         }
+
+         break;
+      }
+      case ElementName::Color:
+      {
+         if (reader.readElementText(&text))
+         {
+            itemGroup->setBrushIndex(ItemPalette::index(text.trimmed()));
+         }
+
+         break;
+      }
+      case ElementName::Tag:
+      {
+         if (reader.readElementText(&text))
+         {
+            itemGroup->appendTag(StringPool::intern(text.trimmed()));
+         }
+
+         break;
+      }
+      case ElementName::Group:
+      {
+         readGroup(reader, itemSource, parent);
+
+         break;
+      }
+      default:
+      {
+         reader.skipCurrentElement();
+
+         break;
+      }
+      }
+   }
+
+   itemSource->appendItem(parent, itemGroup);
+}
+
+/*!
+ * Reads an imported source from the reader \a reader into the item source \a itemSource.
+ */
+void readImport(FastXmlReader& reader, ItemSource* itemSource)
+{
+   auto itemGroup = itemSource->createItem<ImportGroupItem>();
+
+   QString file;
+   QString contentType;
+   QString contentEncoding;
+
+   while (reader.readNextStartElement())
+   {
+      if (reader.name() == ElementName::File)
+      {
+         contentType = (reader.attribute("contentType", &contentType) ? (StringPool::intern(contentType.trimmed())) : (QStringLiteral("text/xml")));
+         contentEncoding = (reader.attribute("contentEncoding", &contentEncoding) ? (StringPool::intern(contentEncoding.trimmed().toLower())) : (QString()));
+
+         if (reader.readElementText(&file))
+         {
+            auto item = itemSource->createItem<ImportItem>(file.trimmed(), contentType);
+            item->setContentEncoding(contentEncoding);
+
+            itemGroup->insertItem(item, itemGroup->itemCount());
+         }
+      }
+      else
+      {
+         reader.skipCurrentElement();
+      }
+   }
+
+   itemSource->appendItem(itemSource, itemGroup);
+}
+
+/*!
+ * Reads the content of the \a items element from the reader \a reader into the item source
+ * \a itemSource.
+ */
+void readItems(FastXmlReader& reader, ItemSource* itemSource)
+{
+   while (reader.readNextStartElement())
+   {
+      switch (reader.name())
+      {
+      case ElementName::Item:
+      {
+         readItem(reader, itemSource, itemSource);
+
+         break;
+      }
+      case ElementName::Group:
+      {
+         readGroup(reader, itemSource, itemSource);
+
+         break;
+      }
+      case ElementName::Import:
+      {
+         readImport(reader, itemSource);
+
+         break;
+      }
+      default:
+      {
+         reader.skipCurrentElement();
+
+         break;
+      }
+      }
+   }
+}
+
+/*!
+ * \brief An item source holding a part of another item source, which has been read separately.
+ */
+class ChunkItemSource : public ItemSource
+{
+public:
+   /*!
+    * \reimp
+    */
+   bool read(QIODevice* /* device */, const QString& /* identifier */) override
+   {
+      return false;
+   }
+   /*!
+    * \reimp
+    */
+   bool write(QIODevice* /* device */) const override
+   {
+      return false;
+   }
+
+   /*!
+    * \reimp
+    */
+   QString errorString() const override
+   {
+      return QString();
+   }
+   /*!
+    * \reimp
+    */
+   QPoint errorPosition() const override
+   {
+      return QPoint();
+   }
+};
+
+/*!
+ * \brief A runnable reading a chunk of the content of the \a items element.
+ */
+class ChunkReader : public QRunnable
+{
+public:
+   /*!
+    * Constructs a reader for the chunk from \a begin to \a end, which starts on the line with the
+    * number \a lineNumber, which begins at \a lineBegin.
+    */
+   ChunkReader(const char* begin, const char* end, int lineNumber, const char* lineBegin) :
+      begin_(begin), end_(end), lineNumber_(lineNumber), lineBegin_(lineBegin)
+   {
+      setAutoDelete(false);
+   }
+
+   /*!
+    * \reimp
+    */
+   void run() override
+   {
+      FastXmlReader reader(begin_, end_, lineNumber_, lineBegin_);
+
+      readItems(reader, &itemSource_);
+
+      errorString_ = reader.errorString();
+      errorPosition_ = reader.errorPosition();
+
+      finished_.release();
+   }
+
+   /*!
+    * Waits until the chunk has been read.
+    */
+   void wait()
+   {
+      finished_.acquire();
+   }
+
+   /*!
+    * Returns the item source the chunk has been read into.
+    */
+   ItemSource* itemSource()
+   {
+      return &itemSource_;
+   }
+
+   /*!
+    * Returns the error which occurred or a null string if no error has occurred.
+    */
+   QString errorString() const
+   {
+      return errorString_;
+   }
+   /*!
+    * Returns the position of the error which occurred.
+    */
+   QPoint errorPosition() const
+   {
+      return errorPosition_;
+   }
+
+private:
+   /*!
+    * The beginning of the chunk.
+    */
+   const char* begin_;
+   /*!
+    * The end of the chunk.
+    */
+   const char* end_;
+   /*!
+    * The line number the chunk starts on.
+    */
+   int lineNumber_;
+   /*!
+    * The beginning of the line the chunk starts on.
+    */
+   const char* lineBegin_;
+
+   /*!
+    * The item source the chunk is read into.
+    */
+   ChunkItemSource itemSource_;
+
+   /*!
+    * The error which occurred.
+    */
+   QString errorString_;
+   /*!
+    * The position of the error which occurred.
+    */
+   QPoint errorPosition_;
+
+   /*!
+    * The semaphore released as soon as the chunk has been read.
+    */
+   QSemaphore finished_;
+};
+
+/*!
+ * Returns the thread pool chunks are read in.
+ */
+QThreadPool& chunkReaderPool()
+{
+   static QThreadPool chunkReaderPool;
+
+   return chunkReaderPool;
+}
+
+/*!
+ * Splits the content of the \a items element of the document \a data of the size \a size at
+ * the boundaries of its child elements into chunks of at least \a chunkSize bytes each, and
+ * creates a chunk reader for each of them in \a chunkReaders. Returns \a true if the document
+ * has been split into more than one chunk; \a false otherwise (which includes documents which
+ * are not well-formed, which are left to be read as a whole so the error is reported).
+ */
+bool splitDocument(const char* data, qint64 size, qint64 chunkSize, std::vector<std::unique_ptr<ChunkReader>>* chunkReaders)
+{
+   //
+   // Determine the boundaries of the chunks by skipping over the child elements, which just
+   // requires the tags to be read.
+   //
+
+   std::vector<std::pair<const char*, const char*>> chunks;
+
+   FastXmlReader reader(data, size);
+   if ((!reader.readNextStartElement()) || (reader.name() != ElementName::Items))
+   {
+      return false;
+   }
+
+   const char* chunkBegin = nullptr;
+   const char* chunkEnd = nullptr;
+
+   while (reader.readNextStartElement())
+   {
+      if (chunkBegin == nullptr)
+      {
+         chunkBegin = reader.elementBegin();
+      }
+      else if ((reader.elementBegin() - chunkBegin) >= chunkSize)
+      {
+         chunks.push_back({chunkBegin, reader.elementBegin()});
+
+         chunkBegin = reader.elementBegin();
+      }
+
+      reader.skipCurrentElement();
+
+      chunkEnd = reader.position();
+   }
+
+   if ((reader.hasError()) || (chunkBegin == nullptr))
+   {
+      return false;
+   }
+
+   chunks.push_back({chunkBegin, chunkEnd});
+
+   if (chunks.size() < 2)
+   {
+      return false;
+   }
+
+   //
+   // Determine the line each chunk starts on, so positions are reported relative to the whole
+   // document.
+   //
+
+   int lineNumber = 1;
+   const char* lineBegin = data;
+
+   for (const auto& chunk : chunks)
+   {
+      for (const char* lineFeed = lineBegin; (lineFeed = static_cast<const char*>(std::memchr(lineFeed, '\n', static_cast<std::size_t>(chunk.first - lineFeed)))) != nullptr; )
+      {
+         ++lineNumber;
+
+         lineBegin = ++lineFeed;
+      }
+
+      chunkReaders->emplace_back(new ChunkReader(chunk.first, chunk.second, lineNumber, lineBegin));
+   }
+
+   return true;
+}
+
+} // namespace
+
+void FastXmlItemSource::setThreadCount(int threadCount)
+{
+   threadCount_ = std::max(threadCount, 1);
+
+   //
+   // The thread reading the document reads a chunk itself.
+   //
+
+   chunkReaderPool().setMaxThreadCount(std::max(threadCount - 1, 1));
+}
+
+int FastXmlItemSource::threadCount()
+{
+   return threadCount_;
+}
+
+bool FastXmlItemSource::read(QIODevice* device, const QString& identifier)
+{
+   bool result = false;
+
+   ItemSource::setIdentifier(identifier);
+
+   if (device != nullptr)
+   {
+      //
+      // Parse the content in place if the device is a buffer, and read it otherwise.
+      //
+
+      auto deviceBuffer = qobject_cast<QBuffer*>(device);
+
+      const QByteArray& content = ((deviceBuffer != nullptr) ? (deviceBuffer->data()) : (device->readAll()));
+
+      result = read(content.constData(), content.size(), identifier);
+   }
+
+   return result;
+}
+
+bool FastXmlItemSource::read(const char* data, qint64 size, const QString& identifier)
+{
+   ItemSource::setIdentifier(identifier);
+
+   FastXmlReader reader(data, size);
+
+   //
+   // Documents not encoded in UTF-8 are rare, as are documents declaring entities in the internal
+   // subset of their document type declaration, so they are left to the general-purpose reader.
+   //
+
+   if ((!reader.isUtf8()) || (reader.hasInternalSubset()))
+   {
+      if (size > std::numeric_limits<int>::max())
+      {
+         return false;
+      }
+
+      auto content = QByteArray::fromRawData(data, static_cast<int>(size));
+
+      QBuffer contentBuffer(&content);
+      contentBuffer.open(QIODevice::ReadOnly);
+
+      return XmlItemSource::read(&contentBuffer, identifier);
+   }
+
+   //
+   // Large documents are split into chunks at the boundaries of the child elements of the root
+   // element, which are read concurrently into separate item sources (one chunk being read by
+   // this thread), and then adopted in document order. Errors are reported for the first chunk
+   // in document order failing, so the result does not depend on the order chunks are read in.
+   //
+
+   std::vector<std::unique_ptr<ChunkReader>> chunkReaders;
+
+   bool result = true;
+
+   auto threadCount = threadCount_.load();
+   if ((threadCount > 1) && (size >= DEFAULT_CONCURRENT_READ_SIZE_) &&
+       (splitDocument(data, size, std::max(DEFAULT_CHUNK_SIZE_, size / (threadCount * DEFAULT_CHUNKS_PER_THREAD_)), &chunkReaders)))
+   {
+      auto readBegin = std::chrono::steady_clock::now();
+
+      for (std::size_t chunkReaderIndex = 1; chunkReaderIndex < chunkReaders.size(); ++chunkReaderIndex)
+      {
+         chunkReaderPool().start(chunkReaders[chunkReaderIndex].get());
+      }
+
+      chunkReaders.front()->run();
+
+      for (const auto& chunkReader : chunkReaders)
+      {
+         chunkReader->wait();
+
+         if (!result)
+         {
+            continue;
+         }
+
+         result = chunkReader->errorString().isNull();
+         if (result)
+         {
+            adopt(chunkReader->itemSource());
+         }
+         else
+         {
+            errorString_ = chunkReader->errorString();
+            errorPosition_ = chunkReader->errorPosition();
+         }
+      }
+
+      qDebug() << "item source read concurrently" << identifier << chunkReaders.size() << "chunks" << threadCount << "threads"
+               << std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - readBegin).count() << "us";
+   }
+   else
+   {
+      if ((reader.readNextStartElement()) && (reader.name() == ElementName::Items))
+      {
+         readItems(reader, this);
+      }
+      else
+      {
+         reader.raiseError(QObject::tr("No root element found"));
+      }
+
+      result = (!reader.hasError());
+      if (!result)
+      {
+         errorString_ = reader.errorString();
+         errorPosition_ = reader.errorPosition();
+      }
+   }
+
+   //
+   // Errors are rare, so a document failing to be read is read again by the general-purpose
+   // reader into a separate item source, which is discarded, so the error is reported with the
+   // very same message and position as by the XmlItemSource.
+   //
+
+   if ((!result) && (size <= std::numeric_limits<int>::max()))
+   {
+      auto content = QByteArray::fromRawData(data, static_cast<int>(size));
+
+      QBuffer contentBuffer(&content);
+      contentBuffer.open(QIODevice::ReadOnly);
+
+      XmlItemSource errorItemSource;
+      if (!errorItemSource.read(&contentBuffer, identifier))
+      {
+         errorString_ = errorItemSource.errorString();
+         errorPosition_ = errorItemSource.errorPosition();
+      }
+   }
+
+   return result;
+}
@@ -0,0 +1,49 @@
+/*!
+ * \file fastxmlitemsource.h
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#ifndef FASTXMLITEMSOURCE_H
+#define FASTXMLITEMSOURCE_H
+
+#include "xmlitemsource.h"
+
+/*!
+ * \brief An item source represented as XML file, read by a parser specialized for the schema.
+ *
+ * The source reads the very same documents as the XmlItemSource and yields identical items, but
+ * works in place on UTF-8 encoded data instead of using a general-purpose XML reader. Element
+ * names are dispatched using a perfect hash and entities are only decoded where they occur.
+ * Documents in any other encoding or declaring entities of their own are read by the
+ * XmlItemSource, as are documents failing to be read, so errors are reported just like by the
+ * XmlItemSource. Large documents may be read concurrently, see setThreadCount().
+ */
+class FastXmlItemSource : public XmlItemSource
+{
+public:
+   /*!
+    * \reimp
+    */
+   bool read(QIODevice* device, const QString& identifier) override;
+   /*!
+    * \reimp
+    */
+   bool read(const char* data, qint64 size, const QString& identifier) override;
+
+   /*!
+    * Sets the number of threads used to read a single large document to \a threadCount. If
+    * \a threadCount is greater than 1 large documents are split into chunks at the boundaries
+    * of the top-level groups and items, which are read concurrently. The default is 1.
+    */
+   static void setThreadCount(int threadCount);
+   /*!
+    * Returns the number of threads used to read a single large document.
+    */
+   static int threadCount();
+};
+
+#endif // FASTXMLITEMSOURCE_H
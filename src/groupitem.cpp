@@ -7,8 +7,6 @@
  *          published by the Free Software Foundation.
  */
 
-#include <QtAlgorithms>
-
 #include "groupitem.h"
 
 GroupItem::GroupItem() : Item(Item::Type::Group)
@@ -17,7 +15,7 @@ GroupItem::GroupItem() : Item(Item::Type::Group)
 
 GroupItem::~GroupItem()
 {
-   qDeleteAll(items_);
+   deleteItems_();
 }
 
 void GroupItem::setName(const QString& name)
@@ -38,23 +36,43 @@ void GroupItem::insertItem(Item* item, int position)
    }
 
    items_.insert(position, item);
+
+   updateRows_(position);
 }
 
 bool GroupItem::removeItem(Item* item)
 {
-   return items_.removeOne(item);
+   bool result = false;
+
+   auto position = indexOf(item);
+   if (position >= 0)
+   {
+      items_.remove(position);
+
+      item->row_ = -1;
+
+      updateRows_(position);
+
+      result = true;
+   }
+
+   return result;
 }
 
 void GroupItem::removeItems()
 {
+   deleteItems_();
+
    items_.clear();
 }
 
 void GroupItem::setItems(const QVector<Item*>& items)
 {
-   qDeleteAll(items_);
+   deleteItems_();
 
    items_ = items;
+
+   updateRows_(0);
 }
 
 const QVector<Item*>& GroupItem::items() const
@@ -86,9 +104,41 @@ const Item* GroupItem::item(int index) const
 
 int GroupItem::indexOf(Item* item) const
 {
-   return items_.indexOf(item);
+   //
+   // The row of an item is known if it is contained in this group item, so there is no need to
+   // search for it.
+   //
+
+   return (((item != nullptr) && (item->parent() == this) && (item->row_ >= 0) && (item->row_ < items_.size()) && (items_[item->row_] == item)) ?
+           (item->row_) : (items_.indexOf(item)));
 }
 
 GroupItem::GroupItem(Type type) : Item(type)
 {
 }
+
+void GroupItem::deleteItems_()
+{
+   //
+   // Items allocated from an item arena are owned by the arena and must not be deleted.
+   //
+
+   for (auto item : items_)
+   {
+      if ((item != nullptr) && (!item->isArenaAllocated()))
+      {
+         delete item;
+      }
+   }
+}
+
+void GroupItem::updateRows_(int position)
+{
+   for (int row = position; row < items_.size(); ++row)
+   {
+      if (items_[row] != nullptr)
+      {
+         items_[row]->row_ = row;
+      }
+   }
+}
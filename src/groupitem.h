@@ -10,7 +10,7 @@
 #ifndef GROUPITEM_H
 #define GROUPITEM_H
 
-#include <functional>
+#include <vector>
 
 #include <QString>
 #include <QVector>
@@ -52,7 +52,7 @@ public:
     */
    bool removeItem(Item* item);
    /*!
-    * Removes all items.
+    * Removes all items, deleting all owned items.
     */
    void removeItems();
 
@@ -85,19 +85,133 @@ public:
    int indexOf(Item* item) const;
 
    /*!
-    * Recursively applies the function \a function to each item of type \a Type.
+    * \brief A pre-order iterator over all items contained in a group item.
+    *
+    * The iterator does not recurse, but keeps the path to the current item on a stack of its own,
+    * so the nesting depth of the items is not limited by the call stack. The group item and its
+    * items must not be modified while being iterated.
     */
-   template <typename ItemType, typename GroupItemType = GroupItem> void apply(const std::function<void(ItemType* item)> function)
+   class Iterator
    {
-      for (const auto& item : items_)
+   public:
+      /*!
+       * Constructs an iterator over the items contained in the group item \a groupItem (but
+       * not the group item itself).
+       */
+      explicit Iterator(GroupItem* groupItem)
+      {
+         if ((groupItem != nullptr) && (!groupItem->items_.isEmpty()))
+         {
+            path_.push_back({groupItem, 0});
+         }
+      }
+
+      /*!
+       * Advances the iterator and returns the next item or \a nullptr if there are no more items.
+       */
+      Item* next()
+      {
+         //
+         // Descend into the current item if it is a group item which has not been skipped, and
+         // ascend as long as the current group item has no more items.
+         //
+
+         if (auto groupItem = ((descend_) ? (Item::cast<GroupItem>(item_)) : (nullptr)))
+         {
+            if (!groupItem->items_.isEmpty())
+            {
+               path_.push_back({groupItem, 0});
+            }
+         }
+
+         item_ = nullptr;
+         descend_ = true;
+
+         while ((item_ == nullptr) && (!path_.empty()))
+         {
+            auto& pathEntry = path_.back();
+            if (pathEntry.row < pathEntry.groupItem->items_.size())
+            {
+               row_ = pathEntry.row++;
+               item_ = pathEntry.groupItem->items_[row_];
+            }
+            else
+            {
+               path_.pop_back();
+            }
+         }
+
+         return item_;
+      }
+
+      /*!
+       * Skips the items contained in the current item, if it is a group item.
+       */
+      void skipItems()
+      {
+         descend_ = false;
+      }
+
+      /*!
+       * Returns the row of the current item within its group item.
+       */
+      int row() const
+      {
+         return row_;
+      }
+
+   private:
+      /*!
+       * \brief An entry in the path to the current item.
+       */
+      struct PathEntry_
+      {
+         /*!
+          * The group item.
+          */
+         GroupItem* groupItem;
+         /*!
+          * The row of the next item within the group item.
+          */
+         int row;
+      };
+
+      /*!
+       * The path to the current item.
+       */
+      std::vector<PathEntry_> path_;
+      /*!
+       * The current item.
+       */
+      Item* item_ = nullptr;
+      /*!
+       * The row of the current item within its group item.
+       */
+      int row_ = -1;
+      /*!
+       * Is \a true if the iterator descends into the current item; \a false otherwise.
+       */
+      bool descend_ = true;
+   };
+
+   /*!
+    * Applies the function \a function to each item of type \a ItemType, descending into any
+    * group item of type \a GroupItemType (but not into items of type \a ItemType).
+    */
+   template <typename ItemType, typename GroupItemType = GroupItem, typename Function> void apply(Function&& function)
+   {
+      Iterator iterator(this);
+      while (auto item = iterator.next())
       {
          if (auto typedItem = Item::cast<ItemType>(item))
          {
             function(typedItem);
+
+            iterator.skipItems();
          }
-         else if (auto typedGroupItem = Item::cast<GroupItemType>(item))
+         else if (!Item::is<GroupItemType>(item))
          {
-            typedGroupItem->apply<ItemType>(function);
+            iterator.skipItems();
          }
       }
    }
@@ -129,7 +243,17 @@ protected:
     */
    explicit GroupItem(Item::Type type);
 
+   /*!
+    * Deletes all owned items, which are all items not allocated from an item arena.
+    */
+   void deleteItems_();
+
 private:
+   /*!
+    * Updates the row of all items starting at the row \a position.
+    */
+   void updateRows_(int position);
+
    /*!
     * The name of the item group.
     */
@@ -0,0 +1,185 @@
+/*!
+ * \file gzipdevice.cpp
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#include <cstring>
+#include <limits>
+
+#include <zlib.h>
+
+#include "gzipdevice.h"
+
+namespace {
+
+/*!
+ * The size of the buffer compressed data is read into.
+ */
+static const int DEFAULT_INPUT_SIZE_ = 64 * 1024;
+
+/*!
+ * The window bits selecting a maximum window and gzip decoding.
+ */
+static const int GZIP_WINDOW_BITS_ = (15 + 16);
+
+} // namespace
+
+GzipDevice::GzipDevice(QIODevice* device, QObject* parent) : QIODevice(parent), device_(device)
+{
+}
+
+GzipDevice::~GzipDevice()
+{
+   close();
+}
+
+bool GzipDevice::open(OpenMode mode)
+{
+   if ((mode & ReadWrite) != ReadOnly)
+   {
+      setErrorString(tr("The device can be opened for reading only"));
+
+      return false;
+   }
+
+   if ((device_ == nullptr) || (!device_->isReadable()))
+   {
+      setErrorString(tr("The device compressed data is read from is not readable"));
+
+      return false;
+   }
+
+   stream_.reset(new z_stream_s);
+   std::memset(stream_.get(), 0, sizeof(z_stream_s));
+
+   if (inflateInit2(stream_.get(), GZIP_WINDOW_BITS_) != Z_OK)
+   {
+      stream_.reset();
+
+      setErrorString(tr("The decompression could not be initialized"));
+
+      return false;
+   }
+
+   input_.resize(DEFAULT_INPUT_SIZE_);
+
+   streamEnd_ = false;
+   error_ = false;
+
+   return QIODevice::open(mode);
+}
+
+void GzipDevice::close()
+{
+   if (stream_)
+   {
+      inflateEnd(stream_.get());
+
+      stream_.reset();
+   }
+
+   input_.clear();
+
+   QIODevice::close();
+}
+
+bool GzipDevice::isSequential() const
+{
+   return true;
+}
+
+bool GzipDevice::isCompressed(const char* data, qint64 size)
+{
+   return ((size >= 2) && (static_cast<quint8>(data[0]) == 0x1f) && (static_cast<quint8>(data[1]) == 0x8b));
+}
+
+qint64 GzipDevice::readData(char* data, qint64 maxSize)
+{
+   if ((!stream_) || (error_))
+   {
+      return -1;
+   }
+
+   if (streamEnd_)
+   {
+      return 0;
+   }
+
+   stream_->next_out = reinterpret_cast<Bytef*>(data);
+   stream_->avail_out = static_cast<uInt>(qMin(maxSize, static_cast<qint64>(std::numeric_limits<uInt>::max())));
+
+   auto outputSize = stream_->avail_out;
+
+   while (stream_->avail_out > 0)
+   {
+      if (stream_->avail_in == 0)
+      {
+         auto inputSize = device_->read(input_.data(), input_.size());
+         if (inputSize < 0)
+         {
+            return raiseError_(device_->errorString());
+         }
+         else if (inputSize == 0)
+         {
+            //
+            // The compressed data ended before the end of the stream. Return what has been
+            // decompressed so far, and fail with the next read.
+            //
+
+            if (stream_->avail_out == outputSize)
+            {
+               return raiseError_(tr("Unexpected end of compressed data"));
+            }
+
+            break;
+         }
+
+         stream_->next_in = reinterpret_cast<Bytef*>(input_.data());
+         stream_->avail_in = static_cast<uInt>(inputSize);
+      }
+
+      auto result = inflate(stream_.get(), Z_NO_FLUSH);
+      if (result == Z_STREAM_END)
+      {
+         //
+         // Continue with the next member if there is any further data (as concatenated gzip
+         // members form a single stream).
+         //
+
+         if ((stream_->avail_in > 0) || (!device_->atEnd()))
+         {
+            inflateReset(stream_.get());
+         }
+         else
+         {
+            streamEnd_ = true;
+
+            break;
+         }
+      }
+      else if ((result != Z_OK) && (result != Z_BUF_ERROR))
+      {
+         return raiseError_((stream_->msg != nullptr) ? (tr("Invalid compressed data: %1").arg(QString::fromLatin1(stream_->msg))) : (tr("Invalid compressed data")));
+      }
+   }
+
+   return static_cast<qint64>(outputSize - stream_->avail_out);
+}
+
+qint64 GzipDevice::writeData(const char* /* data */, qint64 /* maxSize */)
+{
+   return -1;
+}
+
+qint64 GzipDevice::raiseError_(const QString& errorString)
+{
+   error_ = true;
+
+   setErrorString(errorString);
+
+   return -1;
+}
@@ -0,0 +1,106 @@
+/*!
+ * \file gzipdevice.h
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#ifndef GZIPDEVICE_H
+#define GZIPDEVICE_H
+
+#include <memory>
+
+#include <QByteArray>
+#include <QIODevice>
+
+struct z_stream_s;
+
+/*!
+ * \brief A sequential device decompressing gzip-compressed data read from another device.
+ *
+ * The data is decompressed as it is read, so the decompressed data is never held as a whole.
+ * Concatenated gzip members are decompressed as a single stream. The device can be opened
+ * for reading only.
+ */
+class GzipDevice : public QIODevice
+{
+public:
+   /*!
+    * Constructs a device decompressing the data read from the device \a device, which must be
+    * already opened for reading and must remain valid as long as this device is open.
+    */
+   explicit GzipDevice(QIODevice* device, QObject* parent = nullptr);
+   /*!
+    * Destructs the device, closing it if open.
+    */
+   ~GzipDevice();
+
+   /*!
+    * \reimp
+    */
+   bool open(OpenMode mode) override;
+   /*!
+    * \reimp
+    */
+   void close() override;
+   /*!
+    * \reimp
+    */
+   bool isSequential() const override;
+
+   /*!
+    * Returns \a true if reading failed because the data could not be decompressed or read;
+    * \a false otherwise. The error is available using errorString().
+    */
+   bool hasError() const
+   {
+      return error_;
+   }
+
+   /*!
+    * Returns \a true if the data \a data of the size \a size starts with the gzip magic number;
+    * \a false otherwise.
+    */
+   static bool isCompressed(const char* data, qint64 size);
+
+protected:
+   /*!
+    * \reimp
+    */
+   qint64 readData(char* data, qint64 maxSize) override;
+   /*!
+    * \reimp
+    */
+   qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+   /*!
+    * The device the compressed data is read from.
+    */
+   QIODevice* device_;
+   /*!
+    * The decompression stream.
+    */
+   std::unique_ptr<z_stream_s> stream_;
+   /*!
+    * The buffer compressed data is read into.
+    */
+   QByteArray input_;
+   /*!
+    * Is \a true if the end of the compressed data has been reached.
+    */
+   bool streamEnd_ = false;
+   /*!
+    * Is \a true if reading failed.
+    */
+   bool error_ = false;
+
+   /*!
+    * Sets the error \a errorString and returns -1.
+    */
+   qint64 raiseError_(const QString& errorString);
+};
+
+#endif // GZIPDEVICE_H
@@ -33,6 +33,16 @@ QString ImportItem::mimeType() const
    return mimeType_;
 }
 
+void ImportItem::setContentEncoding(const QString& contentEncoding)
+{
+   contentEncoding_ = contentEncoding;
+}
+
+QString ImportItem::contentEncoding() const
+{
+   return contentEncoding_;
+}
+
 QDebug operator<<(QDebug stream, const ImportItem& import)
 {
    return (stream << import.file() << import.mimeType());
@@ -44,6 +44,17 @@ public:
     */
    QString mimeType() const;
 
+   /*!
+    * Sets the content encoding of the file to be imported. If the content encoding is \a gzip
+    * the file is decompressed, if it is \a identity it is read as is and if it is empty (the
+    * default) the file is decompressed if it starts with the gzip magic number.
+    */
+   void setContentEncoding(const QString& contentEncoding);
+   /*!
+    * Returns the content encoding of the file to be imported.
+    */
+   QString contentEncoding() const;
+
    /*!
     * Returns \a true if the item is a or is a base of \a type.
     */
@@ -61,6 +72,10 @@ private:
     * The MIME type of the file to be imported.
     */
    QString mimeType_;
+   /*!
+    * The content encoding of the file to be imported.
+    */
+   QString contentEncoding_;
 
    /*!
     * Inserts the import \a import into the stream \a stream and returns the stream.
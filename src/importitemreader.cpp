@@ -7,27 +7,155 @@
  *          published by the Free Software Foundation.
  */
 
-#include <QSharedPointer>
+#include <limits>
+
+#include <QBuffer>
+#include <QFileInfo>
+#include <QList>
+#include <QStorageInfo>
 
 #include "application.h"
+#include "catalogsnapshot.h"
+#include "gzipdevice.h"
 #include "importitemreader.h"
 
 void ImportItemReader::run()
 {
    Q_ASSERT(itemSource_);
 
+   auto readBegin = std::chrono::steady_clock::now();
+
    QFile file(importItem_.file());
-   if (file.open(QIODevice::ReadOnly | QIODevice::Text))
+   if (file.open(QIODevice::ReadOnly))
    {
+      //
+      // Map local files into memory, so they are parsed in place without being copied, but read
+      // files on network file systems in one go (mapping them would turn every page fault into a
+      // network request, and would fail if the connection is lost while parsing). If the file
+      // cannot be mapped it is read as well. The size, the modification time and the content hash
+      // recorded refer to exactly the content that has been parsed. A mapped file must not be
+      // truncated while being parsed, so the launcher replaces the files it saves (see
+      // ItemSourceEditor) instead of rewriting them in place, and so should other writers.
+      //
+      // Item sources accessing the file themselves (such as databases searched on demand) need
+      // just its header, so only the header is read and hashed, no matter how large the file is.
+      // Any other change is detected by the size and the modification time.
+      //
+
+      importItemLastModified_ = QFileInfo(file).lastModified();
+      importItemSize_ = file.size();
+
+      QByteArray fileContent;
+      qint64 contentSize = importItemSize_;
+
+      uchar* fileData = nullptr;
+
+      auto readSize = itemSource_->readSize();
+      if (readSize >= 0)
+      {
+         fileContent = file.read(readSize);
+
+         contentSize = fileContent.size();
+      }
+      else
+      {
+         if ((importItemSize_ > 0) && (!isNetworkFile_(file.fileName())))
+         {
+            fileData = file.map(0, importItemSize_);
+         }
+
+         if (fileData == nullptr)
+         {
+            fileContent = file.readAll();
+
+            importItemSize_ = fileContent.size();
+            contentSize = importItemSize_;
+         }
+      }
+
+      const char* content = ((fileData != nullptr) ? (reinterpret_cast<const char*>(fileData)) : (fileContent.constData()));
+
+      importItemHash_ = CatalogSnapshot::hash(content, contentSize);
+      importItemHashSize_ = ((readSize >= 0) ? (contentSize) : (-1));
+
+      auto parseBegin = std::chrono::steady_clock::now();
+
       itemSource_->reset();
+      itemSource_->setPublishing(publishBatchSize_, [this]()
+      {
+         emit itemsPublished();
+      });
+
+      //
+      // Compressed files are decompressed while being parsed, so the decompressed content is
+      // never held as a whole (at least by item sources reading the device incrementally).
+      //
+
+      bool itemSourceRead = false;
+
+      QString errorString;
+      QPoint errorPosition;
+
+      auto contentEncoding = importItem_.contentEncoding();
+      if ((contentEncoding == QLatin1String("gzip")) || ((contentEncoding.isEmpty()) && (GzipDevice::isCompressed(content, contentSize))))
+      {
+         QByteArray compressedContent = ((contentSize <= std::numeric_limits<int>::max()) ?
+                                         (QByteArray::fromRawData(content, static_cast<int>(contentSize))) :
+                                         (QByteArray()));
+
+         QBuffer compressedBuffer(&compressedContent);
+         compressedBuffer.open(QIODevice::ReadOnly);
+
+         GzipDevice gzipDevice(&compressedBuffer);
+         if (gzipDevice.open(QIODevice::ReadOnly))
+         {
+            itemSourceRead = itemSource_->read(&gzipDevice, importItem_.file());
+         }
+
+         //
+         // An item source failing to read a corrupt or truncated file reports a parse error at
+         // the point the decompressed data ended, so prefer the error of the decompression.
+         //
+
+         if ((!gzipDevice.isOpen()) || (gzipDevice.hasError()))
+         {
+            itemSourceRead = false;
+
+            errorString = gzipDevice.errorString();
+         }
+         else if (!itemSourceRead)
+         {
+            errorString = itemSource_->errorString();
+            errorPosition = itemSource_->errorPosition();
+         }
+      }
+      else
+      {
+         itemSourceRead = itemSource_->read(content, contentSize, importItem_.file());
+         if (!itemSourceRead)
+         {
+            errorString = itemSource_->errorString();
+            errorPosition = itemSource_->errorPosition();
+         }
+      }
+
+      itemSource_->setPublishing(0, nullptr);
+
+      readDuration_ = std::chrono::duration_cast<std::chrono::microseconds>(parseBegin - readBegin);
+      parseDuration_ = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - parseBegin);
 
-      if (itemSource_->read(&file, importItem_.file()))
+      if (fileData != nullptr)
+      {
+         file.unmap(fileData);
+      }
+
+      if (itemSourceRead)
       {
          emit sourceLoaded();
       }
       else
       {
-         emit sourceFailedToLoad(itemSource_->errorString(), itemSource_->errorPosition());
+         emit sourceFailedToLoad(errorString, errorPosition);
       }
    }
    else
@@ -35,3 +163,20 @@ void ImportItemReader::run()
       emit sourceFailedToLoad(file.errorString());
    }
 }
+
+bool ImportItemReader::isNetworkFile_(const QString& file)
+{
+   //
+   // UNC paths always refer to network shares, whereas any other path is checked for the file
+   // system it resides on.
+   //
+
+   if ((file.startsWith(QStringLiteral("//"))) || (file.startsWith(QStringLiteral("\\\\"))))
+   {
+      return true;
+   }
+
+   static const QList<QByteArray> networkFileSystemTypes = { "nfs", "nfs4", "cifs", "smbfs", "smb2", "smb3", "afs", "9p", "fuse.sshfs", "ncpfs" };
+
+   return networkFileSystemTypes.contains(QStorageInfo(file).fileSystemType().toLower());
+}
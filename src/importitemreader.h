@@ -10,8 +10,11 @@
 #ifndef IMPORTITEMREADER_H
 #define IMPORTITEMREADER_H
 
+#include <chrono>
 #include <memory>
 
+#include <QByteArray>
+#include <QDateTime>
 #include <QFile>
 #include <QObject>
 #include <QPoint>
@@ -51,6 +54,14 @@ public:
    {
       return importItem_;
    }
+   /*!
+    * Returns a pointer to the item source, which is still owned by the reader, or \a nullptr if
+    * the item source is no longer owned by the reader.
+    */
+   ItemSource* itemSource() const
+   {
+      return itemSource_.get();
+   }
    /*!
     * Returns the item source and passes ownership to the caller. If the item source is no
     * longer owned by the reader \a nullptr is retured.
@@ -68,7 +79,66 @@ public:
       return identifier_;
    }
 
+   /*!
+    * Sets the number of items after which the items read are published again to \a batchSize,
+    * or disables publishing if \a batchSize is 0 (which is the default).
+    */
+   void setPublishBatchSize(int batchSize)
+   {
+      publishBatchSize_ = batchSize;
+   }
+
+   /*!
+    * Returns the size of the file of the import item as it has been read.
+    */
+   qint64 importItemSize() const
+   {
+      return importItemSize_;
+   }
+   /*!
+    * Returns the time the file of the import item was last modified when it has been read.
+    */
+   QDateTime importItemLastModified() const
+   {
+      return importItemLastModified_;
+   }
+   /*!
+    * Returns the hash of the content of the file of the import item as it has been read.
+    */
+   QByteArray importItemHash() const
+   {
+      return importItemHash_;
+   }
+   /*!
+    * Returns the number of bytes at the start of the file of the import item the hash has been
+    * calculated for or a negative value if the hash covers the whole file.
+    */
+   qint64 importItemHashSize() const
+   {
+      return importItemHashSize_;
+   }
+
+   /*!
+    * Returns the time it took to read the file of the import item.
+    */
+   std::chrono::microseconds readDuration() const
+   {
+      return readDuration_;
+   }
+   /*!
+    * Returns the time it took to parse the file of the import item.
+    */
+   std::chrono::microseconds parseDuration() const
+   {
+      return parseDuration_;
+   }
+
 signals:
+   /*!
+    * Is emitted when items of the item source have been published while it is being read. The
+    * items are to be taken using ItemSource::takePublishedItems().
+    */
+   void itemsPublished();
    /*!
     * Is emitted when the source with the identifier \a identifier has been successfully loaded.
     */
@@ -92,6 +162,43 @@ private:
     * The identifier to be used.
     */
    QUuid identifier_;
+
+   /*!
+    * The number of items after which the items read are published again.
+    */
+   int publishBatchSize_ = 0;
+
+   /*!
+    * The size of the file of the import item.
+    */
+   qint64 importItemSize_ = -1;
+   /*!
+    * The last modification time of the file of the import item.
+    */
+   QDateTime importItemLastModified_;
+   /*!
+    * The content hash of the file of the import item.
+    */
+   QByteArray importItemHash_;
+   /*!
+    * The number of bytes the content hash has been calculated for or a negative value if it
+    * covers the whole file.
+    */
+   qint64 importItemHashSize_ = -1;
+
+   /*!
+    * The time it took to read the file of the import item.
+    */
+   std::chrono::microseconds readDuration_ = {};
+   /*!
+    * The time it took to parse the file of the import item.
+    */
+   std::chrono::microseconds parseDuration_ = {};
+
+   /*!
+    * Returns \a true if the file \a file resides on a network file system; \a false otherwise.
+    */
+   static bool isNetworkFile_(const QString& file);
 };
 
 #endif // IMPORTITEMREADER_H
@@ -7,17 +7,240 @@
  *          published by the Free Software Foundation.
  */
 
+#include <atomic>
+
+#include <QProcessEnvironment>
+#include <QReadLocker>
+#include <QSet>
+#include <QReadWriteLock>
+#include <QWriteLocker>
+
 #include "item.h"
 
-QString Item::applyProcessEnvironment(const QString &string, const QProcessEnvironment &processEnvironment)
+namespace {
+
+/*!
+ * The lock guarding the process environment snapshot.
+ */
+QReadWriteLock processEnvironmentLock_;
+/*!
+ * The process environment snapshot, mapping variable names to values.
+ */
+QHash<QString, QString> processEnvironment_;
+/*!
+ * Is \a true if a process environment snapshot has been taken.
+ */
+bool processEnvironmentValid_ = false;
+/*!
+ * Is \a true if environment variables in links are resolved when the link is resolved.
+ */
+std::atomic<bool> processEnvironmentDeferred_(false);
+
+/*!
+ * The lock guarding the process environment references.
+ */
+QReadWriteLock processEnvironmentReferencesLock_;
+/*!
+ * The names of the environment variables referenced since the snapshot has been taken.
+ */
+QSet<QString> processEnvironmentReferences_;
+
+/*!
+ * Returns the name of the environment variable \a name as used as key in the snapshot. On
+ * Windows variable names are case-insensitive, so they are stored in upper case.
+ */
+QString processEnvironmentKey(const QString& name)
+{
+#if defined(Q_OS_WIN)
+   return name.toUpper();
+#else
+   return name;
+#endif
+}
+
+/*!
+ * Returns a snapshot of the current process environment.
+ */
+QHash<QString, QString> processEnvironmentSnapshot()
+{
+   QHash<QString, QString> processEnvironment;
+
+   const auto& systemEnvironment = QProcessEnvironment::systemEnvironment();
+   for (const auto& key : systemEnvironment.keys())
+   {
+      processEnvironment.insert(processEnvironmentKey(key), systemEnvironment.value(key));
+   }
+
+   return processEnvironment;
+}
+
+/*!
+ * Returns the process environment snapshot, taking it if none has been taken yet.
+ */
+QHash<QString, QString> currentProcessEnvironment()
+{
+   //
+   // The snapshot is implicitly shared, so copying it just holds a reference while it is in use,
+   // even if it is replaced meanwhile.
+   //
+
+   {
+      QReadLocker processEnvironmentLocker(&processEnvironmentLock_);
+
+      if (processEnvironmentValid_)
+      {
+         return processEnvironment_;
+      }
+   }
+
+   QWriteLocker processEnvironmentLocker(&processEnvironmentLock_);
+
+   if (!processEnvironmentValid_)
+   {
+      processEnvironment_ = processEnvironmentSnapshot();
+      processEnvironmentValid_ = true;
+   }
+
+   return processEnvironment_;
+}
+
+/*!
+ * Records that the environment variable \a name has been referenced. Link parameter placeholders
+ * (such as {0}, {*} or {%1}) are not recorded.
+ */
+void recordProcessEnvironmentReference(const QString& name)
+{
+   if ((name.isEmpty()) || (name.at(0).isDigit()) || (name.at(0) == QLatin1Char('*')) || (name.at(0) == QLatin1Char('%')))
+   {
+      return;
+   }
+
+   const auto& key = processEnvironmentKey(name);
+
+   {
+      QReadLocker processEnvironmentReferencesLocker(&processEnvironmentReferencesLock_);
+
+      if (processEnvironmentReferences_.contains(key))
+      {
+         return;
+      }
+   }
+
+   //
+   // The name may refer to the data of the string being applied, so a deep copy is stored.
+   //
+
+   QWriteLocker processEnvironmentReferencesLocker(&processEnvironmentReferencesLock_);
+
+   processEnvironmentReferences_.insert(QString(key.constData(), key.size()));
+}
+
+} // namespace
+
+void Item::updateProcessEnvironment(bool deferred)
 {
-   QString appliedString = string;
+   auto processEnvironment = processEnvironmentSnapshot();
+
+   QWriteLocker processEnvironmentLocker(&processEnvironmentLock_);
 
-   const auto& keys = processEnvironment.keys();
-   for (const auto& key : keys)
+   processEnvironment_ = std::move(processEnvironment);
+   processEnvironmentValid_ = true;
+   processEnvironmentDeferred_ = deferred;
+
+   QWriteLocker processEnvironmentReferencesLocker(&processEnvironmentReferencesLock_);
+
+   processEnvironmentReferences_.clear();
+}
+
+bool Item::isProcessEnvironmentDeferred()
+{
+   return processEnvironmentDeferred_;
+}
+
+QStringList Item::processEnvironmentReferences()
+{
+   QReadLocker processEnvironmentReferencesLocker(&processEnvironmentReferencesLock_);
+
+   return processEnvironmentReferences_.toList();
+}
+
+QString Item::processEnvironmentValue(const QString& name)
+{
+   return currentProcessEnvironment().value(processEnvironmentKey(name));
+}
+
+QString Item::applyProcessEnvironment(const QString& string)
+{
+   return applyProcessEnvironment(string, currentProcessEnvironment());
+}
+
+QString Item::applyProcessEnvironment(const QString& string, const QHash<QString, QString>& processEnvironment)
+{
+   //
+   // Scan the string once for placeholders, copying the literal text in between and replacing
+   // any placeholder which names a known variable. Strings without placeholders are returned
+   // as they are, without any copy.
+   //
+
+   QString appliedString;
+
+   const auto stringData = string.constData();
+   const auto stringSize = string.size();
+
+   int literalBegin = 0;
+   int placeholderBegin = string.indexOf(QLatin1Char('{'));
+
+   while (placeholderBegin >= 0)
+   {
+      int placeholderEnd = (placeholderBegin + 1);
+      while ((placeholderEnd < stringSize) && (stringData[placeholderEnd] != QLatin1Char('}')) && (stringData[placeholderEnd] != QLatin1Char('{')))
+      {
+         ++placeholderEnd;
+      }
+
+      if (placeholderEnd >= stringSize)
+      {
+         break;
+      }
+
+      if (stringData[placeholderEnd] == QLatin1Char('{'))
+      {
+         //
+         // Placeholders do not nest, so restart at the inner opening brace.
+         //
+
+         placeholderBegin = placeholderEnd;
+
+         continue;
+      }
+
+      const auto& name = QString::fromRawData(stringData + placeholderBegin + 1, placeholderEnd - placeholderBegin - 1);
+
+      recordProcessEnvironmentReference(name);
+
+      auto value = processEnvironment.constFind(processEnvironmentKey(name));
+      if (value != processEnvironment.constEnd())
+      {
+         if (appliedString.isNull())
+         {
+            appliedString.reserve(stringSize);
+         }
+
+         appliedString.append(stringData + literalBegin, placeholderBegin - literalBegin);
+         appliedString.append(value.value());
+
+         literalBegin = (placeholderEnd + 1);
+      }
+
+      placeholderBegin = string.indexOf(QLatin1Char('{'), placeholderEnd + 1);
+   }
+
+   if (literalBegin == 0)
    {
-      appliedString.replace((QStringLiteral("{") + key + QStringLiteral("}")), processEnvironment.value(key));
+      return string;
    }
 
+   appliedString.append(stringData + literalBegin, stringSize - literalBegin);
+
    return appliedString;
 }
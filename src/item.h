@@ -13,7 +13,8 @@
 #include <type_traits>
 
 #include <QHash>
-#include <QProcessEnvironment>
+#include <QString>
+#include <QStringList>
 
 /*!
  * \brief An item.
@@ -24,7 +25,7 @@ public:
    /*!
     * \brief Returns \a true if the item is a or is a base of \a type.
     */
-   enum class Type
+   enum class Type : quint8
    {
       Link,
       Import,
@@ -39,7 +40,7 @@ public:
    /*!
     * \brief The access of the item.
     */
-   enum class Access
+   enum class Access : quint8
    {
       ReadOnly,
       ReadWrite
@@ -68,6 +69,15 @@ public:
       return access_;
    }
 
+   /*!
+    * Returns \a true if the item has been allocated from an item arena, in which case it is
+    * owned by the arena and must not be deleted; \a false otherwise.
+    */
+   bool isArenaAllocated() const
+   {
+      return arenaAllocated_;
+   }
+
    /*!
     * Sets the parent to \a parent.
     */
@@ -89,6 +99,38 @@ public:
    {
       return parent_;
    }
+   /*!
+    * Takes a snapshot of the process environment, which is used to resolve environment variables
+    * in items created afterwards. If \a deferred is \a true environment variables in links are
+    * not resolved when the item is created, but every time the link is resolved.
+    */
+   static void updateProcessEnvironment(bool deferred = false);
+   /*!
+    * Returns \a true if environment variables in links are resolved every time the link is
+    * resolved; \a false if they are resolved when the item is created.
+    */
+   static bool isProcessEnvironmentDeferred();
+   /*!
+    * Returns the names of the environment variables referenced by any string the process
+    * environment has been applied to since the snapshot has been taken, whether the variable is
+    * defined or not. Items depend on the value of these variables (or on their absence).
+    */
+   static QStringList processEnvironmentReferences();
+   /*!
+    * Returns the value of the environment variable \a name in the process environment snapshot
+    * or a null string if the variable is not defined.
+    */
+   static QString processEnvironmentValue(const QString& name);
+
+   /*!
+    * Returns the row of the item within its parent or a negative value if the item has no
+    * parent.
+    */
+   int row() const
+   {
+      return row_;
+   }
+
    /*!
     * Returns the recursive-next parent of the item which is of type \a Type.
     */
@@ -140,12 +182,17 @@ protected:
    }
 
    /*!
-    * Applies the process environment \a processEnvironment to the string \a string and returns
-    * a string that has all enironment variables which are found in the process environment
-    * replaced with their actual value. A variable is defined as _{name}_. If a variable is defined
-    * in the string but not in the process environment it remains in the string.
+    * Applies the process environment snapshot to the string \a string and returns a string that
+    * has all enironment variables which are found in the process environment replaced with their
+    * actual value. A variable is defined as _{name}_. If a variable is defined in the string but
+    * not in the process environment it remains in the string.
     */
-   QString applyProcessEnvironment(const QString& string, const QProcessEnvironment& processEnvironment = QProcessEnvironment::systemEnvironment());
+   static QString applyProcessEnvironment(const QString& string);
+   /*!
+    * Applies the process environment \a processEnvironment, mapping variable names to values, to
+    * the string \a string in a single pass.
+    */
+   static QString applyProcessEnvironment(const QString& string, const QHash<QString, QString>& processEnvironment);
 
 private:
    /*!
@@ -157,11 +204,28 @@ private:
     * The access of the item.
     */
    Access access_;
+   /*!
+    * Is \a true if the item has been allocated from an item arena.
+    */
+   bool arenaAllocated_ = false;
+   /*!
+    * The row of the item within its parent, which is maintained by the parent group item.
+    */
+   int row_ = -1;
 
    /*!
     * A pointer to the parent of this item.
     */
    Item* parent_ = nullptr;
+
+   /*!
+    * The item arena marks the items allocated from it.
+    */
+   friend class ItemArena;
+   /*!
+    * The group item maintains the row of the items it contains.
+    */
+   friend class GroupItem;
 };
 
 /*!
@@ -0,0 +1,101 @@
+/*!
+ * \file itemarena.cpp
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#include <algorithm>
+#include <iterator>
+
+#include "groupitem.h"
+#include "itemarena.h"
+
+namespace {
+
+/*!
+ * The default size of a block of memory.
+ */
+static const std::size_t DEFAULT_BLOCK_SIZE_ = 64 * 1024;
+
+} // namespace
+
+ItemArena::~ItemArena()
+{
+   clear();
+}
+
+void ItemArena::clear()
+{
+   //
+   // Remove the items from every group item first, while all items are still alive, so a group
+   // item deletes just the items it owns (those not allocated from an arena). Then destroy the
+   // items, which no longer refer to each other, so the order of allocation does not matter.
+   //
+
+   for (auto item : items_)
+   {
+      if (auto groupItem = Item::cast<GroupItem>(item))
+      {
+         groupItem->removeItems();
+      }
+   }
+
+   for (auto item : items_)
+   {
+      item->~Item();
+   }
+
+   items_.clear();
+   blocks_.clear();
+
+   size_ = 0;
+}
+
+void ItemArena::splice(ItemArena& arena)
+{
+   items_.insert(items_.end(), arena.items_.begin(), arena.items_.end());
+   blocks_.insert(blocks_.end(), std::make_move_iterator(arena.blocks_.begin()), std::make_move_iterator(arena.blocks_.end()));
+
+   size_ += arena.size_;
+
+   arena.items_.clear();
+   arena.blocks_.clear();
+   arena.size_ = 0;
+}
+
+void* ItemArena::allocate_(std::size_t size, std::size_t alignment)
+{
+   //
+   // Allocate from the current block if there is enough space left, or allocate a new block
+   // otherwise (which is large enough for allocations exceeding the default block size). The
+   // memory of a block is suitably aligned for any fundamental type, so just the offset within
+   // the block has to be aligned.
+   //
+
+   if (!blocks_.empty())
+   {
+      auto& block = blocks_.back();
+
+      auto offset = ((block.used + alignment - 1) & ~(alignment - 1));
+      if ((offset + size) <= block.size)
+      {
+         block.used = (offset + size);
+
+         return (block.data.get() + offset);
+      }
+   }
+
+   Block_ block;
+   block.size = std::max(DEFAULT_BLOCK_SIZE_, size);
+   block.data.reset(new char[block.size]);
+   block.used = size;
+
+   size_ += block.size;
+
+   blocks_.push_back(std::move(block));
+
+   return blocks_.back().data.get();
+}
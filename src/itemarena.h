@@ -0,0 +1,125 @@
+/*!
+ * \file itemarena.h
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#ifndef ITEMARENA_H
+#define ITEMARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "item.h"
+
+/*!
+ * \brief A monotonic arena items are allocated from.
+ *
+ * Items are allocated from large blocks of memory, which are never released individually. All
+ * items are destroyed and all blocks are released at once when the arena is cleared. An item
+ * allocated from an arena must never be deleted. Items may be allocated in any order, a group
+ * item need not be allocated before the items it contains.
+ */
+class ItemArena
+{
+public:
+   /*!
+    * Constructs an empty arena.
+    */
+   ItemArena() = default;
+   /*!
+    * Destructs the arena, destroying all items allocated from it.
+    */
+   ~ItemArena();
+
+   ItemArena(const ItemArena&) = delete;
+   ItemArena& operator=(const ItemArena&) = delete;
+
+   /*!
+    * Creates an item of the type \a ItemType, constructed with the arguments \a arguments, and
+    * returns a pointer to it. The item is owned by the arena.
+    */
+   template <typename ItemType, typename... ArgumentTypes> ItemType* create(ArgumentTypes&&... arguments)
+   {
+      static_assert(std::is_base_of<Item, ItemType>::value, "ItemType must be an Item");
+
+      auto item = new (allocate_(sizeof(ItemType), alignof(ItemType))) ItemType(std::forward<ArgumentTypes>(arguments)...);
+      item->arenaAllocated_ = true;
+
+      items_.push_back(item);
+
+      return item;
+   }
+
+   /*!
+    * Destroys all items allocated from the arena and releases all memory.
+    */
+   void clear();
+   /*!
+    * Moves all items and all memory of the arena \a arena to this arena, leaving \a arena empty.
+    * The items are destroyed after the items already allocated from this arena.
+    */
+   void splice(ItemArena& arena);
+
+   /*!
+    * Returns the number of bytes allocated by the arena.
+    */
+   std::size_t size() const
+   {
+      return size_;
+   }
+   /*!
+    * Returns the number of items allocated from the arena.
+    */
+   std::size_t itemCount() const
+   {
+      return items_.size();
+   }
+
+private:
+   /*!
+    * \brief A block of memory.
+    */
+   struct Block_
+   {
+      /*!
+       * The memory of the block.
+       */
+      std::unique_ptr<char[]> data;
+      /*!
+       * The size of the block.
+       */
+      std::size_t size = 0;
+      /*!
+       * The number of bytes used.
+       */
+      std::size_t used = 0;
+   };
+
+   /*!
+    * The blocks of memory allocated.
+    */
+   std::vector<Block_> blocks_;
+   /*!
+    * The items allocated, in the order of allocation.
+    */
+   std::vector<Item*> items_;
+   /*!
+    * The number of bytes allocated.
+    */
+   std::size_t size_ = 0;
+
+   /*!
+    * Returns a pointer to \a size bytes of memory aligned to \a alignment.
+    */
+   void* allocate_(std::size_t size, std::size_t alignment);
+};
+
+#endif // ITEMARENA_H
@@ -8,95 +8,109 @@
  */
 
 #include <QApplication>
+#include <QFontMetrics>
 #include <QPainter>
+#include <QStyle>
+#include <QTransform>
 
+#include "application.h"
 #include "itemdelegate.h"
-#include "itemmodel.h"
-#include "linkitem.h"
+
+namespace {
+
+/*!
+ * The default number of texts kept in the cache.
+ */
+static const int DEFAULT_TEXT_CACHE_SIZE_ = 1024;
+
+} // namespace
 
 ItemDelegate::ItemDelegate(QObject* parent) : QStyledItemDelegate(parent)
 {
+   textCache_.setMaxCost(qMax(1, static_cast<Application*>(Application::instance())->setting<int>(this, QStringLiteral("textCacheSize"), DEFAULT_TEXT_CACHE_SIZE_)));
 }
 
 void ItemDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
 {
    Q_ASSERT(index.isValid());
 
-   //
-   // Save painter.
-   //
-   painter->save();
+   QStyleOptionViewItem itemOption = option;
+   initStyleOption(&itemOption, index);
 
-   //
-   // Enable anti aliasing.
-   //
-   painter->setRenderHint(QPainter::Antialiasing, true);
-   painter->setRenderHint(QPainter::TextAntialiasing, true);
+   auto widget = itemOption.widget;
+   auto style = ((widget != nullptr) ? (widget->style()) : (QApplication::style()));
 
    //
-   // Draw item border.
+   // Determine the text rectangle (just as the style does) and let the style paint the panel,
+   // the selection and the focus, but not the text.
    //
-   painter->setPen(Qt::darkGray);
-   painter->drawRect(option.rect);
+
+   const int textMargin = style->pixelMetric(QStyle::PM_FocusFrameHMargin, nullptr, widget) + 1;
+   const auto& textRectangle = style->subElementRect(QStyle::SE_ItemViewItemText, &itemOption, widget).adjusted(textMargin, 0, -textMargin, 0);
+
+   const auto text = itemOption.text;
+   itemOption.text.clear();
+
+   style->drawControl(QStyle::CE_ItemViewItem, &itemOption, painter, widget);
+
+   if ((text.isEmpty()) || (textRectangle.width() <= 0))
+   {
+      return;
+   }
 
    //
-   // Draw item background.
+   // Paint the text, which is taken from the cache. The tag string is provided by the model,
+   // which joins the tags once per item instead of once per paint.
    //
-   if ((option.state & QStyle::State_Selected) == 0)
+
+   const auto& staticText = text_(text, textRectangle.width(), itemOption.textElideMode, itemOption.font);
+
+   auto colorGroup = (((itemOption.state & QStyle::State_Enabled) == 0) ? (QPalette::Disabled) :
+                      ((itemOption.state & QStyle::State_Active) == 0) ? (QPalette::Inactive) : (QPalette::Normal));
+   auto colorRole = (((itemOption.state & QStyle::State_Selected) != 0) ? (QPalette::HighlightedText) : (QPalette::Text));
+
+   const auto& textSize = staticText.size();
+
+   QPointF textPosition(textRectangle.left(), textRectangle.top() + ((textRectangle.height() - textSize.height()) / 2.0));
+   if ((itemOption.displayAlignment & Qt::AlignRight) != 0)
    {
-      painter->fillRect(option.rect.adjusted(1, 0, -1, 0), ((index.row() % 2) ? (QColor(236, 236, 236)) : (QColor(255, 255, 255))));
-      painter->setPen(Qt::black);
+      textPosition.setX(textRectangle.right() + 1 - textSize.width());
    }
-   else
+   else if ((itemOption.displayAlignment & Qt::AlignHCenter) != 0)
    {
-      painter->fillRect(option.rect.adjusted(1, 0, -1, 0), option.palette.highlight());
-      painter->setPen(QPen(Qt::white));
+      textPosition.setX(textRectangle.left() + ((textRectangle.width() - textSize.width()) / 2.0));
    }
 
-   //
-   // Set the font (the application default font).
-   //
-   painter->setFont(option.font);
+   painter->save();
+   painter->setFont(itemOption.font);
+   painter->setPen(itemOption.palette.color(colorGroup, colorRole));
+   painter->drawStaticText(textPosition, staticText);
+   painter->restore();
+}
 
+const QStaticText& ItemDelegate::text_(const QString& text, int width, Qt::TextElideMode elideMode, const QFont& font) const
+{
    //
-   // Draw item.
+   // Any text laid out with another font has a different size, so discard the whole cache.
    //
-   if (auto item = Item::cast<LinkItem>(static_cast<const ItemModel*>(index.model())->item(index)))
+
+   if (font != textCacheFont_)
    {
-      //
-      // Draw item name.
-      //
-      QRect itemNameRectangle((option.rect.left() + 4),
-                              (option.rect.top() + 4),
-                              (option.rect.width() / 2) - 8,
-                              (option.rect.height() - 2));
-      QString itemNameString = painter->fontMetrics().elidedText(item->name(), Qt::ElideRight, itemNameRectangle.width());
-
-      painter->drawText(itemNameRectangle, itemNameString, QTextOption(Qt::AlignLeft));
-
-      //
-      // Draw item tags.
-      //
-      QRect itemTagsRectangle ((option.rect.left() + 4) + (option.rect.width() / 2),
-                               (option.rect.top() + 4),
-                               (option.rect.width() / 2) - 8,
-                               (option.rect.height() - 2));
-      QString itemTagsString = painter->fontMetrics().elidedText(item->tags().join(' '), Qt::ElideLeft, itemTagsRectangle.width());
-
-      painter->setPen(QPen(Qt::lightGray));
-      painter->drawText(itemTagsRectangle, itemTagsString, QTextOption(Qt::AlignRight));
+      textCache_.clear();
+      textCacheFont_ = font;
    }
 
-   //
-   // Restore painter.
-   //
-   painter->restore();
-}
+   TextKey_ textKey{text, width, elideMode};
 
-QSize ItemDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
-{
-   QSize sizeHint = QStyledItemDelegate::sizeHint(option, index);
+   auto staticText = textCache_.object(textKey);
+   if (staticText == nullptr)
+   {
+      staticText = new QStaticText(QFontMetrics(font).elidedText(text, elideMode, width));
+      staticText->setTextFormat(Qt::PlainText);
+      staticText->prepare(QTransform(), font);
 
-   return { sizeHint.width(), sizeHint.height() + 4 };
-}
+      textCache_.insert(textKey, staticText);
+   }
 
+   return *staticText;
+}
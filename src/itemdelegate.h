@@ -10,14 +10,26 @@
 #ifndef ITEMDELEGATE_H
 #define ITEMDELEGATE_H
 
+#include <QCache>
+#include <QFont>
+#include <QHash>
 #include <QSize>
+#include <QStaticText>
+#include <QString>
 #include <QStyledItemDelegate>
 
 /*!
  * \brief A delegate painting an item.
+ *
+ * The item panel is painted by the style, whereas the text is painted by the delegate. The text
+ * is elided and laid out once for each text and width, and kept in a least recently used cache,
+ * so rows painted again (for instance while scrolling) are not laid out again. The cache is
+ * cleared when the font changes.
  */
 class ItemDelegate : public QStyledItemDelegate
 {
+   Q_OBJECT
+
 public:
    /*!
     * Constructs an ItemDelegate with the parent \a parent.
@@ -29,10 +41,56 @@ public:
     */
    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
 
+private:
    /*!
-    * \reimp
+    * \brief The key of a text laid out.
+    */
+   struct TextKey_
+   {
+      /*!
+       * The text.
+       */
+      QString text;
+      /*!
+       * The width the text has been elided to.
+       */
+      int width;
+      /*!
+       * The mode the text has been elided with.
+       */
+      Qt::TextElideMode elideMode;
+
+      /*!
+       * Returns \a true if the key is equal to the key \a other; \a false otherwise.
+       */
+      bool operator==(const TextKey_& other) const
+      {
+         return ((width == other.width) && (elideMode == other.elideMode) && (text == other.text));
+      }
+   };
+
+   /*!
+    * Returns the hash value of the key \a key.
+    */
+   friend uint qHash(const TextKey_& key, uint seed = 0)
+   {
+      return (qHash(key.text, seed) ^ (static_cast<uint>(key.width) << 2) ^ static_cast<uint>(key.elideMode));
+   }
+
+   /*!
+    * The texts laid out, evicted least recently used first.
+    */
+   mutable QCache<TextKey_, QStaticText> textCache_;
+   /*!
+    * The font the texts in the cache have been laid out with.
+    */
+   mutable QFont textCacheFont_;
+
+   /*!
+    * Returns the text \a text elided with the mode \a elideMode to the width \a width and laid
+    * out using the font \a font, either from the cache or laid out now.
     */
-   QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+   const QStaticText& text_(const QString& text, int width, Qt::TextElideMode elideMode, const QFont& font) const;
 };
 
 #endif // ITEMDELEGATE_H
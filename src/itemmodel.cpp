@@ -9,85 +9,190 @@
 
 #include <algorithm>
 #include <chrono>
+#include <iterator>
+#include <random>
 
 #include <QFileInfo>
+#include <QSaveFile>
+#include <QThread>
 #include <QThreadPool>
 
 #include "application.h"
+#include "catalogitemsource.h"
 #include "importgroupitem.h"
 #include "itemmodel.h"
 #include "importitemreader.h"
+#include "itemsource.h"
 #include "linkgroupitem.h"
+#include "linkitem.h"
+#include "stringpool.h"
 #include "xmlitemsource.h"
 
 namespace {
 
 /*!
- * The default timeout for retrying failed sources.
+ * The initial timeout for retrying failed sources, which is doubled with each retry.
  */
-static const std::chrono::milliseconds DEFAULT_IMPORT_RETRY_TIMEOUT_ = std::chrono::seconds(10);
+static const std::chrono::milliseconds DEFAULT_IMPORT_RETRY_TIMEOUT_ = std::chrono::seconds(1);
+/*!
+ * The maximum timeout for retrying failed sources.
+ */
+static const std::chrono::milliseconds DEFAULT_IMPORT_RETRY_TIMEOUT_MAXIMUM_ = std::chrono::minutes(5);
+/*!
+ * The relative jitter applied to the timeout for retrying failed sources, so that sources
+ * failing at the same time (for instance because a network share is not reachable) are not
+ * retried at the same time.
+ */
+static const double DEFAULT_IMPORT_RETRY_JITTER_ = 0.25;
+
+/*!
+ * The default period without further change notifications after which a changed file is reloaded.
+ */
+static const int DEFAULT_CHANGE_QUIET_PERIOD_ = 500;
+
+/*!
+ * The default number of items after which the items of an item source being read are added to
+ * the model again.
+ */
+static const int DEFAULT_PUBLISH_BATCH_SIZE_ = 2000;
+
+/*!
+ * The minimum number of threads used to read item sources.
+ */
+static const int DEFAULT_IMPORT_THREAD_COUNT_ = 4;
+
+/*!
+ * Returns the identifier for the file \a file used to detect duplicate item sources before they
+ * are read, which is the canonical path or the absolute path if the file does not exist.
+ */
+QString itemSourceFileIdentifier(const QString& file)
+{
+   QFileInfo fileInfo(file);
+
+   auto fileIdentifier = fileInfo.canonicalFilePath();
+   if (fileIdentifier.isEmpty())
+   {
+      fileIdentifier = fileInfo.absoluteFilePath();
+   }
+
+   return fileIdentifier;
+}
+
+/*!
+ * Returns the timeout for retrying a failed source which has already been retried \a retryCount
+ * times, which exponentially increases up to a maximum and is subject to jitter.
+ */
+std::chrono::milliseconds itemSourceRetryTimeout(int retryCount)
+{
+   static std::mt19937 jitterEngine(std::random_device{}());
+   std::uniform_real_distribution<double> jitterDistribution(1.0 - DEFAULT_IMPORT_RETRY_JITTER_, 1.0 + DEFAULT_IMPORT_RETRY_JITTER_);
+
+   auto timeout = std::min(DEFAULT_IMPORT_RETRY_TIMEOUT_ * (1 << std::min(retryCount, 16)), DEFAULT_IMPORT_RETRY_TIMEOUT_MAXIMUM_);
+
+   return std::chrono::milliseconds(static_cast<std::chrono::milliseconds::rep>(timeout.count() * jitterDistribution(jitterEngine)));
+}
 
 } // namespace
 
 ItemModel::ItemModel(QObject* parent) : QAbstractItemModel(parent)
 {
+   //
+   // Reading item sources is bound by I/O rather than CPU, so allow for more readers than
+   // there are cores.
+   //
+
+   itemSourceReaderPool_.setMaxThreadCount(static_cast<Application*>(Application::instance())->setting<int>(
+                                              this, QStringLiteral("readerThreadCount"),
+                                              qMax(DEFAULT_IMPORT_THREAD_COUNT_, 2 * QThread::idealThreadCount())));
+
    itemSourceWatcher_.connect(&itemSourceWatcher_, &QFileSystemWatcher::fileChanged, [this](const QString& file)
    {
       //
-      // If the item source has changed reload the whole item model. It would be possible to
-      // reload just the item source that has changed, but this requires a dependency tree
-      // to be maintained, as the reloaded item source may have removed an import item, which
-      // prevented the load of a former duplicate item source.
+      // Editors often save a file using several writes or by writing a temporary file which is
+      // then renamed. Defer handling the change until there has been no further change for the
+      // quiet period, so a single save results in a single reload at most.
       //
 
-      qInfo() << "item source changed" << file;
+      qDebug() << "item source change notified" << file;
 
-      read(itemSourceFile_);
+      auto& itemSourceChangeTimer = itemSourceChangeTimers_[file];
+      if (itemSourceChangeTimer == nullptr)
+      {
+         itemSourceChangeTimer = new QTimer(this);
+         itemSourceChangeTimer->setSingleShot(true);
+         itemSourceChangeTimer->connect(itemSourceChangeTimer, &QTimer::timeout, this, [this, file]()
+         {
+            itemSourceChanged_(file);
+         });
+      }
+
+      itemSourceChangeTimer->start(static_cast<Application*>(Application::instance())->setting<int>(
+                                      this, QStringLiteral("changeQuietPeriod"), DEFAULT_CHANGE_QUIET_PERIOD_));
    });
 
-   itemSourceReaderQueueTimer_.start(1000);
-   itemSourceReaderQueueTimer_.connect(&itemSourceReaderQueueTimer_, &QTimer::timeout, [this]()
+   itemSourceWatcher_.connect(&itemSourceWatcher_, &QFileSystemWatcher::directoryChanged, [this](const QString& directory)
    {
       //
-      // The item source reader queue contains readers, which failed to load their source, either
-      // because there was a parsing error or the file did not exist. Schedule this failed readers
-      // periodically, so any files that have been added are reloaded. The file system watcher
-      // cannot be used for this task, as it cannot be used to monitor files which do not exist.
-      // In addition, it may be very possible that the file indeed exists, but is not yet reachable
-      // because it resides for instance on a network share.
+      // The directory of an item source which failed to load because the file did not exist has
+      // changed. Retry any reader whose file exists now immediately, instead of waiting for the
+      // retry timeout to expire.
       //
 
       auto now = std::chrono::steady_clock::now();
 
-      for (auto itemSourceReader = std::begin(itemSourceReaderQueue_); itemSourceReader != std::end(itemSourceReaderQueue_); )
+      for (auto& itemSourceReader : itemSourceReaderQueue_)
       {
-         if (std::chrono::duration_cast<std::chrono::milliseconds>(now - itemSourceReader->second) > DEFAULT_IMPORT_RETRY_TIMEOUT_)
-         {
-            qInfo() << "retry item source" << itemSourceReader->first->importItem();
+         const auto& file = itemSourceReader.reader->importItem().file();
 
-            QThreadPool::globalInstance()->start(itemSourceReader->first);
-
-            itemSourceReader = itemSourceReaderQueue_.erase(itemSourceReader);
-         }
-         else
+         if ((!itemSourceReader.running) && (QFileInfo(file).absolutePath() == directory) && (QFileInfo::exists(file)))
          {
-            ++itemSourceReader;
+            qInfo() << "item source appeared" << file;
+
+            itemSourceReader.due = now;
          }
       }
+
+      scheduleItemSourceReaderQueue_();
+   });
+
+   //
+   // The item source reader queue contains readers, which failed to load their source, either
+   // because there was a parsing error or the file did not exist. The file system watcher cannot
+   // be used to detect any files that have been added, as it cannot be used to monitor files
+   // which do not exist (the directory is watched instead, if it exists). In addition, it may be
+   // very possible that the file indeed exists, but is not yet reachable because it resides for
+   // instance on a network share. Retry the readers with an exponential backoff instead.
+   //
+
+   itemSourceReaderQueueTimer_.setSingleShot(true);
+   itemSourceReaderQueueTimer_.connect(&itemSourceReaderQueueTimer_, &QTimer::timeout, [this]()
+   {
+      processItemSourceReaderQueue_();
    });
 }
 
 ItemModel::~ItemModel()
 {
+   cancelSnapshotWriter_();
+
+   //
+   // Item sources still being read are owned by their readers.
+   //
+
+   for (auto itemSource : itemSourcesPublished_)
+   {
+      GroupItem::removeItem(itemSource);
+   }
 }
 
-void ItemModel::read(const QString& file)
+void ItemModel::read(const QString& file, ReadMode readMode)
 {
    //
-   // Store the item source file.
+   // Store the item source file and the way it is read.
    //
 
    itemSourceFile_ = file;
+   readMode_ = readMode;
 
    //
    // Discard any item source watcher.
@@ -97,31 +202,122 @@ void ItemModel::read(const QString& file)
    {
       itemSourceWatcher_.removePaths(itemSourceWatcher_.files());
    }
+   if (!itemSourceWatcher_.directories().isEmpty())
+   {
+      itemSourceWatcher_.removePaths(itemSourceWatcher_.directories());
+   }
+
+   //
+   // The items are about to be discarded, so the snapshot writer must no longer access them.
+   //
+
+   cancelSnapshotWriter_();
 
    //
    // Discard any pending asynchronous item read operations,
    //
 
+   //
+   // Any reader which is currently running is discarded as soon as it has finished, as it is no
+   // longer part of the current epoch.
+   //
+
+   for (const auto& itemSourceReader : itemSourceReaderQueue_)
+   {
+      if (!itemSourceReader.running)
+      {
+         itemSourceReader.reader->deleteLater();
+      }
+   }
+
    itemSourceReaderQueue_.clear();
+   itemSourceReaderQueueTimer_.stop();
+
+   for (const auto& itemSourceChangeTimer : itemSourceChangeTimers_)
+   {
+      itemSourceChangeTimer->stop();
+   }
    itemSourceReaderQueueIdentifier_ = QUuid::createUuid();
+   itemSourceReaderCount_ = 0;
+   itemSourceReaderFiles_.clear();
 
    //
    // Discard any existing items.
    //
 
    beginResetModel();
+
+   for (auto itemSource : itemSourcesPublished_)
+   {
+      GroupItem::removeItem(itemSource);
+   }
+   itemSourcesPublished_.clear();
+
    GroupItem::removeItems();
+
    endResetModel();
 
+   itemSourceDependencies_.clear();
+
+   searchTruncated_ = false;
+
+   //
+   // Take a new snapshot of the process environment, which is used to resolve the environment
+   // variables of the items read.
+   //
+
+   Item::updateProcessEnvironment((readMode == ReadMode::Compile) ||
+                                  (static_cast<Application*>(Application::instance())->setting<bool>(this, QStringLiteral("deferProcessEnvironment"), false)));
+
    //
-   // Read the item source.
+   // Release the interned strings which were used by the discarded items only.
    //
 
-   readItemSource_(ImportItem(file, QStringLiteral("text/xml")));
+   StringPool::squeeze();
+
+   //
+   // Read the catalog snapshot if preferred and enabled, and read the item source if there is no
+   // valid snapshot.
+   //
+
+   if ((readMode == ReadMode::PreferSnapshot) &&
+       (static_cast<Application*>(Application::instance())->setting<bool>(this, QStringLiteral("snapshot"), true)) &&
+       (readSnapshot_()))
+   {
+      return;
+   }
+
+   //
+   // A compiled catalog may be read instead of the file it has been compiled from.
+   //
+
+   readItemSource_(ImportItem(file, (QFileInfo(file).suffix() == QLatin1String("lcat")) ? (QStringLiteral("application/x-launcher-catalog")) : (QStringLiteral("text/xml"))));
 }
 
-void ItemModel::write(const QString& /* fileName */)
+bool ItemModel::write(const QString& fileName)
 {
+   auto writeStart = std::chrono::steady_clock::now();
+
+   QVector<const LinkItem*> items;
+   apply<LinkItem>([&items](const QModelIndex& /* index */, const LinkItem* item)
+   {
+      items.append(item);
+   });
+
+   QSaveFile file(fileName);
+
+   bool result = ((file.open(QIODevice::WriteOnly)) && (CatalogItemSource::write(&file, items)) && (file.commit()));
+   if (result)
+   {
+      qInfo() << "compiled catalog written" << fileName << items.size() << "items"
+              << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - writeStart).count() << "ms";
+   }
+   else
+   {
+      qWarning() << "compiled catalog not written" << fileName << file.errorString();
+   }
+
+   return result;
 }
 
 QModelIndex ItemModel::index(int row, int column, const QModelIndex& parent) const
@@ -131,13 +327,16 @@ QModelIndex ItemModel::index(int row, int column, const QModelIndex& parent) con
    const GroupItem* groupItem = this;
    if (parent.isValid())
    {
-      groupItem = static_cast<const GroupItem*>(parent.internalPointer());
+      groupItem = Item::cast<GroupItem>(static_cast<const Item*>(parent.internalPointer()));
    }
 
-   Item* item = const_cast<Item*>(groupItem->item(row));
-   if (item != nullptr)
+   if (groupItem != nullptr)
    {
-      index = createIndex(row, column, item);
+      Item* item = const_cast<Item*>(groupItem->item(row));
+      if (item != nullptr)
+      {
+         index = createIndex(row, column, item);
+      }
    }
 
    return index;
@@ -147,13 +346,18 @@ QModelIndex ItemModel::parent(const QModelIndex& child) const
 {
    QModelIndex index;
 
-   Item* item = static_cast<GroupItem*>(child.internalPointer());
+   Item* item = static_cast<Item*>(child.internalPointer());
    if (item != nullptr)
    {
-      GroupItem* parentItem = static_cast<GroupItem*>(item->parent());
-      if (parentItem != this)
+      //
+      // The parent of any item but the item sources is an item within the model, whose row is
+      // maintained by its own parent.
+      //
+
+      Item* parentItem = item->parent();
+      if ((parentItem != nullptr) && (parentItem != static_cast<const GroupItem*>(this)))
       {
-         index = createIndex(0, 0, item->parent());
+         index = createIndex(parentItem->row(), 0, parentItem);
       }
    }
 
@@ -226,6 +430,75 @@ QVariant ItemModel::data(const QModelIndex &index, int role) const
    return data;
 }
 
+QVector<ItemSourceStatistics> ItemModel::itemSourceStatistics() const
+{
+   QVector<ItemSourceStatistics> statistics;
+   statistics.reserve(itemCount());
+
+   //
+   // Item sources added to the model while still being read are skipped, as their reader is
+   // still allocating items concurrently. The strings are collected into a single set, so strings
+   // shared across item sources are counted just once.
+   //
+
+   QSet<const void*> strings;
+
+   for (const auto& item : items())
+   {
+      auto itemSource = Item::cast<ItemSource>(item);
+      if ((itemSource != nullptr) && (!itemSourcesPublished_.contains(itemSource)))
+      {
+         statistics.append(ItemSourceStatistics::collect(itemSource, &strings));
+      }
+   }
+
+   return statistics;
+}
+
+void ItemModel::search(const SearchExpression& searchExpression)
+{
+   searchTruncated_ = false;
+
+   for (auto item : items())
+   {
+      auto itemSource = Item::cast<ItemSource>(item);
+      if ((itemSource == nullptr) || (!itemSource->isSearchable()))
+      {
+         continue;
+      }
+
+      auto itemSourceIndex = createIndex(itemSource->row(), 0, itemSource);
+
+      //
+      // Discard the items created for the previous search expression before creating the items
+      // for the current one, so the memory used does not depend on the size of the item source.
+      //
+
+      if (itemSource->itemCount() > 0)
+      {
+         beginRemoveRows(itemSourceIndex, 0, itemSource->itemCount() - 1);
+         itemSource->reset();
+         endRemoveRows();
+      }
+
+      auto searchItems = itemSource->search(searchExpression);
+
+      searchTruncated_ = ((searchTruncated_) || (itemSource->isSearchTruncated()));
+
+      if (!searchItems.isEmpty())
+      {
+         beginInsertRows(itemSourceIndex, 0, searchItems.size() - 1);
+         for (auto searchItem : searchItems)
+         {
+            itemSource->insertItem(searchItem, itemSource->itemCount());
+         }
+         endInsertRows();
+      }
+   }
+
+   emit searched();
+}
+
 Item* ItemModel::item(const QModelIndex& index)
 {
    Item* item = nullptr;
@@ -255,6 +528,20 @@ bool ItemModel::readItemSource_(const ImportItem& item)
 
    qInfo() << "read item source" << item;
 
+   //
+   // Discard the item if the file is already being read or has already been read in the current
+   // epoch, so that diamond-shaped or recursive imports are read just once. The item source read
+   // first is the one added to the model, so there is no result to be joined.
+   //
+
+   auto itemSourceFileIdentifier = itemSourceFileIdentifier(item.file());
+   if (itemSourceReaderFiles_.contains(itemSourceFileIdentifier))
+   {
+      qInfo() << "duplicate item source discarded" << itemSourceFileIdentifier;
+
+      return result;
+   }
+
    auto itemSource = static_cast<Application*>(Application::instance())->itemSourceFactory()->create(item.mimeType());
    if (itemSource)
    {
@@ -262,6 +549,22 @@ bool ItemModel::readItemSource_(const ImportItem& item)
       if (itemSourceReader)
       {
          itemSourceReader->setAutoDelete(false);
+         itemSourceReader->setPublishBatchSize(static_cast<Application*>(Application::instance())->setting<int>(
+                                                  this, QStringLiteral("publishBatchSize"), DEFAULT_PUBLISH_BATCH_SIZE_));
+         itemSourceReader->connect(itemSourceReader, &ImportItemReader::itemsPublished, this, [this, itemSourceReader]()
+         {
+            //
+            // Add the items read so far to the model, so they can be searched while the rest of
+            // the item source is still being read. If the file is already part of the model the
+            // item source is a duplicate, which is discarded as soon as it has been read.
+            //
+
+            if ((itemSourceReader->identifier() == itemSourceReaderQueueIdentifier_) &&
+                (!itemSourceWatcher_.files().contains(QFileInfo(itemSourceReader->importItem().file()).canonicalFilePath())))
+            {
+               publishItems_(itemSourceReader->itemSource());
+            }
+         }, Qt::QueuedConnection);
          itemSourceReader->connect(itemSourceReader, &ImportItemReader::sourceLoaded, this, [this, itemSourceReader]()
          {
             auto itemSource = itemSourceReader->releaseItemSource();
@@ -275,7 +578,10 @@ bool ItemModel::readItemSource_(const ImportItem& item)
             // successfully).
             //
 
-            qDebug() << "item source loaded" << itemSourceReader->importItem() << itemSource->items().length();
+            qInfo() << "item source loaded" << itemSourceReader->importItem() << itemSource->items().length()
+                    << "size" << itemSourceReader->importItemSize() << "bytes"
+                    << "read" << itemSourceReader->readDuration().count() << "us"
+                    << "parse" << itemSourceReader->parseDuration().count() << "us";
 
             if (itemSourceReader->identifier() == itemSourceReaderQueueIdentifier_)
             {
@@ -292,6 +598,39 @@ bool ItemModel::readItemSource_(const ImportItem& item)
 
                   itemSourceWatcher_.addPath(canonicalImportFilePath);
 
+                  //
+                  // Record the file the item source has been read from as dependency of the
+                  // catalog snapshot.
+                  //
+
+                  CatalogSnapshot::Dependency itemSourceDependency;
+                  itemSourceDependency.file = canonicalImportFilePath;
+                  itemSourceDependency.identifier = itemSource->identifier();
+                  itemSourceDependency.mimeType = itemSourceReader->importItem().mimeType();
+                  itemSourceDependency.size = itemSourceReader->importItemSize();
+                  itemSourceDependency.lastModified = itemSourceReader->importItemLastModified();
+                  itemSourceDependency.hash = itemSourceReader->importItemHash();
+                  itemSourceDependency.hashSize = itemSourceReader->importItemHashSize();
+
+                  itemSourceDependencies_.insert(itemSource.get(), itemSourceDependency);
+
+                  //
+                  // Add the items published since the last batch to the item source (and to the
+                  // model if the item source has already been added while being read).
+                  //
+
+                  if (itemSourcesPublished_.contains(itemSource.get()))
+                  {
+                     publishItems_(itemSource.get());
+                  }
+                  else
+                  {
+                     for (auto item : itemSource->takePublishedItems())
+                     {
+                        itemSource->insertItem(item, itemSource->itemCount());
+                     }
+                  }
+
                   //
                   // Recursively parse the imported item for any other import item.
                   //
@@ -299,21 +638,59 @@ bool ItemModel::readItemSource_(const ImportItem& item)
                   itemSource->apply<ImportItem, ImportGroupItem>([this](ImportItem* item) { readItemSource_(*item); });
 
                   //
-                  // Release the item from the import item reader and add it to the model.
+                  // Release the item from the import item reader and add it to the model, unless
+                  // it has already been added while being read, in which case just the ownership
+                  // passes to the model.
                   //
 
-                  beginResetModel();
-                  GroupItem::insertItem(itemSource.release(), itemCount());
-                  endResetModel();
+                  if (itemSourcesPublished_.remove(itemSource.get()))
+                  {
+                     itemSource.release();
+                  }
+                  else
+                  {
+                     beginInsertRows(QModelIndex(), itemCount(), itemCount());
+                     GroupItem::insertItem(itemSource.release(), itemCount());
+                     endInsertRows();
+                  }
 
                   emit sourceLoaded(itemSourceReader->importItem().file());
                }
                else
                {
                   qInfo() << "duplicate item source discarded" << canonicalImportFilePath;
+
+                  unpublishItemSource_(itemSource.get());
+               }
+
+               //
+               // If the item source has been retried it is no longer to be retried, and the
+               // directory is no longer to be watched if no other retried reader requires it.
+               //
+
+               auto itemSourceReaderRetry = std::find_if(std::begin(itemSourceReaderQueue_), std::end(itemSourceReaderQueue_),
+                                                         [itemSourceReader](const ItemSourceReaderRetry_& itemSourceReaderRetry)
+               {
+                  return (itemSourceReaderRetry.reader == itemSourceReader);
+               });
+               if (itemSourceReaderRetry != std::end(itemSourceReaderQueue_))
+               {
+                  itemSourceReaderQueue_.erase(itemSourceReaderRetry);
+
+                  auto itemSourceDirectory = QFileInfo(itemSourceReader->importItem().file()).absolutePath();
+                  if (std::none_of(std::begin(itemSourceReaderQueue_), std::end(itemSourceReaderQueue_),
+                                   [itemSourceDirectory](const ItemSourceReaderRetry_& itemSourceReaderRetry)
+                  {
+                     return (QFileInfo(itemSourceReaderRetry.reader->importItem().file()).absolutePath() == itemSourceDirectory);
+                  }) && (itemSourceWatcher_.directories().contains(itemSourceDirectory)))
+                  {
+                     itemSourceWatcher_.removePath(itemSourceDirectory);
+                  }
                }
 
                itemSourceReader->deleteLater();
+
+               itemSourceReaderFinished_();
             }
             else
             {
@@ -329,16 +706,64 @@ bool ItemModel::readItemSource_(const ImportItem& item)
 
             if (itemSourceReader->identifier() == itemSourceReaderQueueIdentifier_)
             {
+               //
+               // Remove any item already added to the model while the item source was read, as
+               // the item source is incomplete.
+               //
+
+               unpublishItemSource_(itemSourceReader->itemSource());
+
                //
                // If the item cannot be loaded successfully add it to the queue of readers to
-               // be retried at some later point in time,
+               // be retried at some later point in time, or increase the timeout if it is
+               // already queued.
                //
 
-               qInfo() << "item source retry scheduled";
+               auto itemSourceReaderRetry = std::find_if(std::begin(itemSourceReaderQueue_), std::end(itemSourceReaderQueue_),
+                                                         [itemSourceReader](const ItemSourceReaderRetry_& itemSourceReaderRetry)
+               {
+                  return (itemSourceReaderRetry.reader == itemSourceReader);
+               });
+               if (itemSourceReaderRetry == std::end(itemSourceReaderQueue_))
+               {
+                  ItemSourceReaderRetry_ newItemSourceReaderRetry;
+                  newItemSourceReaderRetry.reader = itemSourceReader;
+
+                  itemSourceReaderQueue_.append(newItemSourceReaderRetry);
+                  itemSourceReaderRetry = std::prev(std::end(itemSourceReaderQueue_));
+               }
+               else
+               {
+                  ++itemSourceReaderRetry->retryCount;
+               }
+
+               auto retryTimeout = itemSourceRetryTimeout(itemSourceReaderRetry->retryCount);
+
+               itemSourceReaderRetry->running = false;
+               itemSourceReaderRetry->due = std::chrono::steady_clock::now() + retryTimeout;
+
+               qInfo() << "item source retry scheduled" << retryTimeout.count() << "ms";
+
+               //
+               // If the file does not exist watch its directory, so the item source is read as
+               // soon as the file has been created.
+               //
+
+               QFileInfo itemSourceFileInfo(itemSourceReader->importItem().file());
+               if ((!itemSourceFileInfo.exists()) &&
+                   (QFileInfo(itemSourceFileInfo.absolutePath()).isDir()) &&
+                   (!itemSourceWatcher_.directories().contains(itemSourceFileInfo.absolutePath())))
+               {
+                  qInfo() << "add directory file system watcher" << itemSourceFileInfo.absolutePath();
+
+                  itemSourceWatcher_.addPath(itemSourceFileInfo.absolutePath());
+               }
 
-               itemSourceReaderQueue_.append(qMakePair(itemSourceReader, std::chrono::steady_clock::now()));
+               scheduleItemSourceReaderQueue_();
 
                emit sourceFailedToLoad(itemSourceReader->importItem().file(), errorString, errorPosition);
+
+               itemSourceReaderFinished_();
             }
             else
             {
@@ -348,7 +773,12 @@ bool ItemModel::readItemSource_(const ImportItem& item)
             }
          }, Qt::QueuedConnection);
 
-         QThreadPool::globalInstance()->start(itemSourceReader);
+         ++itemSourceReaderCount_;
+
+         itemSourceReaderFiles_.insert(itemSourceFileIdentifier);
+         itemSourceReaderPool_.start(itemSourceReader);
+
+         result = true;
       }
    }
    else
@@ -360,3 +790,301 @@ bool ItemModel::readItemSource_(const ImportItem& item)
 
    return result;
 }
+
+void ItemModel::publishItems_(ItemSource* itemSource)
+{
+   if (itemSource == nullptr)
+   {
+      return;
+   }
+
+   auto items = itemSource->takePublishedItems();
+   if (items.isEmpty())
+   {
+      return;
+   }
+
+   if (!itemSourcesPublished_.contains(itemSource))
+   {
+      qInfo() << "item source published" << itemSource->identifier();
+
+      beginInsertRows(QModelIndex(), itemCount(), itemCount());
+      GroupItem::insertItem(itemSource, itemCount());
+      endInsertRows();
+
+      itemSourcesPublished_.insert(itemSource);
+   }
+
+   beginInsertRows(createIndex(itemSource->row(), 0, itemSource), itemSource->itemCount(), itemSource->itemCount() + items.size() - 1);
+   for (auto item : items)
+   {
+      itemSource->insertItem(item, itemSource->itemCount());
+   }
+   endInsertRows();
+
+   qDebug() << "items published" << itemSource->identifier() << items.size();
+}
+
+void ItemModel::unpublishItemSource_(ItemSource* itemSource)
+{
+   if ((itemSource != nullptr) && (itemSourcesPublished_.remove(itemSource)))
+   {
+      qInfo() << "item source unpublished" << itemSource->identifier();
+
+      beginRemoveRows(QModelIndex(), itemSource->row(), itemSource->row());
+      GroupItem::removeItem(itemSource);
+      endRemoveRows();
+   }
+}
+
+void ItemModel::itemSourceReaderFinished_()
+{
+   Q_ASSERT(itemSourceReaderCount_ > 0);
+
+   if (--itemSourceReaderCount_ == 0)
+   {
+      //
+      // If there are no more readers running all item sources have been read. Write the catalog
+      // snapshot, but only if every item source could be read, so that the snapshot is never
+      // taken from an incomplete catalog, and not if the catalog is compiled, as its environment
+      // variables are left unresolved.
+      //
+
+      const auto& stringPoolStatistics = StringPool::statistics();
+
+      qInfo() << "item sources loaded";
+      qInfo() << "string pool" << stringPoolStatistics.count << "strings" << stringPoolStatistics.size << "bytes"
+              << "hit rate" << stringPoolStatistics.hitRate() << "saved" << stringPoolStatistics.savedSize << "bytes";
+
+      if ((readMode_ != ReadMode::Compile) && (itemSourceReaderQueue_.isEmpty()))
+      {
+         writeSnapshot_();
+      }
+
+      emit sourcesLoaded();
+   }
+}
+
+void ItemModel::itemSourceChanged_(const QString& file)
+{
+   //
+   // If the file has been replaced (for instance by renaming a temporary file) the file system
+   // watcher no longer watches it, so watch it again.
+   //
+
+   if ((!itemSourceWatcher_.files().contains(file)) && (QFileInfo::exists(file)))
+   {
+      qInfo() << "add file system watcher" << file;
+
+      itemSourceWatcher_.addPath(file);
+   }
+
+   auto itemSourceDependency = std::find_if(std::begin(itemSourceDependencies_), std::end(itemSourceDependencies_),
+                                            [file](const CatalogSnapshot::Dependency& itemSourceDependency)
+   {
+      return (itemSourceDependency.file == file);
+   });
+
+   if (itemSourceDependency == std::end(itemSourceDependencies_))
+   {
+      qInfo() << "item source changed" << file;
+
+      read(itemSourceFile_, ReadMode::IgnoreSnapshot);
+
+      return;
+   }
+
+   //
+   // Compare the content of the file with the content at the time it has been read, and just
+   // reload if it has changed (so touching the file does not cause a reload). If the item source
+   // has changed reload the whole item model. It would be possible to reload just the item source
+   // that has changed, but this requires a dependency tree to be maintained, as the reloaded item
+   // source may have removed an import item, which prevented the load of a former duplicate item
+   // source.
+   //
+
+   auto itemSourceValidator = new CatalogSnapshotValidator({itemSourceDependency.value()}, itemSourceReaderQueueIdentifier_);
+   itemSourceValidator->setAutoDelete(false);
+   itemSourceValidator->connect(itemSourceValidator, &CatalogSnapshotValidator::dependencyChanged, this, [this, itemSourceValidator](const QString& file)
+   {
+      if (itemSourceValidator->identifier() == itemSourceReaderQueueIdentifier_)
+      {
+         qInfo() << "item source changed" << file;
+
+         read(itemSourceFile_, ReadMode::IgnoreSnapshot);
+      }
+
+      itemSourceValidator->deleteLater();
+   }, Qt::QueuedConnection);
+   itemSourceValidator->connect(itemSourceValidator, &CatalogSnapshotValidator::dependenciesValid, this, [file, itemSourceValidator]()
+   {
+      qInfo() << "item source unchanged" << file;
+
+      itemSourceValidator->deleteLater();
+   }, Qt::QueuedConnection);
+
+   itemSourceReaderPool_.start(itemSourceValidator);
+}
+
+void ItemModel::processItemSourceReaderQueue_()
+{
+   auto now = std::chrono::steady_clock::now();
+
+   for (auto& itemSourceReader : itemSourceReaderQueue_)
+   {
+      if ((!itemSourceReader.running) && (itemSourceReader.due <= now))
+      {
+         qInfo() << "retry item source" << itemSourceReader.reader->importItem();
+
+         itemSourceReader.running = true;
+
+         ++itemSourceReaderCount_;
+
+         itemSourceReaderPool_.start(itemSourceReader.reader);
+      }
+   }
+
+   scheduleItemSourceReaderQueue_();
+}
+
+void ItemModel::scheduleItemSourceReaderQueue_()
+{
+   auto due = std::chrono::steady_clock::time_point::max();
+
+   for (const auto& itemSourceReader : itemSourceReaderQueue_)
+   {
+      if (!itemSourceReader.running)
+      {
+         due = std::min(due, itemSourceReader.due);
+      }
+   }
+
+   if (due != std::chrono::steady_clock::time_point::max())
+   {
+      auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(due - std::chrono::steady_clock::now());
+
+      itemSourceReaderQueueTimer_.start(static_cast<int>(std::max(timeout.count(), static_cast<std::chrono::milliseconds::rep>(0))));
+   }
+   else
+   {
+      itemSourceReaderQueueTimer_.stop();
+   }
+}
+
+bool ItemModel::readSnapshot_()
+{
+   CatalogSnapshot snapshot(itemSourceFile_);
+   if (!snapshot.read())
+   {
+      qInfo() << "snapshot rejected" << snapshot.fileName() << snapshot.errorString();
+
+      return false;
+   }
+
+   qInfo() << "read snapshot" << snapshot.fileName();
+
+   const auto& dependencies = snapshot.dependencies();
+   auto itemSources = snapshot.releaseItemSources();
+
+   //
+   // Add the item sources to the model and watch the files they have been read from, as if they
+   // had been read from the files themselves.
+   //
+
+   beginResetModel();
+   for (std::size_t itemSourceIndex = 0; itemSourceIndex < itemSources.size(); ++itemSourceIndex)
+   {
+      itemSourceWatcher_.addPath(dependencies[static_cast<int>(itemSourceIndex)].file);
+      itemSourceDependencies_.insert(itemSources[itemSourceIndex].get(), dependencies[static_cast<int>(itemSourceIndex)]);
+
+      GroupItem::insertItem(itemSources[itemSourceIndex].release(), itemCount());
+   }
+   endResetModel();
+
+   for (const auto& dependency : dependencies)
+   {
+      emit sourceLoaded(dependency.identifier);
+   }
+
+   emit sourcesLoaded();
+
+   //
+   // The snapshot has been validated by size and modification time only. Revalidate the content
+   // of the files in the background and reread the item sources if any of them has changed.
+   //
+
+   auto snapshotValidator = new CatalogSnapshotValidator(dependencies, itemSourceReaderQueueIdentifier_);
+   snapshotValidator->setAutoDelete(false);
+   snapshotValidator->connect(snapshotValidator, &CatalogSnapshotValidator::dependencyChanged, this, [this, snapshotValidator](const QString& file)
+   {
+      if (snapshotValidator->identifier() == itemSourceReaderQueueIdentifier_)
+      {
+         qInfo() << "snapshot dependency changed" << file;
+
+         read(itemSourceFile_, ReadMode::IgnoreSnapshot);
+      }
+
+      snapshotValidator->deleteLater();
+   }, Qt::QueuedConnection);
+   snapshotValidator->connect(snapshotValidator, &CatalogSnapshotValidator::dependenciesValid, this, [snapshotValidator]()
+   {
+      qDebug() << "snapshot dependencies valid";
+
+      snapshotValidator->deleteLater();
+   }, Qt::QueuedConnection);
+
+   itemSourceReaderPool_.start(snapshotValidator);
+
+   return true;
+}
+
+void ItemModel::writeSnapshot_()
+{
+   QVector<const ItemSource*> itemSources;
+   QVector<CatalogSnapshot::Dependency> dependencies;
+
+   for (const auto& item : GroupItem::items())
+   {
+      if (auto itemSource = Item::cast<ItemSource>(item))
+      {
+         auto itemSourceDependency = itemSourceDependencies_.find(itemSource);
+         if (itemSourceDependency != itemSourceDependencies_.end())
+         {
+            itemSources.append(itemSource);
+            dependencies.append(itemSourceDependency.value());
+         }
+      }
+   }
+
+   //
+   // The item sources which have been read completely are no longer modified until the model is
+   // read again, so the snapshot is written in the background rather than blocking the user
+   // interface; reading the model again cancels the writer first.
+   //
+
+   cancelSnapshotWriter_();
+
+   auto snapshotWriter = new CatalogSnapshotWriter(itemSourceFile_, itemSources, dependencies);
+   snapshotWriter->setAutoDelete(false);
+   snapshotWriter->connect(snapshotWriter, &CatalogSnapshotWriter::finished, this, [this, snapshotWriter]()
+   {
+      if (snapshotWriter_ == snapshotWriter)
+      {
+         snapshotWriter_ = nullptr;
+      }
+   }, Qt::QueuedConnection);
+   snapshotWriter->connect(snapshotWriter, &CatalogSnapshotWriter::finished, snapshotWriter, &CatalogSnapshotWriter::deleteLater, Qt::QueuedConnection);
+
+   snapshotWriter_ = snapshotWriter;
+
+   itemSourceReaderPool_.start(snapshotWriter);
+}
+
+void ItemModel::cancelSnapshotWriter_()
+{
+   if (snapshotWriter_ != nullptr)
+   {
+      snapshotWriter_->cancel();
+      snapshotWriter_ = nullptr;
+   }
+}
@@ -11,18 +11,24 @@
 #define ITEMMODEL_H
 
 #include <chrono>
-#include <functional>
 
 #include <QAbstractListModel>
 #include <QFileSystemWatcher>
+#include <QHash>
+#include <QSet>
 #include <QString>
+#include <QThreadPool>
 #include <QTimer>
 #include <QUuid>
 
+#include "catalogsnapshot.h"
 #include "groupitem.h"
+#include "itemsourcestatistics.h"
 
 class ImportItem;
 class ImportItemReader;
+class ItemSource;
+class SearchExpression;
 
 /*!
  * \brief An item model representing the items found in an XML-based source file.
@@ -32,6 +38,16 @@ class ItemModel : public QAbstractItemModel, public GroupItem
    Q_OBJECT
 
 public:
+   /*!
+    * The way the model data is read.
+    */
+   enum class ReadMode
+   {
+      PreferSnapshot, /*< The model is read from the catalog snapshot if it is valid. */
+      IgnoreSnapshot, /*< The model is read from the item sources. */
+      Compile /*< The model is read from the item sources, keeping environment variables unresolved, to be written. */
+   };
+
    /*!
     * Constructs an ItemModel with the parent \a parent.
     */
@@ -65,31 +81,69 @@ public:
    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
 
    /*!
-    * Recursively applies the function \a function to each item of type \a Type.
+    * Applies the function \a function to each item of type \a Type, passing the model index
+    * and the item.
     */
-   template <typename Type> void apply(const std::function<void(const QModelIndex& index, Type* item)> function, const QModelIndex& parent = QModelIndex())
+   template <typename Type, typename Function> void apply(Function&& function)
    {
-      for (int row = 0; row < rowCount(parent); ++row)
+      GroupItem::Iterator iterator(this);
+      while (auto item = iterator.next())
       {
-         const QModelIndex& childIndex = index(row, 0, parent);
-
-         if (auto childItem = Item::cast<Type>(item(childIndex)))
+         if (auto typedItem = Item::cast<Type>(item))
          {
-            function(childIndex, childItem);
+            function(createIndex(iterator.row(), 0, item), typedItem);
          }
+      }
+   }
+
+   /*!
+    * Applies the function \a function to the item at the index \a index and each item contained
+    * in it of type \a Type, passing the model index and the item.
+    */
+   template <typename Type, typename Function> void apply(const QModelIndex& index, Function&& function)
+   {
+      auto item = this->item(index);
+      if (auto typedItem = Item::cast<Type>(item))
+      {
+         function(index, typedItem);
+      }
 
-         apply<Type>(function, childIndex);
+      GroupItem::Iterator iterator(Item::cast<GroupItem>(item));
+      while (auto item = iterator.next())
+      {
+         if (auto typedItem = Item::cast<Type>(item))
+         {
+            function(createIndex(iterator.row(), 0, item), typedItem);
+         }
       }
    }
 
    /*!
-    * Asynchronosly reads the model data from the file with the name \a fileName.
+    * Asynchronosly reads the model data from the file with the name \a fileName. If \a readMode
+    * is ReadMode::PreferSnapshot and a valid catalog snapshot exists the model is synchronously
+    * read from the snapshot, and the item sources are revalidated in the background.
     */
-   void read(const QString& file);
+   void read(const QString& file, ReadMode readMode = ReadMode::PreferSnapshot);
    /*!
-    * Synchronously writes the model data to the file with the name \a fileName.
+    * Synchronously writes the model data as compiled catalog (see CatalogItemSource) to the file
+    * with the name \a fileName and returns \a true if the catalog could be written; \a false
+    * otherwise. The model should have been read using ReadMode::Compile.
     */
-   void write(const QString& fileName);
+   bool write(const QString& fileName);
+
+   /*!
+    * Replaces the items of each searchable item source by the items matching the search
+    * expression \a searchExpression.
+    */
+   void search(const SearchExpression& searchExpression);
+   /*!
+    * Returns \a true if the items of any searchable item source have been limited by the last
+    * search(), so there may be further items matching the search expression; \a false otherwise.
+    */
+   bool isSearchTruncated() const
+   {
+      return searchTruncated_;
+   }
 
    /*!
     * Returns a pointer to the item at the index \a index or \a nullptr if there is no such item.
@@ -108,6 +162,12 @@ public:
       return itemSourceFile_;
    }
 
+   /*!
+    * Returns the estimated memory and size statistics of each item source currently loaded.
+    * Item sources still being read are not included.
+    */
+   QVector<ItemSourceStatistics> itemSourceStatistics() const;
+
 signals:
    /*!
     * Is emitted when a source has been loaded.
@@ -117,22 +177,77 @@ signals:
     * Is emitted when a source failed to load.
     */
    void sourceFailedToLoad(const QString& source, const QString& errorString = QString(), const QPoint& errorPosition = QPoint());
+   /*!
+    * Is emitted when there are no more item sources being read.
+    */
+   void sourcesLoaded();
+   /*!
+    * Is emitted when the items of the searchable item sources have been replaced by search().
+    */
+   void searched();
 
 private:
    /*!
     * The file the model was originally populated from.
     */
    QString itemSourceFile_;
+   /*!
+    * The way the model data has been read.
+    */
+   ReadMode readMode_ = ReadMode::PreferSnapshot;
+
+   /*!
+    * Is \a true if the items of any searchable item source have been limited by the last search.
+    */
+   bool searchTruncated_ = false;
 
    /*!
     * The file system watcher checking for changes in any item source files.
     */
    QFileSystemWatcher itemSourceWatcher_;
+   /*!
+    * The timers debouncing change notifications, one for each file changed.
+    */
+   QHash<QString, QTimer*> itemSourceChangeTimers_;
 
+   /*!
+    * The thread pool the item source readers are run in. A dedicated pool is used, as reading
+    * is mostly bound by I/O, and should neither be limited by nor compete with other users of
+    * the global thread pool.
+    */
+   QThreadPool itemSourceReaderPool_;
+   /*!
+    * The files of the current epoch which are being read or have already been read, identified
+    * by their canonical path (or the absolute path if the file does not exist).
+    */
+   QSet<QString> itemSourceReaderFiles_;
+
+   /*!
+    * \brief An item source reader which failed and is retried.
+    */
+   struct ItemSourceReaderRetry_
+   {
+      /*!
+       * The item source reader to be retried.
+       */
+      ImportItemReader* reader = nullptr;
+      /*!
+       * The point in time the item source reader is due to be retried.
+       */
+      std::chrono::steady_clock::time_point due;
+      /*!
+       * The number of times the item source reader has been retried.
+       */
+      int retryCount = 0;
+      /*!
+       * Is \a true if the item source reader is currently running.
+       */
+      bool running = false;
+   };
    /*!
     * The list of import items to be reloaded asynchronously.
     */
-   QVector<QPair<ImportItemReader*, std::chrono::steady_clock::time_point>> itemSourceReaderQueue_;
+   QVector<ItemSourceReaderRetry_> itemSourceReaderQueue_;
    /*!
     *
     * The opaque identifier of the model. This identifier is unique and is regenerated each time
@@ -142,15 +257,81 @@ private:
     */
    QUuid itemSourceReaderQueueIdentifier_;
    /*!
-    * The timer triggering the processing of the item source reader queue.
+    * The timer triggering the processing of the item source reader queue. The timer is armed for
+    * the next reader due only, and is not running if there is no reader to be retried.
     */
    QTimer itemSourceReaderQueueTimer_;
+   /*!
+    * The number of item source readers of the current epoch currently running.
+    */
+   int itemSourceReaderCount_ = 0;
+
+   /*!
+    * The files the item sources have been read from, which are the dependencies of the catalog
+    * snapshot.
+    */
+   QHash<const ItemSource*, CatalogSnapshot::Dependency> itemSourceDependencies_;
+
+   /*!
+    * The item sources which have been added to the model while still being read. These are
+    * owned by their item source reader until they have been read completely.
+    */
+   QSet<ItemSource*> itemSourcesPublished_;
+
+   /*!
+    * The snapshot writer currently writing the model data or \a nullptr if there is none.
+    */
+   CatalogSnapshotWriter* snapshotWriter_ = nullptr;
 
    /*!
     * Asynchronously reads the import item \a item and returns \a true if the item read process
     * could be started; \a false otherwise.
     */
    bool readItemSource_(const ImportItem& item);
+   /*!
+    * Adds the items published by the item source \a itemSource, which is still being read, to
+    * the model, adding the item source to the model along with the first items.
+    */
+   void publishItems_(ItemSource* itemSource);
+   /*!
+    * Removes the item source \a itemSource from the model if it has been added while still being
+    * read, without destroying it.
+    */
+   void unpublishItemSource_(ItemSource* itemSource);
+   /*!
+    * Is called when an item source reader of the current epoch has finished.
+    */
+   void itemSourceReaderFinished_();
+
+   /*!
+    * Is called when the item source file \a file has changed and no further change has been
+    * notified for the quiet period.
+    */
+   void itemSourceChanged_(const QString& file);
+
+   /*!
+    * Retries any item source reader in the item source reader queue which is due.
+    */
+   void processItemSourceReaderQueue_();
+   /*!
+    * Arms the item source reader queue timer for the next item source reader which is due.
+    */
+   void scheduleItemSourceReaderQueue_();
+
+   /*!
+    * Reads the model data from the catalog snapshot and returns \a true if the snapshot could be
+    * read; \a false otherwise.
+    */
+   bool readSnapshot_();
+   /*!
+    * Writes the model data to the catalog snapshot in the background.
+    */
+   void writeSnapshot_();
+   /*!
+    * Cancels the snapshot writer, if any, waiting for it to finish if it is currently running,
+    * so the items may be modified.
+    */
+   void cancelSnapshotWriter_();
 };
 
 #endif // ITEMMODEL_H
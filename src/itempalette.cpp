@@ -0,0 +1,181 @@
+/*!
+ * \file itempalette.cpp
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#include <limits>
+
+#include <QColor>
+#include <QDebug>
+#include <QHash>
+#include <QReadLocker>
+#include <QReadWriteLock>
+#include <QVector>
+#include <QWriteLocker>
+
+#include "itempalette.h"
+
+namespace {
+
+/*!
+ * The lock guarding the palette.
+ */
+QReadWriteLock paletteLock_;
+/*!
+ * The brushes in the palette, with the empty brush at index 0.
+ */
+QVector<QBrush> paletteBrushes_ = { QBrush() };
+/*!
+ * The mapping from color names to brush indices.
+ */
+QHash<QString, ItemPalette::Index> paletteColorNames_;
+
+/*!
+ * Returns the index of the brush \a brush or NoBrushIndex if it is not in the palette. The
+ * palette lock must be held.
+ */
+ItemPalette::Index findBrush(const QBrush& brush)
+{
+   ItemPalette::Index index = ItemPalette::NoBrushIndex;
+
+   for (int brushIndex = 1; brushIndex < paletteBrushes_.size(); ++brushIndex)
+   {
+      if (paletteBrushes_[brushIndex] == brush)
+      {
+         index = static_cast<ItemPalette::Index>(brushIndex);
+
+         break;
+      }
+   }
+
+   return index;
+}
+
+/*!
+ * Adds the brush \a brush to the palette and returns its index or NoBrushIndex if the palette
+ * is full. The palette lock must be held for writing.
+ */
+ItemPalette::Index addBrush(const QBrush& brush)
+{
+   ItemPalette::Index index = ItemPalette::NoBrushIndex;
+
+   if (paletteBrushes_.size() <= std::numeric_limits<ItemPalette::Index>::max())
+   {
+      index = static_cast<ItemPalette::Index>(paletteBrushes_.size());
+
+      paletteBrushes_.append(brush);
+   }
+   else
+   {
+      qWarning() << "item palette full, brush discarded" << brush;
+   }
+
+   return index;
+}
+
+} // namespace
+
+ItemPalette::Index ItemPalette::index(const QString& colorName)
+{
+   if (colorName.isEmpty())
+   {
+      return NoBrushIndex;
+   }
+
+   {
+      QReadLocker paletteLocker(&paletteLock_);
+
+      auto paletteColorName = paletteColorNames_.constFind(colorName);
+      if (paletteColorName != paletteColorNames_.constEnd())
+      {
+         return paletteColorName.value();
+      }
+   }
+
+   //
+   // The color name has not been seen yet, so parse it and add the brush for the color (if it
+   // is not yet present because it has been added using a different name).
+   //
+
+   QColor color(colorName);
+
+   QWriteLocker paletteLocker(&paletteLock_);
+
+   Index index = NoBrushIndex;
+   if (color.isValid())
+   {
+      QBrush brush(color);
+
+      index = findBrush(brush);
+      if (index == NoBrushIndex)
+      {
+         index = addBrush(brush);
+      }
+   }
+
+   paletteColorNames_.insert(colorName, index);
+
+   return index;
+}
+
+ItemPalette::Index ItemPalette::index(const QBrush& brush)
+{
+   if (brush.style() == Qt::NoBrush)
+   {
+      return NoBrushIndex;
+   }
+
+   {
+      QReadLocker paletteLocker(&paletteLock_);
+
+      auto index = findBrush(brush);
+      if (index != NoBrushIndex)
+      {
+         return index;
+      }
+   }
+
+   QWriteLocker paletteLocker(&paletteLock_);
+
+   auto index = findBrush(brush);
+   if (index == NoBrushIndex)
+   {
+      index = addBrush(brush);
+   }
+
+   return index;
+}
+
+QBrush ItemPalette::brush(Index index)
+{
+   QReadLocker paletteLocker(&paletteLock_);
+
+   return paletteBrushes_.value(index);
+}
+
+int ItemPalette::count()
+{
+   QReadLocker paletteLocker(&paletteLock_);
+
+   return paletteBrushes_.size();
+}
+
+std::size_t ItemPalette::size()
+{
+   QReadLocker paletteLocker(&paletteLock_);
+
+   std::size_t size = ((static_cast<std::size_t>(paletteBrushes_.capacity()) * sizeof(QBrush)) +
+                       (static_cast<std::size_t>(paletteColorNames_.capacity()) * sizeof(void*)) +
+                       (static_cast<std::size_t>(paletteColorNames_.size()) * sizeof(QHashNode<QString, ItemPalette::Index>)));
+
+   for (auto paletteColorName = paletteColorNames_.constBegin(); paletteColorName != paletteColorNames_.constEnd(); ++paletteColorName)
+   {
+      size += (sizeof(QArrayData) + ((static_cast<std::size_t>(paletteColorName.key().capacity()) + 1) * sizeof(QChar)));
+   }
+
+   return size;
+}
@@ -0,0 +1,65 @@
+/*!
+ * \file itempalette.h
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#ifndef ITEMPALETTE_H
+#define ITEMPALETTE_H
+
+#include <cstddef>
+
+#include <QBrush>
+#include <QString>
+
+/*!
+ * \brief The palette of brushes used by items.
+ *
+ * Each distinct brush is stored once and referenced by an index, so items do not have to store
+ * a brush of their own. The index 0 always refers to an empty brush (Qt::NoBrush). The palette
+ * is shared by all items and can be safely used from multiple threads.
+ */
+class ItemPalette
+{
+public:
+   /*!
+    * The type of an index into the palette.
+    */
+   typedef quint16 Index;
+
+   /*!
+    * The index of the empty brush.
+    */
+   static const Index NoBrushIndex = 0;
+
+   /*!
+    * Returns the index of the brush of the color with the name \a colorName, adding it to the
+    * palette if not yet present. The color name is parsed just once for any distinct name. If
+    * the name does not represent a valid color NoBrushIndex is returned.
+    */
+   static Index index(const QString& colorName);
+   /*!
+    * Returns the index of the brush \a brush, adding it to the palette if not yet present.
+    */
+   static Index index(const QBrush& brush);
+
+   /*!
+    * Returns the brush with the index \a index or an empty brush if there is no such brush.
+    */
+   static QBrush brush(Index index);
+
+   /*!
+    * Returns the number of brushes in the palette.
+    */
+   static int count();
+   /*!
+    * Returns the estimated number of bytes allocated for the palette, that is for the brushes
+    * and the table of color names.
+    */
+   static std::size_t size();
+};
+
+#endif // ITEMPALETTE_H
@@ -10,13 +10,22 @@
 #ifndef ITEMSOURCE_H
 #define ITEMSOURCE_H
 
+#include <functional>
+#include <limits>
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QPoint>
 #include <QString>
 #include <QVector>
 
 #include "groupitem.h"
+#include "itemarena.h"
+#include "linkitem.h"
 
-class QIODevice;
+class SearchExpression;
 
 /*!
  * \brief An abstract item source.
@@ -25,10 +34,11 @@ class ItemSource : public GroupItem
 {
 public:
    /*!
-    * Destructs the item source.
+    * Destructs the item source, destroying all items allocated from it.
     */
    virtual ~ItemSource()
    {
+      ItemSource::reset();
    }
 
    /*!
@@ -36,7 +46,123 @@ public:
     */
    virtual void reset()
    {
+      {
+         QMutexLocker publishedItemsLocker(&publishedItemsMutex_);
+
+         publishedItems_.clear();
+         publishedItemCount_ = 0;
+      }
+
       GroupItem::removeItems();
+
+      linkTemplates_.clear();
+      arena_.clear();
+   }
+
+   /*!
+    * Creates an item of the type \a ItemType, constructed with the arguments \a arguments, and
+    * returns a pointer to it. The item is owned by the item source and is destroyed along with
+    * all other items of the item source when the item source is reset or destroyed.
+    */
+   template <typename ItemType, typename... ArgumentTypes> ItemType* createItem(ArgumentTypes&&... arguments)
+   {
+      return arena_.create<ItemType>(std::forward<ArgumentTypes>(arguments)...);
+   }
+
+   /*!
+    * Appends the item \a item to the group item \a parent, which is either the item source itself
+    * or a group item of it. If publishing is enabled items appended to the item source itself
+    * are not inserted, but published instead.
+    */
+   void appendItem(GroupItem* parent, Item* item)
+   {
+      if ((parent == this) && (publishBatchSize_ > 0))
+      {
+         bool itemsPublished = false;
+
+         {
+            QMutexLocker publishedItemsLocker(&publishedItemsMutex_);
+
+            publishedItems_.append(item);
+
+            itemsPublished = ((publishedItemCount_++ % publishBatchSize_) == 0);
+         }
+
+         if (itemsPublished)
+         {
+            itemsPublished_();
+         }
+      }
+      else
+      {
+         parent->insertItem(item, parent->itemCount());
+      }
+   }
+
+   /*!
+    * Moves the items of the item source \a itemSource, along with the arena they have been
+    * allocated from, to this item source, appending them as if they had been appended using
+    * appendItem(). The item source \a itemSource is left empty. This allows for parts of an item
+    * source to be read concurrently into separate item sources.
+    */
+   void adopt(ItemSource* itemSource)
+   {
+      Q_ASSERT(itemSource != nullptr);
+
+      auto items = itemSource->items();
+
+      itemSource->GroupItem::removeItems();
+
+      arena_.splice(itemSource->arena_);
+
+      for (auto item : items)
+      {
+         appendItem(this, item);
+      }
+   }
+
+   /*!
+    * Enables publishing items while the item source is being read if \a batchSize is greater
+    * than 0, and disables it otherwise. Items appended to the item source itself are then
+    * collected instead of being inserted, and \a itemsPublished is called (by the thread reading
+    * the item source) for the first item and for every \a batchSize items collected thereafter.
+    * The items appended to group items are inserted immediately, so an item is published only
+    * once it is complete. Item sources which modify items after having appended them to the
+    * item source itself must not use appendItem().
+    */
+   void setPublishing(int batchSize, const std::function<void()>& itemsPublished)
+   {
+      publishBatchSize_ = batchSize;
+      itemsPublished_ = itemsPublished;
+   }
+   /*!
+    * Takes the items published since the last call. The items are no longer collected and are
+    * to be inserted into the item source by the caller, in the order returned. Can be safely
+    * called while the item source is being read by another thread.
+    */
+   QVector<Item*> takePublishedItems()
+   {
+      QMutexLocker publishedItemsLocker(&publishedItemsMutex_);
+
+      QVector<Item*> publishedItems;
+      publishedItems.swap(publishedItems_);
+
+      return publishedItems;
+   }
+
+   /*!
+    * Returns the arena the items of the item source are allocated from.
+    */
+   const ItemArena& arena() const
+   {
+      return arena_;
+   }
+   /*!
+    * Returns the parsed links of the link items of the item source.
+    */
+   LinkItem::LinkTemplates& linkTemplates() const
+   {
+      return linkTemplates_;
    }
 
    /*!
@@ -45,12 +171,71 @@ public:
     * item group is not reset before reading, use \a reset().
     */
    virtual bool read(QIODevice *device, const QString& identifier) = 0;
+   /*!
+    * Reads the item source from the contiguous buffer \a data of the size \a size and returns
+    * \a true if the source could be successfully read; \a false otherwise. The buffer must
+    * remain valid while being read, but not afterwards. The default implementation reads the
+    * buffer in place through a device; item sources able to parse the buffer directly should
+    * reimplement it.
+    */
+   virtual bool read(const char* data, qint64 size, const QString& identifier)
+   {
+      if (size > std::numeric_limits<int>::max())
+      {
+         return false;
+      }
+
+      auto content = QByteArray::fromRawData(data, static_cast<int>(size));
+
+      QBuffer contentBuffer(&content);
+      contentBuffer.open(QIODevice::ReadOnly);
+
+      return read(&contentBuffer, identifier);
+   }
    /*!
     * Writes the item source to the device \a device and returns \a true if the source could be
     * successfully written; \a false otherwise. The device must be already opened for writing.
     */
    virtual bool write(QIODevice *device) const = 0;
 
+   /*!
+    * Returns the number of bytes at the start of the file the item source is read from which
+    * are passed to read(), or a negative value if the whole file is passed (the default). Item
+    * sources accessing the file themselves (such as searchable item sources) need just its
+    * header.
+    */
+   virtual qint64 readSize() const
+   {
+      return -1;
+   }
+
+   /*!
+    * Returns \a true if the items of the item source are not read as a whole, but are created on
+    * demand for each search expression using search(); \a false otherwise (the default).
+    */
+   virtual bool isSearchable() const
+   {
+      return false;
+   }
+   /*!
+    * Creates the items of a searchable item source matching the search expression
+    * \a searchExpression and returns them. The items are allocated from the item source, but
+    * are not yet inserted; the item source is expected to be reset before. The default
+    * implementation returns no items.
+    */
+   virtual QVector<Item*> search(const SearchExpression& /* searchExpression */)
+   {
+      return {};
+   }
+   /*!
+    * Returns \a true if the items created by the last search() have been limited, so there may
+    * be further items matching the search expression; \a false otherwise (the default).
+    */
+   virtual bool isSearchTruncated() const
+   {
+      return false;
+   }
+
    /*!
     * Returns the string representation of the last error that occurred. The behaviour is undefined
     * if no error has occurred yet.
@@ -109,6 +294,41 @@ private:
     * The identifier of the item source.
     */
    QString identifier_;
+
+   /*!
+    * The arena the items of the item source are allocated from.
+    */
+   ItemArena arena_;
+   /*!
+    * The parsed links of the link items of the item source.
+    */
+   mutable LinkItem::LinkTemplates linkTemplates_;
+
+   /*!
+    * The number of items after which items are published again or 0 if publishing is disabled.
+    */
+   int publishBatchSize_ = 0;
+   /*!
+    * The function called when items have been published.
+    */
+   std::function<void()> itemsPublished_;
+   /*!
+    * The mutex guarding the published items.
+    */
+   QMutex publishedItemsMutex_;
+   /*!
+    * The items published, but not yet taken.
+    */
+   QVector<Item*> publishedItems_;
+   /*!
+    * The number of items published since the item source has been reset.
+    */
+   int publishedItemCount_ = 0;
+
+   /*!
+    * The catalog snapshot restores the identifier of item sources read from a snapshot.
+    */
+   friend class CatalogSnapshot;
 };
 
 #endif // ITEMSOURCE_H
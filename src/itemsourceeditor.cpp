@@ -7,11 +7,13 @@
  *          published by the Free Software Foundation.
  */
 
+#include <QDebug>
 #include <QDesktopWidget>
 #include <QDialogButtonBox>
 #include <QIODevice>
 #include <QFile>
 #include <QPlainTextEdit>
+#include <QSaveFile>
 #include <QVBoxLayout>
 
 #include "application.h"
@@ -38,7 +40,20 @@ ItemSourceEditor::ItemSourceEditor(QWidget* parent, Qt::WindowFlags windowFlags)
    auto buttonBox = new QDialogButtonBox(QDialogButtonBox::Save | QDialogButtonBox::Cancel, this);
    buttonBox->connect(buttonBox, &QDialogButtonBox::accepted, [this]()
    {
-      if (source_->open(QIODevice::WriteOnly | QIODevice::Truncate) == true)
+      //
+      // Files are replaced rather than truncated and rewritten, as they may be mapped into memory
+      // by an import item reader at the same time, which must keep seeing the previous content.
+      //
+
+      if (auto sourceFile = qobject_cast<QFile*>(source_))
+      {
+         QSaveFile saveFile(sourceFile->fileName());
+         if ((!saveFile.open(QIODevice::WriteOnly)) || (saveFile.write(sourceEdit_->toPlainText().toUtf8()) < 0) || (!saveFile.commit()))
+         {
+            qWarning() << "save source failed" << sourceFile->fileName() << saveFile.errorString();
+         }
+      }
+      else if (source_->open(QIODevice::WriteOnly | QIODevice::Truncate) == true)
       {
          source_->write(sourceEdit_->toPlainText().toUtf8());
          source_->close();
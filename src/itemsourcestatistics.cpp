@@ -0,0 +1,230 @@
+/*!
+ * \file itemsourcestatistics.cpp
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#include <QSet>
+#include <QStringList>
+#include <QTextStream>
+
+#include "importgroupitem.h"
+#include "importitem.h"
+#include "itempalette.h"
+#include "itemsource.h"
+#include "itemsourcestatistics.h"
+#include "linkgroupitem.h"
+#include "linkitem.h"
+#include "stringpool.h"
+
+namespace {
+
+/*!
+ * The names of the item types, in the order of Item::Type.
+ */
+const char* ITEM_TYPE_NAMES_[] = { "link", "import", "group", "link group", "import group", "source" };
+
+/*!
+ * \brief The state used when collecting the statistics of an item source.
+ */
+struct Collector
+{
+   /*!
+    * The statistics collected.
+    */
+   ItemSourceStatistics statistics;
+   /*!
+    * The data of the strings already counted.
+    */
+   QSet<const void*>* strings = nullptr;
+
+   /*!
+    * Counts the string \a string, unless it shares its data with a string already counted.
+    */
+   void collect(const QString& string)
+   {
+      //
+      // Strings without capacity do not own any allocation (they are either null or refer to
+      // static data).
+      //
+
+      if ((string.capacity() > 0) && (!strings->contains(string.constData())))
+      {
+         strings->insert(string.constData());
+
+         statistics.stringCount += 1;
+         statistics.stringSize += (sizeof(QArrayData) + ((static_cast<std::size_t>(string.capacity()) + 1) * sizeof(QChar)));
+      }
+   }
+
+   /*!
+    * Counts the tags \a tags.
+    */
+   void collect(const QStringList& tags)
+   {
+      if (!tags.isEmpty())
+      {
+         statistics.tagCount += static_cast<std::size_t>(tags.size());
+         statistics.containerSize += (sizeof(QListData::Data) + (static_cast<std::size_t>(tags.size()) * sizeof(void*)));
+
+         for (const auto& tag : tags)
+         {
+            collect(tag);
+         }
+      }
+   }
+
+   /*!
+    * Counts the item \a item and all of its children.
+    */
+   void collect(const Item* item)
+   {
+      statistics.itemCount[static_cast<std::size_t>(item->type())] += 1;
+
+      std::size_t itemSize = 0;
+
+      if (auto linkItem = Item::cast<LinkItem>(item))
+      {
+         itemSize = sizeof(LinkItem);
+
+         collect(linkItem->name());
+         collect(linkItem->link());
+         collect(linkItem->tags());
+      }
+      else if (auto importItem = Item::cast<ImportItem>(item))
+      {
+         itemSize = sizeof(ImportItem);
+
+         collect(importItem->file());
+         collect(importItem->mimeType());
+      }
+      else if (auto linkGroupItem = Item::cast<LinkGroupItem>(item))
+      {
+         itemSize = sizeof(LinkGroupItem);
+
+         collect(linkGroupItem->tags());
+      }
+      else if (Item::is<ImportGroupItem>(item))
+      {
+         itemSize = sizeof(ImportGroupItem);
+      }
+
+      if ((!item->isArenaAllocated()) && (!Item::is<ItemSource>(item)))
+      {
+         statistics.heapSize += itemSize;
+      }
+
+      if (auto groupItem = Item::cast<GroupItem>(item))
+      {
+         collect(groupItem->name());
+
+         statistics.containerSize += (static_cast<std::size_t>(groupItem->items().capacity()) * sizeof(Item*));
+
+         for (const auto& childItem : groupItem->items())
+         {
+            collect(childItem);
+         }
+      }
+   }
+};
+
+} // namespace
+
+ItemSourceStatistics ItemSourceStatistics::collect(const ItemSource* itemSource, QSet<const void*>* strings)
+{
+   Q_ASSERT(itemSource != nullptr);
+   Q_ASSERT(strings != nullptr);
+
+   Collector collector;
+   collector.strings = strings;
+   collector.statistics.identifier = itemSource->identifier();
+   collector.statistics.arenaSize = itemSource->arena().size();
+   collector.statistics.linkTemplateSize = itemSource->linkTemplates().size();
+
+   collector.collect(itemSource);
+
+   //
+   // The item source itself is not an item of its own catalog, so it is not counted.
+   //
+
+   collector.statistics.itemCount[static_cast<std::size_t>(Item::Type::Source)] = 0;
+
+   return collector.statistics;
+}
+
+QString ItemSourceStatistics::report(const QVector<ItemSourceStatistics>& statistics, std::size_t cacheSize)
+{
+   QString report;
+   QTextStream reportStream(&report);
+
+   ItemSourceStatistics totalStatistics;
+
+   reportStream << "Estimated memory usage, calculated from the size and capacity of the items," << endl
+                << "strings and containers, without the overhead of the heap allocator." << endl
+                << endl;
+
+   for (const auto& itemSourceStatistics : statistics)
+   {
+      reportStream << itemSourceStatistics.identifier << endl;
+
+      for (std::size_t type = 0; type < itemSourceStatistics.itemCount.size(); ++type)
+      {
+         if (itemSourceStatistics.itemCount[type] > 0)
+         {
+            reportStream << "   " << ITEM_TYPE_NAMES_[type] << " items: " << itemSourceStatistics.itemCount[type] << endl;
+         }
+
+         totalStatistics.itemCount[type] += itemSourceStatistics.itemCount[type];
+      }
+
+      reportStream << "   tags: " << itemSourceStatistics.tagCount << endl
+                   << "   strings: " << itemSourceStatistics.stringCount << " (" << itemSourceStatistics.stringSize << " bytes)" << endl
+                   << "   containers: " << itemSourceStatistics.containerSize << " bytes" << endl
+                   << "   link templates: " << itemSourceStatistics.linkTemplateSize << " bytes" << endl
+                   << "   arena: " << itemSourceStatistics.arenaSize << " bytes" << endl
+                   << "   heap: " << itemSourceStatistics.heapSize << " bytes" << endl
+                   << "   total: " << itemSourceStatistics.size() << " bytes" << endl;
+
+      totalStatistics.tagCount += itemSourceStatistics.tagCount;
+      totalStatistics.stringCount += itemSourceStatistics.stringCount;
+      totalStatistics.stringSize += itemSourceStatistics.stringSize;
+      totalStatistics.containerSize += itemSourceStatistics.containerSize;
+      totalStatistics.linkTemplateSize += itemSourceStatistics.linkTemplateSize;
+      totalStatistics.arenaSize += itemSourceStatistics.arenaSize;
+      totalStatistics.heapSize += itemSourceStatistics.heapSize;
+   }
+
+   //
+   // The strings of the string pool are those counted for the item sources, so just the tables
+   // of the pool add to the total.
+   //
+
+   const auto& stringPoolStatistics = StringPool::statistics();
+   const auto& itemPaletteSize = ItemPalette::size();
+
+   reportStream << "total" << endl
+                << "   sources: " << statistics.size() << endl
+                << "   link items: " << totalStatistics.itemCount[static_cast<std::size_t>(Item::Type::Link)] << endl
+                << "   tags: " << totalStatistics.tagCount << endl
+                << "   strings: " << totalStatistics.stringCount << " (" << totalStatistics.stringSize << " bytes)" << endl
+                << "   containers: " << totalStatistics.containerSize << " bytes" << endl
+                << "   link templates: " << totalStatistics.linkTemplateSize << " bytes" << endl
+                << "   arena: " << totalStatistics.arenaSize << " bytes" << endl
+                << "   heap: " << totalStatistics.heapSize << " bytes" << endl
+                << "   search cache: " << cacheSize << " bytes" << endl
+                << "   string pool tables: " << stringPoolStatistics.tableSize << " bytes" << endl
+                << "   item palette: " << itemPaletteSize << " bytes" << endl
+                << "   total: " << (totalStatistics.size() + cacheSize + stringPoolStatistics.tableSize + itemPaletteSize) << " bytes" << endl
+                << "string pool" << endl
+                << "   strings: " << stringPoolStatistics.count << " (" << stringPoolStatistics.size << " bytes)" << endl
+                << "   tables: " << stringPoolStatistics.tableSize << " bytes" << endl
+                << "   hit rate: " << stringPoolStatistics.hitRate() << endl
+                << "   saved: " << stringPoolStatistics.savedSize << " bytes" << endl
+                << "item palette" << endl
+                << "   brushes: " << ItemPalette::count() << " (" << itemPaletteSize << " bytes)" << endl;
+
+   return report;
+}
@@ -0,0 +1,98 @@
+/*!
+ * \file itemsourcestatistics.h
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#ifndef ITEMSOURCESTATISTICS_H
+#define ITEMSOURCESTATISTICS_H
+
+#include <array>
+#include <cstddef>
+
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+#include "item.h"
+
+class ItemSource;
+
+/*!
+ * \brief The memory and size statistics of an item source.
+ *
+ * The sizes are estimates, calculated from the size of the items and the capacity of their
+ * strings and containers, rather than tracked allocations. They do not include the bookkeeping
+ * overhead of the heap allocator. Strings sharing their data (for instance because they have
+ * been interned) are counted once, for the first item source they are found in.
+ */
+struct ItemSourceStatistics
+{
+   /*!
+    * The identifier of the item source.
+    */
+   QString identifier;
+
+   /*!
+    * The number of items by type.
+    */
+   std::array<std::size_t, static_cast<std::size_t>(Item::Type::Count)> itemCount = {};
+   /*!
+    * The number of tags attached to items and groups.
+    */
+   std::size_t tagCount = 0;
+
+   /*!
+    * The number of distinct strings.
+    */
+   std::size_t stringCount = 0;
+   /*!
+    * The number of bytes occupied by distinct strings.
+    */
+   std::size_t stringSize = 0;
+   /*!
+    * The number of bytes occupied by containers (the item lists of groups and the tag lists).
+    */
+   std::size_t containerSize = 0;
+   /*!
+    * The number of bytes occupied by the parsed links of the item source.
+    */
+   std::size_t linkTemplateSize = 0;
+
+   /*!
+    * The number of bytes allocated by the item arena.
+    */
+   std::size_t arenaSize = 0;
+   /*!
+    * The number of bytes of items not allocated from the item arena.
+    */
+   std::size_t heapSize = 0;
+
+   /*!
+    * Returns the total number of bytes occupied by the item source.
+    */
+   std::size_t size() const
+   {
+      return (stringSize + containerSize + linkTemplateSize + arenaSize + heapSize);
+   }
+
+   /*!
+    * Returns the statistics for the item source \a itemSource. Strings whose data is contained
+    * in \a strings are not counted, and the data of the strings counted is added to it, so
+    * strings shared across item sources are counted just once if the same set is supplied for
+    * all item sources. The item source must not be read concurrently.
+    */
+   static ItemSourceStatistics collect(const ItemSource* itemSource, QSet<const void*>* strings);
+
+   /*!
+    * Returns a human-readable report of the statistics \a statistics of all item sources, the
+    * size of the search cache \a cacheSize and the shared string pool and item palette. The
+    * report is labelled as estimate.
+    */
+   static QString report(const QVector<ItemSourceStatistics>& statistics, std::size_t cacheSize);
+};
+
+#endif // ITEMSOURCESTATISTICS_H
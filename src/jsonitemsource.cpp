@@ -0,0 +1,716 @@
+/*!
+ * \file jsonitemsource.cpp
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#include <cctype>
+#include <cstring>
+
+#include <QBuffer>
+#include <QIODevice>
+#include <QObject>
+#include <QPoint>
+#include <QStringList>
+
+#include "importgroupitem.h"
+#include "importitem.h"
+#include "itempalette.h"
+#include "jsonitemsource.h"
+#include "linkgroupitem.h"
+#include "linkitem.h"
+#include "stringpool.h"
+
+namespace {
+
+/*!
+ * \brief A streaming reader for JSON documents.
+ *
+ * The reader works in place on UTF-8 encoded data and does not build a document; values are
+ * read one at a time as requested by the caller. The reader keeps track of the line the current
+ * position is on, so errors and positions can be reported as line and column.
+ */
+class JsonReader
+{
+public:
+   /*!
+    * Constructs a reader for the data \a data of the size \a size.
+    */
+   JsonReader(const char* data, qint64 size) : position_(data), end_(data + size), lineBegin_(data)
+   {
+      if ((size >= 3) && (std::memcmp(data, "\xef\xbb\xbf", 3) == 0))
+      {
+         position_ += 3;
+      }
+   }
+
+   /*!
+    * Skips any whitespace and returns the next character or 0 if the end has been reached.
+    */
+   char peek()
+   {
+      for (; position_ < end_; ++position_)
+      {
+         if (*position_ == '\n')
+         {
+            ++lineNumber_;
+
+            lineBegin_ = (position_ + 1);
+         }
+         else if ((*position_ != ' ') && (*position_ != '\t') && (*position_ != '\r'))
+         {
+            break;
+         }
+      }
+
+      return ((position_ < end_) ? (*position_) : ('\0'));
+   }
+
+   /*!
+    * Skips any whitespace and consumes the character \a character. Returns \a true if the next
+    * character is \a character; raises an error and returns \a false otherwise.
+    */
+   bool expect(char character)
+   {
+      if (peek() != character)
+      {
+         return raiseError(QObject::tr("Expected '%1'").arg(QLatin1Char(character)));
+      }
+
+      ++position_;
+
+      return true;
+   }
+
+   /*!
+    * Reads a string into \a string (which may be \a nullptr if the string is to be skipped).
+    * Returns \a true if a string could be read; \a false otherwise.
+    */
+   bool readString(QString* string)
+   {
+      if (!expect('"'))
+      {
+         return false;
+      }
+
+      //
+      // Strings without escape sequences, which are by far the most common ones, are decoded at
+      // once. Otherwise the string is decoded chunk by chunk between escape sequences.
+      //
+
+      QString decodedString;
+
+      auto chunkBegin = position_;
+      for (; position_ < end_; ++position_)
+      {
+         if (*position_ == '"')
+         {
+            if (string != nullptr)
+            {
+               if (decodedString.isNull())
+               {
+                  *string = QString::fromUtf8(chunkBegin, static_cast<int>(position_ - chunkBegin));
+               }
+               else
+               {
+                  decodedString.append(QString::fromUtf8(chunkBegin, static_cast<int>(position_ - chunkBegin)));
+
+                  *string = decodedString;
+               }
+            }
+
+            ++position_;
+
+            return true;
+         }
+         else if (*position_ == '\\')
+         {
+            decodedString.append(QString::fromUtf8(chunkBegin, static_cast<int>(position_ - chunkBegin)));
+
+            if (!readEscapeSequence_(&decodedString))
+            {
+               return false;
+            }
+
+            chunkBegin = (position_ + 1);
+         }
+         else if (*position_ == '\n')
+         {
+            ++lineNumber_;
+
+            lineBegin_ = (position_ + 1);
+         }
+      }
+
+      return raiseError(QObject::tr("Unterminated string"));
+   }
+
+   /*!
+    * Reads a string or an array of strings and appends the strings to \a strings. Returns
+    * \a true if the strings could be read; \a false otherwise.
+    */
+   bool readStrings(QStringList* strings)
+   {
+      if (peek() != '[')
+      {
+         QString string;
+
+         bool result = readString(&string);
+         if (result)
+         {
+            strings->append(string);
+         }
+
+         return result;
+      }
+
+      return readArray([this, strings]()
+      {
+         QString string;
+
+         bool result = readString(&string);
+         if (result)
+         {
+            strings->append(string);
+         }
+
+         return result;
+      });
+   }
+
+   /*!
+    * Reads an object, calling \a member with the UTF-8 encoded key of each member, which must
+    * read the value of the member. Returns \a true if the object could be read; \a false
+    * otherwise.
+    */
+   template <typename Function> bool readObject(Function&& member)
+   {
+      if (!expect('{'))
+      {
+         return false;
+      }
+
+      if (peek() == '}')
+      {
+         ++position_;
+
+         return true;
+      }
+
+      for (;;)
+      {
+         QByteArray key;
+         if ((!readKey_(&key)) || (!expect(':')) || (!member(key)))
+         {
+            return false;
+         }
+
+         auto character = peek();
+         if (character == '}')
+         {
+            ++position_;
+
+            return true;
+         }
+         else if (character != ',')
+         {
+            return raiseError(QObject::tr("Expected ',' or '}'"));
+         }
+
+         ++position_;
+      }
+   }
+
+   /*!
+    * Reads an array, calling \a element for each element, which must read the element. Returns
+    * \a true if the array could be read; \a false otherwise.
+    */
+   template <typename Function> bool readArray(Function&& element)
+   {
+      if (!expect('['))
+      {
+         return false;
+      }
+
+      if (peek() == ']')
+      {
+         ++position_;
+
+         return true;
+      }
+
+      for (;;)
+      {
+         if (!element())
+         {
+            return false;
+         }
+
+         auto character = peek();
+         if (character == ']')
+         {
+            ++position_;
+
+            return true;
+         }
+         else if (character != ',')
+         {
+            return raiseError(QObject::tr("Expected ',' or ']'"));
+         }
+
+         ++position_;
+      }
+   }
+
+   /*!
+    * Skips the next value. Returns \a true if the value could be skipped; \a false otherwise.
+    */
+   bool skipValue()
+   {
+      switch (peek())
+      {
+      case '"':
+      {
+         return readString(nullptr);
+      }
+      case '{':
+      {
+         return readObject([this](const QByteArray& /* key */) { return skipValue(); });
+      }
+      case '[':
+      {
+         return readArray([this]() { return skipValue(); });
+      }
+      default:
+      {
+         //
+         // Numbers, true, false and null are skipped as a whole, without being validated.
+         //
+
+         auto valueBegin = position_;
+         for (; ((position_ < end_) && ((std::isalnum(static_cast<unsigned char>(*position_))) || (std::strchr("+-.", *position_) != nullptr))); ++position_)
+         {
+         }
+
+         return ((position_ != valueBegin) || (raiseError(QObject::tr("Expected value"))));
+      }
+      }
+   }
+
+   /*!
+    * Skips any whitespace and returns the line number of the current position.
+    */
+   int lineNumber()
+   {
+      peek();
+
+      return lineNumber_;
+   }
+   /*!
+    * Skips any whitespace and returns the column number of the current position, in UTF-16
+    * code units.
+    */
+   int columnNumber()
+   {
+      peek();
+
+      int columnNumber = 0;
+
+      for (auto position = lineBegin_; position < position_; ++position)
+      {
+         auto byte = static_cast<quint8>(*position);
+
+         if ((byte & 0xc0) != 0x80)
+         {
+            columnNumber += ((byte >= 0xf0) ? (2) : (1));
+         }
+      }
+
+      return columnNumber;
+   }
+
+   /*!
+    * Returns \a true if the end of the data has been reached (excluding any whitespace).
+    */
+   bool atEnd()
+   {
+      return (peek() == '\0');
+   }
+
+   /*!
+    * Records the error \a errorString at the current position and returns \a false.
+    */
+   bool raiseError(const QString& errorString)
+   {
+      if (errorString_.isNull())
+      {
+         //
+         // Determine the column first, which skips any whitespace (and possibly line breaks), so
+         // the line number refers to the same position.
+         //
+
+         auto columnNumber = this->columnNumber();
+
+         errorString_ = errorString;
+         errorPosition_ = {lineNumber_, columnNumber};
+      }
+
+      return false;
+   }
+
+   /*!
+    * Returns the error which occurred or a null string if no error has occurred.
+    */
+   QString errorString() const
+   {
+      return errorString_;
+   }
+   /*!
+    * Returns the position of the error which occurred.
+    */
+   QPoint errorPosition() const
+   {
+      return errorPosition_;
+   }
+
+private:
+   /*!
+    * The current position.
+    */
+   const char* position_;
+   /*!
+    * The end of the data.
+    */
+   const char* end_;
+   /*!
+    * The line number of the current position.
+    */
+   int lineNumber_ = 1;
+   /*!
+    * The beginning of the line of the current position.
+    */
+   const char* lineBegin_;
+   /*!
+    * The error which occurred.
+    */
+   QString errorString_;
+   /*!
+    * The position of the error which occurred.
+    */
+   QPoint errorPosition_;
+
+   /*!
+    * Reads a key into \a key. Keys without escape sequences refer to the data in place, so
+    * reading them does not allocate. Returns \a true if a key could be read; \a false otherwise.
+    */
+   bool readKey_(QByteArray* key)
+   {
+      if (peek() == '"')
+      {
+         for (auto position = (position_ + 1); position < end_; ++position)
+         {
+            if (*position == '"')
+            {
+               *key = QByteArray::fromRawData(position_ + 1, static_cast<int>(position - position_ - 1));
+
+               position_ = (position + 1);
+
+               return true;
+            }
+            else if ((*position == '\\') || (*position == '\n'))
+            {
+               break;
+            }
+         }
+      }
+
+      QString string;
+
+      bool result = readString(&string);
+      if (result)
+      {
+         *key = string.toUtf8();
+      }
+
+      return result;
+   }
+
+   /*!
+    * Reads the escape sequence at the current position and appends the character it represents
+    * to \a string, leaving the current position at the last character of the escape sequence.
+    * Returns \a true if the escape sequence is valid; \a false otherwise.
+    */
+   bool readEscapeSequence_(QString* string)
+   {
+      if ((end_ - position_) < 2)
+      {
+         return raiseError(QObject::tr("Unterminated string"));
+      }
+
+      switch (*(++position_))
+      {
+      case '"': string->append(QLatin1Char('"')); break;
+      case '\\': string->append(QLatin1Char('\\')); break;
+      case '/': string->append(QLatin1Char('/')); break;
+      case 'b': string->append(QLatin1Char('\b')); break;
+      case 'f': string->append(QLatin1Char('\f')); break;
+      case 'n': string->append(QLatin1Char('\n')); break;
+      case 'r': string->append(QLatin1Char('\r')); break;
+      case 't': string->append(QLatin1Char('\t')); break;
+      case 'u':
+      {
+         bool result = false;
+
+         if ((end_ - position_) > 4)
+         {
+            auto character = QByteArray::fromRawData(position_ + 1, 4).toUShort(&result, 16);
+            if (result)
+            {
+               string->append(QChar(character));
+
+               position_ += 4;
+            }
+         }
+
+         if (!result)
+         {
+            return raiseError(QObject::tr("Invalid unicode escape sequence"));
+         }
+
+         break;
+      }
+      default:
+      {
+         return raiseError(QObject::tr("Invalid escape sequence"));
+      }
+      }
+
+      return true;
+   }
+};
+
+/*!
+ * Reads an entry of an \a items array from the reader \a reader. Items are added to the group
+ * item \a itemParent, whereas groups are added to the group item \a groupParent (as groups do
+ * not nest) and imports to the item source \a itemSource. Returns \a true if the entry could be
+ * read; \a false otherwise.
+ */
+bool readEntry(JsonReader& reader, JsonItemSource* itemSource, GroupItem* itemParent, GroupItem* groupParent)
+{
+   QString name;
+   QString link;
+   QString color;
+   QStringList tags;
+   ItemSourcePosition linkPosition;
+
+   LinkGroupItem* group = nullptr;
+   ImportGroupItem* importGroup = nullptr;
+
+   bool result = reader.readObject([&](const QByteArray& key)
+   {
+      bool memberResult = true;
+
+      if (key == "name")
+      {
+         memberResult = reader.readString(&name);
+      }
+      else if ((key == "url") || (key == "link"))
+      {
+         linkPosition.setLineNumber(reader.lineNumber());
+         linkPosition.setColumnNumber(reader.columnNumber() + 1);
+
+         memberResult = reader.readString(&link);
+
+         linkPosition.setSize(link.size());
+      }
+      else if ((key == "tags") || (key == "tag"))
+      {
+         memberResult = reader.readStrings(&tags);
+      }
+      else if ((key == "color") || (key == "colour"))
+      {
+         memberResult = reader.readString(&color);
+      }
+      else if ((key == "items") && (group == nullptr))
+      {
+         group = itemSource->createItem<LinkGroupItem>();
+
+         memberResult = reader.readArray([&]()
+         {
+            return readEntry(reader, itemSource, group, groupParent);
+         });
+      }
+      else if ((key == "import") && (importGroup == nullptr))
+      {
+         importGroup = itemSource->createItem<ImportGroupItem>();
+
+         memberResult = reader.readArray([&]()
+         {
+            QString file;
+            QString contentType = QStringLiteral("text/xml");
+            QString contentEncoding;
+
+            bool importResult = true;
+
+            if (reader.peek() == '"')
+            {
+               importResult = reader.readString(&file);
+            }
+            else
+            {
+               importResult = reader.readObject([&](const QByteArray& importKey)
+               {
+                  if (importKey == "file")
+                  {
+                     return reader.readString(&file);
+                  }
+                  else if (importKey == "contentType")
+                  {
+                     return reader.readString(&contentType);
+                  }
+                  else if (importKey == "contentEncoding")
+                  {
+                     return reader.readString(&contentEncoding);
+                  }
+
+                  return reader.skipValue();
+               });
+            }
+
+            if (importResult)
+            {
+               auto importItem = itemSource->createItem<ImportItem>(file.trimmed(), StringPool::intern(contentType.trimmed()));
+               importItem->setContentEncoding(StringPool::intern(contentEncoding.trimmed().toLower()));
+
+               importGroup->insertItem(importItem, importGroup->itemCount());
+            }
+
+            return importResult;
+         });
+      }
+      else
+      {
+         memberResult = reader.skipValue();
+      }
+
+      return memberResult;
+   });
+
+   if (result)
+   {
+      for (auto& tag : tags)
+      {
+         tag = StringPool::intern(tag.trimmed());
+      }
+
+      if (group != nullptr)
+      {
+         group->setName(StringPool::intern(name.trimmed()));
+         group->setTags(tags);
+         group->setBrushIndex(ItemPalette::index(color.trimmed()));
+
+         itemSource->appendItem(groupParent, group);
+      }
+      else if (importGroup == nullptr)
+      {
+         auto item = itemSource->createItem<LinkItem>();
+         item->setName(StringPool::intern(name.trimmed()));
+         item->setLink(link);
+         item->setLinkPosition(linkPosition);
+         item->setTags(tags);
+         item->setBrushIndex(ItemPalette::index(color.trimmed()));
+
+         itemSource->appendItem(itemParent, item);
+      }
+
+      if (importGroup != nullptr)
+      {
+         itemSource->appendItem(itemSource, importGroup);
+      }
+   }
+
+   return result;
+}
+
+} // namespace
+
+bool JsonItemSource::read(QIODevice* device, const QString& identifier)
+{
+   bool result = false;
+
+   ItemSource::setIdentifier(identifier);
+
+   if (device != nullptr)
+   {
+      //
+      // Parse the content in place if the device is a buffer, and read it otherwise.
+      //
+
+      auto deviceBuffer = qobject_cast<QBuffer*>(device);
+
+      const QByteArray& content = ((deviceBuffer != nullptr) ? (deviceBuffer->data()) : (device->readAll()));
+
+      result = read(content.constData(), content.size(), identifier);
+   }
+
+   return result;
+}
+
+bool JsonItemSource::read(const char* data, qint64 size, const QString& identifier)
+{
+   ItemSource::setIdentifier(identifier);
+
+   JsonReader reader(data, size);
+
+   bool itemsFound = false;
+
+   bool result = reader.readObject([&](const QByteArray& key)
+   {
+      if (key == "items")
+      {
+         itemsFound = true;
+
+         return reader.readArray([&]()
+         {
+            return readEntry(reader, this, this, this);
+         });
+      }
+
+      return reader.skipValue();
+   });
+
+   if ((result) && (!itemsFound))
+   {
+      result = reader.raiseError(QObject::tr("No items found"));
+   }
+   if ((result) && (!reader.atEnd()))
+   {
+      result = reader.raiseError(QObject::tr("Unexpected content after document"));
+   }
+
+   if (!result)
+   {
+      errorString_ = reader.errorString();
+      errorPosition_ = reader.errorPosition();
+   }
+
+   return result;
+}
+
+bool JsonItemSource::write(QIODevice* /* device */) const
+{
+   return false;
+}
+
+QString JsonItemSource::errorString() const
+{
+   return errorString_;
+}
+
+QPoint JsonItemSource::errorPosition() const
+{
+   return errorPosition_;
+}
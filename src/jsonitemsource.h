@@ -0,0 +1,59 @@
+/*!
+ * \file jsonitemsource.h
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#ifndef JSONITEMSOURCE_H
+#define JSONITEMSOURCE_H
+
+#include "itemsource.h"
+
+/*!
+ * \brief An item source represented as JSON file.
+ *
+ * The document is an object with an \a items array. Each entry of the array is an object, which
+ * is a group if it has an \a items array of its own, an import if it has an \a import array and
+ * an item otherwise. The document is read by a streaming reader, so it is never held as a whole
+ * in a JSON document.
+ */
+class JsonItemSource : public ItemSource
+{
+public:
+   /*!
+    * \reimp
+    */
+   bool read(QIODevice* device, const QString& identifier) override;
+   /*!
+    * \reimp
+    */
+   bool read(const char* data, qint64 size, const QString& identifier) override;
+   /*!
+    * \reimp
+    */
+   bool write(QIODevice* device) const override;
+
+   /*!
+    * \reimp
+    */
+   QString errorString() const override;
+   /*!
+    * \reimp
+    */
+   QPoint errorPosition() const override;
+
+private:
+   /*!
+    * The JSON document error.
+    */
+   QString errorString_;
+   /*!
+    * The JSON document error position.
+    */
+   QPoint errorPosition_;
+};
+
+#endif // JSONITEMSOURCE_H
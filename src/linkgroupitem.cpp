@@ -30,12 +30,12 @@ const QStringList& LinkGroupItem::tags() const
 
 void LinkGroupItem::setBrush(const QBrush& brush)
 {
-   brush_ = brush;
+   brushIndex_ = ItemPalette::index(brush);
 }
 
-const QBrush&LinkGroupItem::brush() const
+QBrush LinkGroupItem::brush() const
 {
-   return brush_;
+   return ItemPalette::brush(brushIndex_);
 }
 
 QDebug operator<<(QDebug stream, const LinkGroupItem& itemGroup)
@@ -14,6 +14,7 @@
 #include <QString>
 
 #include "groupitem.h"
+#include "itempalette.h"
 #include "linkitem.h"
 
 /*!
@@ -47,7 +48,21 @@ public:
    /*!
     * Returns the brush for the item group.
     */
-   const QBrush& brush() const;
+   QBrush brush() const;
+   /*!
+    * Sets the brush for the item group to the brush with the palette index \a brushIndex.
+    */
+   void setBrushIndex(ItemPalette::Index brushIndex)
+   {
+      brushIndex_ = brushIndex;
+   }
+   /*!
+    * Returns the palette index of the brush for the item group.
+    */
+   ItemPalette::Index brushIndex() const
+   {
+      return brushIndex_;
+   }
 
    /*!
     * \reimp
@@ -70,15 +85,10 @@ private:
     * The list of tags common for the items in the group.
     */
    QStringList tags_;
-
-   /*!
-    * The name of the item group.
-    */
-   QString name_;
    /*!
-    * The brush used to represent items in the item group.
+    * The palette index of the brush used to represent items in the item group.
     */
-   QBrush brush_;
+   ItemPalette::Index brushIndex_ = ItemPalette::NoBrushIndex;
 
    /*!
     * Inserts the item group \a itemGroup into the stream \a stream and returns the stream.
@@ -7,8 +7,9 @@
  *          published by the Free Software Foundation.
  */
 
-#include <QRegularExpression>
+#include <limits>
 
+#include "itemsource.h"
 #include "linkitem.h"
 
 LinkItem::LinkItem() : Item(Item::Type::Link)
@@ -27,31 +28,53 @@ QString LinkItem::name() const
 
 void LinkItem::setLink(const QString& link)
 {
-   static thread_local QRegularExpression placeholderExpression(QStringLiteral("{([0-9]+|\\*)}"));
+   //
+   // Resolve the environment variables now, unless they are deferred until the link is resolved
+   // (in which case the link picks up the environment current at that time).
+   //
 
-   link_ = applyProcessEnvironment(link);
+   setResolvedLink((Item::isProcessEnvironmentDeferred()) ? (link) : (applyProcessEnvironment(link)));
+}
+
+void LinkItem::setResolvedLink(const QString& link)
+{
+   linkProcessEnvironmentDeferred_ = Item::isProcessEnvironmentDeferred();
+
+   link_ = link;
    linkParameterCount_ = 0;
    linkParameterWildcard_ = false;
 
-   auto placeholderMatches = placeholderExpression.globalMatch(link_);
-   while (placeholderMatches.hasNext())
-   {
-      const auto& placeholderString = placeholderMatches.next().captured(1);
+   //
+   // Determine the parameters of the link, which are required for matching. The segments are
+   // not kept, the link is parsed again when its parameters are first resolved.
+   //
 
-      if (placeholderString == "*")
-      {
-         linkParameterWildcard_ = true;
-      }
-      else
+   std::vector<LinkSegment_> linkSegments;
+   if (parseLink_(link_, &linkSegments))
+   {
+      for (const auto& linkSegment : linkSegments)
       {
-         int placeholderNumber = placeholderString.toInt();
-
-         if (linkParameterCount_ < (placeholderNumber + 1))
+         if (linkSegment.parameter == LinkSegment_::Wildcard)
+         {
+            linkParameterWildcard_ = true;
+         }
+         else if (linkParameterCount_ < (linkSegment.parameter + 1))
          {
-            linkParameterCount_ = (placeholderNumber + 1);
+            linkParameterCount_ = static_cast<quint16>(linkSegment.parameter + 1);
          }
       }
    }
+
+   //
+   // Discard the segments parsed for the previous link, if any.
+   //
+
+   if (auto itemSource = parent<ItemSource>())
+   {
+      QMutexLocker linkTemplatesLocker(&itemSource->linkTemplates().mutex_);
+
+      itemSource->linkTemplates().linkSegments_.remove(this);
+   }
 }
 
 QString LinkItem::link() const
@@ -59,24 +82,50 @@ QString LinkItem::link() const
    return link_;
 }
 
-QString LinkItem::link(const QStringList& parameters)
+QString LinkItem::link(const QStringList& parameters) const
 {
-   QString link = link_;
+   if (linkProcessEnvironmentDeferred_)
+   {
+      const auto& link = applyProcessEnvironment(link_);
+
+      std::vector<LinkSegment_> linkSegments;
+      return ((parseLink_(link, &linkSegments)) ? (expandLink_(link, linkSegments.data(), static_cast<int>(linkSegments.size()), parameters)) : (link));
+   }
 
-   if (linkParameterCount_ > 0)
+   if ((linkParameterCount_ == 0) && (!linkParameterWildcard_))
    {
-      for (int placeholderNumber = 0; placeholderNumber < linkParameterCount_; ++placeholderNumber)
-      {
-         link.replace((QStringLiteral("{") + QString::number(placeholderNumber) + QStringLiteral("}")), parameters.at(placeholderNumber));
-      }
+      return link_;
    }
 
-   if (linkParameterWildcard_ == true)
+   //
+   // Parse the link just once and keep the segments in the item source, so the link is resolved
+   // by just appending the segments. A link item not (yet) part of an item source is parsed
+   // every time.
+   //
+
+   auto itemSource = parent<ItemSource>();
+   if (itemSource == nullptr)
    {
-      link.replace(QStringLiteral("{*}"), parameters.join(' '));
+      std::vector<LinkSegment_> linkSegments;
+      parseLink_(link_, &linkSegments);
+
+      return expandLink_(link_, linkSegments.data(), static_cast<int>(linkSegments.size()), parameters);
    }
 
-   return link;
+   QMutexLocker linkTemplatesLocker(&itemSource->linkTemplates().mutex_);
+
+   auto& linkSegments = itemSource->linkTemplates().linkSegments_[this];
+   if (linkSegments.empty())
+   {
+      parseLink_(link_, &linkSegments);
+   }
+
+   return expandLink_(link_, linkSegments.data(), static_cast<int>(linkSegments.size()), parameters);
+}
+
+QUrl LinkItem::url(const QStringList& parameters) const
+{
+   return QUrl::fromUserInput(link(parameters));
 }
 
 LinkItem::LinkMatch LinkItem::linkMatches(const QStringList& parameters) const
@@ -95,14 +144,26 @@ LinkItem::LinkMatch LinkItem::linkMatches(const QStringList& parameters) const
    return linkMatch;
 }
 
+void LinkItem::setLinkPosition(const ItemSourcePosition& linkPosition)
+{
+   linkLineNumber_ = linkPosition.lineNumber();
+   linkColumnNumber_ = linkPosition.columnNumber();
+   linkSize_ = linkPosition.size();
+}
+
+ItemSourcePosition LinkItem::linkPosition() const
+{
+   return ItemSourcePosition(linkLineNumber_, linkColumnNumber_, linkSize_);
+}
+
 void LinkItem::setBrush(const QBrush& brush)
 {
-   brush_ = brush;
+   brushIndex_ = ItemPalette::index(brush);
 }
 
 QBrush LinkItem::brush() const
 {
-   return brush_;
+   return ItemPalette::brush(brushIndex_);
 }
 
 void LinkItem::appendTag(const QString& tag)
@@ -120,6 +181,163 @@ const QStringList& LinkItem::tags() const
    return tags_;
 }
 
+bool LinkItem::parseLink_(const QString& link, std::vector<LinkSegment_>* segments)
+{
+   Q_ASSERT(segments != nullptr);
+
+   //
+   // Scan for placeholders of the form {n}, {*}, {%n} and {%*}, everything else (including any
+   // unresolved environment variable) is literal text.
+   //
+
+   bool parameterFound = false;
+
+   const auto linkData = link.constData();
+   const auto linkSize = link.size();
+
+   int literalPosition = 0;
+
+   for (int position = link.indexOf(QLatin1Char('{')); position >= 0; position = link.indexOf(QLatin1Char('{'), position + 1))
+   {
+      int placeholderPosition = (position + 1);
+
+      bool encoded = false;
+      if ((placeholderPosition < linkSize) && (linkData[placeholderPosition] == QLatin1Char('%')))
+      {
+         encoded = true;
+
+         ++placeholderPosition;
+      }
+
+      int parameter = LinkSegment_::Literal;
+      if ((placeholderPosition < linkSize) && (linkData[placeholderPosition] == QLatin1Char('*')))
+      {
+         parameter = LinkSegment_::Wildcard;
+
+         ++placeholderPosition;
+      }
+      else
+      {
+         for (; ((placeholderPosition < linkSize) && (linkData[placeholderPosition].isDigit())); ++placeholderPosition)
+         {
+            parameter = (qMax(parameter, 0) * 10) + linkData[placeholderPosition].digitValue();
+            parameter = qMin(parameter, (std::numeric_limits<quint16>::max() - 1));
+         }
+      }
+
+      if ((parameter != LinkSegment_::Literal) && (placeholderPosition < linkSize) && (linkData[placeholderPosition] == QLatin1Char('}')))
+      {
+         if (position > literalPosition)
+         {
+            segments->push_back({literalPosition, (position - literalPosition), LinkSegment_::Literal, false});
+         }
+
+         segments->push_back({position, 0, parameter, encoded});
+
+         literalPosition = (placeholderPosition + 1);
+         position = placeholderPosition;
+
+         parameterFound = true;
+      }
+   }
+
+   if (literalPosition < linkSize)
+   {
+      segments->push_back({literalPosition, (linkSize - literalPosition), LinkSegment_::Literal, false});
+   }
+
+   return parameterFound;
+}
+
+QString LinkItem::expandLink_(const QString& link, const LinkSegment_* segments, int segmentCount, const QStringList& parameters)
+{
+   //
+   // Resolve the parameters first, so the size of the link is known and it can be assembled
+   // with a single allocation.
+   //
+
+   QString wildcardParameter;
+
+   int linkSize = 0;
+   for (int segmentIndex = 0; segmentIndex < segmentCount; ++segmentIndex)
+   {
+      const auto& segment = segments[segmentIndex];
+
+      if (segment.parameter == LinkSegment_::Literal)
+      {
+         linkSize += segment.size;
+      }
+      else if (segment.parameter == LinkSegment_::Wildcard)
+      {
+         if (wildcardParameter.isNull())
+         {
+            wildcardParameter = parameters.join(QLatin1Char(' '));
+         }
+
+         linkSize += ((segment.encoded) ? (wildcardParameter.size() * 3) : (wildcardParameter.size()));
+      }
+      else
+      {
+         linkSize += ((segment.encoded) ? (parameters.value(segment.parameter).size() * 3) : (parameters.value(segment.parameter).size()));
+      }
+   }
+
+   QString expandedLink;
+   expandedLink.reserve(linkSize);
+
+   for (int segmentIndex = 0; segmentIndex < segmentCount; ++segmentIndex)
+   {
+      const auto& segment = segments[segmentIndex];
+
+      if (segment.parameter == LinkSegment_::Literal)
+      {
+         expandedLink.append(link.constData() + segment.position, segment.size);
+      }
+      else
+      {
+         const auto& parameter = ((segment.parameter == LinkSegment_::Wildcard) ? (wildcardParameter) : (parameters.value(segment.parameter)));
+
+         if (segment.encoded)
+         {
+            expandedLink.append(QString::fromLatin1(QUrl::toPercentEncoding(parameter)));
+         }
+         else
+         {
+            expandedLink.append(parameter);
+         }
+      }
+   }
+
+   return expandedLink;
+}
+
+void LinkItem::LinkTemplates::clear()
+{
+   QMutexLocker linkTemplatesLocker(&mutex_);
+
+   linkSegments_.clear();
+}
+
+int LinkItem::LinkTemplates::count() const
+{
+   QMutexLocker linkTemplatesLocker(&mutex_);
+
+   return linkSegments_.size();
+}
+
+std::size_t LinkItem::LinkTemplates::size() const
+{
+   QMutexLocker linkTemplatesLocker(&mutex_);
+
+   std::size_t size = (static_cast<std::size_t>(linkSegments_.capacity()) * (sizeof(const LinkItem*) + sizeof(std::vector<LinkSegment_>) + sizeof(void*)));
+   for (const auto& linkSegments : linkSegments_)
+   {
+      size += (linkSegments.capacity() * sizeof(LinkSegment_));
+   }
+
+   return size;
+}
+
 QDebug operator<<(QDebug stream, const LinkItem& item)
 {
    return (stream << item.name() << item.link() << item.brush() << item.tags());
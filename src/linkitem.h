@@ -10,13 +10,18 @@
 #ifndef LINKITEM_H
 #define LINKITEM_H
 
-#include <memory>
+#include <cstddef>
+#include <vector>
 
 #include <QBrush>
 #include <QDebug>
+#include <QHash>
+#include <QMutex>
 #include <QString>
+#include <QUrl>
 
 #include "item.h"
+#include "itempalette.h"
 #include "itemsourceposition.h"
 
 class LinkGroupItem;
@@ -55,6 +60,12 @@ public:
     * Sets the link the item refers to to \a link.
     */
    void setLink(const QString& link);
+   /*!
+    * Sets the link the item refers to to \a link, which has already been resolved as by
+    * setLink(), so its environment variables are not applied again (for instance when the link
+    * is restored from a catalog snapshot).
+    */
+   void setResolvedLink(const QString& link);
    /*!
     * Returns the link the item refers to.
     */
@@ -62,7 +73,11 @@ public:
    /*!
     * Returns the link with the parameters resolved as supplied in \a parameters.
     */
-   QString link(const QStringList& parameters);
+   QString link(const QStringList& parameters) const;
+   /*!
+    * Returns the URL of the link with the parameters resolved as supplied in \a parameters.
+    */
+   QUrl url(const QStringList& parameters) const;
    /*!
     * Returns \a true if the link matches with there parameters \a parameters; \a false
     * otherwise.
@@ -72,17 +87,11 @@ public:
    /*!
     * Sets the item source position of the link to \a position.
     */
-   void setLinkPosition(const ItemSourcePosition& linkPosition)
-   {
-      linkPosition_ = linkPosition;
-   }
+   void setLinkPosition(const ItemSourcePosition& linkPosition);
    /*!
     * Returns the item source position of the link.
     */
-   ItemSourcePosition linkPosition() const
-   {
-      return linkPosition_;
-   }
+   ItemSourcePosition linkPosition() const;
 
    /*!
     * Sets the brush of the item to \a brush.
@@ -92,6 +101,20 @@ public:
     * Returns the bursh of the item or an Qt::NoBrush if no brush is set.
     */
    QBrush brush() const;
+   /*!
+    * Sets the brush of the item to the brush with the palette index \a brushIndex.
+    */
+   void setBrushIndex(ItemPalette::Index brushIndex)
+   {
+      brushIndex_ = brushIndex;
+   }
+   /*!
+    * Returns the palette index of the brush of the item.
+    */
+   ItemPalette::Index brushIndex() const
+   {
+      return brushIndex_;
+   }
 
    /*!
     * Appends the tag \a tag to the list of tags for the item.
@@ -115,6 +138,93 @@ public:
    }
 
 private:
+   /*!
+    * \brief A segment of a link, which is either literal text or a parameter placeholder.
+    */
+   struct LinkSegment_
+   {
+      /*!
+       * The position of the segment within the link.
+       */
+      int position;
+      /*!
+       * The size of the literal text.
+       */
+      int size;
+      /*!
+       * The number of the parameter, LinkSegment_::Literal for literal text or
+       * LinkSegment_::Wildcard for the parameter wildcard.
+       */
+      int parameter;
+      /*!
+       * Is \a true if the parameter is percent-encoded.
+       */
+      bool encoded;
+
+      /*!
+       * The parameter number of literal text.
+       */
+      static const int Literal = -1;
+      /*!
+       * The parameter number of the parameter wildcard.
+       */
+      static const int Wildcard = -2;
+   };
+
+public:
+   /*!
+    * \brief The parsed links of the link items of an item source.
+    *
+    * A link with parameter placeholders is parsed into segments when its parameters are first
+    * resolved, and the segments are kept in the table of the item source owning the link item,
+    * so link items without parameter placeholders (which are the vast majority) do not carry
+    * any segments at all. The table is thread-safe.
+    */
+   class LinkTemplates
+   {
+   public:
+      /*!
+       * Removes all parsed links, for instance when the link items are destroyed.
+       */
+      void clear();
+
+      /*!
+       * Returns the number of parsed links.
+       */
+      int count() const;
+      /*!
+       * Returns the number of bytes allocated for the parsed links.
+       */
+      std::size_t size() const;
+
+   private:
+      /*!
+       * The mutex guarding the parsed links.
+       */
+      mutable QMutex mutex_;
+      /*!
+       * The segments of each link item parsed so far.
+       */
+      QHash<const LinkItem*, std::vector<LinkSegment_>> linkSegments_;
+
+      /*!
+       * The link item parses and resolves the links.
+       */
+      friend class LinkItem;
+   };
+
+private:
+   /*!
+    * Parses the link \a link into the segments \a segments and returns \a true if the link
+    * contains any parameter placeholder; \a false otherwise.
+    */
+   static bool parseLink_(const QString& link, std::vector<LinkSegment_>* segments);
+   /*!
+    * Returns the link \a link, parsed into the segments \a segments, with the parameters
+    * resolved as supplied in \a parameters.
+    */
+   static QString expandLink_(const QString& link, const LinkSegment_* segments, int segmentCount, const QStringList& parameters);
+
    /*!
     * The name of the item.
     */
@@ -125,27 +235,40 @@ private:
     */
    QString link_;
    /*!
-    * The item source position of the link.
+    * The tags attached to the item.
     */
-   ItemSourcePosition linkPosition_;
+   QStringList tags_;
+
    /*!
-    * The parameter count for the link. If 0, the link has no parameter (expect wildcard).
+    * The line number of the item source position of the link.
     */
-   int linkParameterCount_ = 0;
+   qint32 linkLineNumber_ = 0;
    /*!
-    * The parameter wildcard is present.
+    * The column number of the item source position of the link, which is not limited, as single
+    * line sources (such as JSON or CSV files) easily exceed any narrower column range.
     */
-   bool linkParameterWildcard_ = false;
-
+   qint32 linkColumnNumber_ = 0;
    /*!
-    * The brush that shall be used to represent the item.
+    * The size of the item source position of the link.
     */
-   QBrush brush_;
+   qint32 linkSize_ = 0;
 
    /*!
-    * The tags attached to the item.
+    * The palette index of the brush that shall be used to represent the item.
     */
-   QStringList tags_;
+   ItemPalette::Index brushIndex_ = ItemPalette::NoBrushIndex;
+   /*!
+    * The parameter count for the link. If 0, the link has no parameter (expect wildcard).
+    */
+   quint16 linkParameterCount_ = 0;
+   /*!
+    * The parameter wildcard is present.
+    */
+   bool linkParameterWildcard_ = false;
+   /*!
+    * Is \a true if the environment variables in the link are resolved when the link is resolved.
+    */
+   bool linkProcessEnvironmentDeferred_ = false;
 
    /*!
     * Inserts the item \a item into the stream \a stream and returns the stream.
@@ -153,5 +276,12 @@ private:
    friend QDebug operator<<(QDebug stream, const LinkItem& item);
 };
 
+//
+// A link item consists of the item base, the pointer-sized members (the name, the link and the
+// tags) and a tail of at most 24 bytes holding the position, the palette index, the parameter
+// count and the flags.
+//
+
+static_assert(sizeof(LinkItem) <= (sizeof(Item) + (3 * sizeof(void*)) + 24), "LinkItem exceeds its size budget");
 
 #endif // LINKITEM_H
@@ -18,6 +18,7 @@
 
 #include "application.h"
 #include "systemlock.h"
+#include "searchitemproxymodel.h"
 #include "searchwindow.h"
 
 #include "itemmodel.h"
@@ -73,6 +74,14 @@ int main(int argc, char *argv[])
    sourceCommandLineOption.setDefaultValue(QStringLiteral("launcher.xml"));
    commandLineParser.addOption(sourceCommandLineOption);
 
+   QCommandLineOption statisticsCommandLineOption(QStringLiteral("stats"));
+   statisticsCommandLineOption.setDescription(QObject::tr("Prints the memory and size statistics of the items and exits"));
+   commandLineParser.addOption(statisticsCommandLineOption);
+
+   QCommandLineOption compileCatalogCommandLineOption(QStringLiteral("compile-catalog"));
+   compileCatalogCommandLineOption.setDescription(QObject::tr("Compiles the catalog read from <file> into the compiled catalog <out> and exits"));
+   compileCatalogCommandLineOption.setValueName(QObject::tr("file"));
+   commandLineParser.addOption(compileCatalogCommandLineOption);
 
    if (commandLineParser.parse(application.arguments()))
    {
@@ -84,6 +93,63 @@ int main(int argc, char *argv[])
       {
          QMessageBox::information(nullptr, "Version", application.applicationVersion());
       }
+      else if (commandLineParser.isSet(statisticsCommandLineOption))
+      {
+         //
+         // Read the items (along with the search proxy model, so the cache is populated as well)
+         // and print the statistics as soon as all item sources have been read. The connection is
+         // queued, as the sources may be loaded before the event loop has been entered.
+         //
+
+         ItemModel itemModel;
+
+         SearchItemProxyModel searchItemProxyModel;
+         searchItemProxyModel.setSourceModel(&itemModel);
+
+         itemModel.connect(&itemModel, &ItemModel::sourcesLoaded, &application, [&itemModel, &searchItemProxyModel]()
+         {
+            QTextStream(stdout) << ItemSourceStatistics::report(itemModel.itemSourceStatistics(), searchItemProxyModel.cacheSize());
+
+            Application::quit();
+         }, Qt::QueuedConnection);
+
+         itemModel.read(commandLineParser.value(sourceCommandLineOption));
+
+         result = application.exec();
+      }
+      else if (commandLineParser.isSet(compileCatalogCommandLineOption))
+      {
+         //
+         // Read the whole catalog, including all imports, and write it as compiled catalog as
+         // soon as all item sources have been read, but only if every item source could be read.
+         //
+
+         if (commandLineParser.positionalArguments().size() == 1)
+         {
+            ItemModel itemModel;
+
+            bool itemSourcesFailed = false;
+
+            itemModel.connect(&itemModel, &ItemModel::sourceFailedToLoad, &application, [&itemSourcesFailed](const QString& source, const QString& errorString)
+            {
+               QTextStream(stderr) << source << ": " << errorString << endl;
+
+               itemSourcesFailed = true;
+            });
+            itemModel.connect(&itemModel, &ItemModel::sourcesLoaded, &application, [&itemModel, &itemSourcesFailed, &commandLineParser]()
+            {
+               Application::exit(((!itemSourcesFailed) && (itemModel.write(commandLineParser.positionalArguments().first()))) ? (EXIT_SUCCESS) : (EXIT_FAILURE));
+            }, Qt::QueuedConnection);
+
+            itemModel.read(commandLineParser.value(compileCatalogCommandLineOption), ItemModel::ReadMode::Compile);
+
+            result = application.exec();
+         }
+         else
+         {
+            QTextStream(stderr) << QObject::tr("No compiled catalog file specified") << endl;
+         }
+      }
       else
       {
          //
@@ -10,6 +10,7 @@
 #include <QDebug>
 #include <QIcon>
 #include <QKeyEvent>
+#include <QPainter>
 
 #include "searchbarwidget.h"
 
@@ -78,6 +79,17 @@ void SearchBarWidget::removeIndications()
    updateIndicationsAction_();
 }
 
+void SearchBarWidget::setMatchCount(int matchCount, bool matchCountTruncated)
+{
+   if ((matchCount_ != matchCount) || (matchCountTruncated_ != matchCountTruncated))
+   {
+      matchCount_ = matchCount;
+      matchCountTruncated_ = matchCountTruncated;
+
+      update();
+   }
+}
+
 void SearchBarWidget::updateIndicationsAction_()
 {
    if (indications_.isEmpty())
@@ -135,3 +147,32 @@ bool SearchBarWidget::event(QEvent* event)
 
    return QLineEdit::event(event);
 }
+
+void SearchBarWidget::paintEvent(QPaintEvent* event)
+{
+   QLineEdit::paintEvent(event);
+
+   //
+   // Paint the match count right-aligned in front of the indications (if any), unless it would
+   // overlap the search expression.
+   //
+
+   if ((matchCount_ >= 0) && (!text().isEmpty()))
+   {
+      auto matchCountRectangle = contentsRect().marginsRemoved(textMargins());
+      if (indicationsAction_->isVisible())
+      {
+         matchCountRectangle.setRight(matchCountRectangle.right() - matchCountRectangle.height());
+      }
+
+      const auto& matchCountText = ((matchCountTruncated_) ? (QString::number(matchCount_).append(QLatin1Char('+'))) : (QString::number(matchCount_)));
+      const auto& fontMetrics = this->fontMetrics();
+
+      if ((fontMetrics.width(text()) + fontMetrics.width(matchCountText) + fontMetrics.averageCharWidth() * 2) < matchCountRectangle.width())
+      {
+         QPainter painter(this);
+         painter.setPen(palette().color(QPalette::Disabled, QPalette::Text));
+         painter.drawText(matchCountRectangle, Qt::AlignRight | Qt::AlignVCenter, matchCountText);
+      }
+   }
+}
@@ -47,6 +47,13 @@ public slots:
     */
    void removeIndications();
 
+   /*!
+    * Sets the number of items matching the search expression to \a matchCount, which is shown
+    * at the end of the search bar unless it is negative. If \a matchCountTruncated is \a true
+    * further items may match, and the number is shown as lower bound ("N+").
+    */
+   void setMatchCount(int matchCount, bool matchCountTruncated = false);
+
 signals:
    /*!
     * Is emitted when the up-key is pressed.
@@ -79,6 +86,15 @@ private:
     */
    QAction* indicationsAction_ = nullptr;
 
+   /*!
+    * The number of items matching the search expression or -1 if not shown.
+    */
+   int matchCount_ = -1;
+   /*!
+    * Is \a true if further items than the number of items shown may match.
+    */
+   bool matchCountTruncated_ = false;
+
    /*!
     * Updates the indications action.
     */
@@ -88,6 +104,10 @@ private:
     * \reimp
     */
    bool event(QEvent* event);
+   /*!
+    * \reimp
+    */
+   void paintEvent(QPaintEvent* event) override;
 };
 
 #endif // SEARCHBARWIDGET_H
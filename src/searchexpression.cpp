@@ -11,6 +11,102 @@
 
 #include "searchexpression.h"
 
+namespace {
+
+/*!
+ * The minimum length of a literal usable in a full-text query (a single trigram).
+ */
+static const int FULL_TEXT_LITERAL_SIZE_ = 3;
+
+/*!
+ * Returns the longest literal part of the regular expression pattern \a pattern, which any
+ * string matched by the pattern contains, or an empty string if there is no such part or the
+ * pattern is too complex to be analyzed.
+ */
+QString longestLiteral(const QString& pattern)
+{
+   //
+   // Alternations, groups, character classes, repetitions and escapes are not analyzed.
+   //
+
+   static const QString unsupportedCharacters = QStringLiteral("\\|()[]{}");
+
+   for (const auto& character : pattern)
+   {
+      if (unsupportedCharacters.contains(character))
+      {
+         return QString();
+      }
+   }
+
+   QString literal;
+   QString longestLiteral;
+
+   auto completeLiteral = [&literal, &longestLiteral]()
+   {
+      if (literal.size() > longestLiteral.size())
+      {
+         longestLiteral = literal;
+      }
+
+      literal.clear();
+   };
+
+   for (const auto& character : pattern)
+   {
+      if ((character == QLatin1Char('*')) || (character == QLatin1Char('?')))
+      {
+         //
+         // The character preceding the quantifier is optional.
+         //
+
+         literal.chop(1);
+
+         completeLiteral();
+      }
+      else if (character == QLatin1Char('+'))
+      {
+         completeLiteral();
+      }
+      else if ((character == QLatin1Char('.')) || (character == QLatin1Char('^')) || (character == QLatin1Char('$')))
+      {
+         completeLiteral();
+      }
+      else
+      {
+         literal.append(character);
+      }
+   }
+
+   completeLiteral();
+
+   return longestLiteral;
+}
+
+/*!
+ * Returns \a true if the literal \a literal is not empty and consists of printable ASCII
+ * characters only; \a false otherwise.
+ */
+bool isAsciiLiteral(const QString& literal)
+{
+   if (literal.isEmpty())
+   {
+      return false;
+   }
+
+   for (const auto& character : literal)
+   {
+      if ((character.unicode() < 0x20) || (character.unicode() > 0x7e))
+      {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+} // namespace
+
 SearchExpression::SearchExpression()
 {
    tokenizeExpression_.setPattern("[^\\s\"']+|\"([^\"]*)\"|'([^']*)'");
@@ -32,6 +128,117 @@ bool SearchExpression::matches(const QString& name, const QStringList& tags) con
    return (terms_.isEmpty() || matches_(name, tags));
 }
 
+QString SearchExpression::fullTextQuery(const QString& nameColumn, const QString& tagsColumn) const
+{
+   return query_([&nameColumn, &tagsColumn](const Term_& term)
+   {
+      QString termQuery;
+
+      const auto& literal = longestLiteral(term.expression.pattern());
+      if ((term.negation == Term_::Negation::NotNegated) && (literal.size() >= FULL_TEXT_LITERAL_SIZE_))
+      {
+         QString columns;
+
+         switch (term.type)
+         {
+         case Term_::Type::Name: columns = nameColumn; break;
+         case Term_::Type::Tag: columns = tagsColumn; break;
+         case Term_::Type::Both: columns = QStringLiteral("{%1 %2}").arg(nameColumn, tagsColumn); break;
+         }
+
+         termQuery = QStringLiteral("%1 : \"%2\"").arg(columns, QString(literal).replace(QLatin1Char('"'), QStringLiteral("\"\"")));
+      }
+
+      return termQuery;
+   });
+}
+
+QString SearchExpression::scanCondition(const QString& nameColumn, const QString& tagsColumn) const
+{
+   return query_([&nameColumn, &tagsColumn](const Term_& term)
+   {
+      QString termCondition;
+
+      const auto& literal = longestLiteral(term.expression.pattern());
+      if ((term.negation == Term_::Negation::NotNegated) && (isAsciiLiteral(literal)))
+      {
+         const auto& quotedLiteral = QStringLiteral("'%1'").arg(literal.toLower().replace(QLatin1Char('\''), QStringLiteral("''")));
+
+         switch (term.type)
+         {
+         case Term_::Type::Name:
+            termCondition = QStringLiteral("(instr(lower(%1), %2) > 0)").arg(nameColumn, quotedLiteral);
+            break;
+         case Term_::Type::Tag:
+            termCondition = QStringLiteral("(instr(lower(%1), %2) > 0)").arg(tagsColumn, quotedLiteral);
+            break;
+         case Term_::Type::Both:
+            termCondition = QStringLiteral("(instr(lower(%1), %3) > 0 OR instr(lower(%2), %3) > 0)").arg(nameColumn, tagsColumn, quotedLiteral);
+            break;
+         }
+      }
+
+      return termCondition;
+   });
+}
+
+QString SearchExpression::query_(const std::function<QString(const Term_& term)>& termQuery) const
+{
+   //
+   // An expression matches if all conjunct terms match or any disjunct term matches, so a term
+   // which cannot be expressed leaves its conjunction unrestricted, and renders the disjunction
+   // unrestricted.
+   //
+
+   QStringList conjunctQueries;
+   QStringList disjunctQueries;
+
+   bool hasConjunctTerms = false;
+   bool hasDisjunctTerms = false;
+
+   bool isDisjunctRestricted = true;
+
+   for (const auto& term : terms_)
+   {
+      const auto& query = termQuery(term);
+
+      if (term.operation == Term_::Operation::Conjunct)
+      {
+         hasConjunctTerms = true;
+
+         if (!query.isEmpty())
+         {
+            conjunctQueries.append(query);
+         }
+      }
+      else if (term.operation == Term_::Operation::Disjunct)
+      {
+         hasDisjunctTerms = true;
+
+         if (!query.isEmpty())
+         {
+            disjunctQueries.append(query);
+         }
+         else
+         {
+            isDisjunctRestricted = false;
+         }
+      }
+   }
+
+   if ((hasConjunctTerms && conjunctQueries.isEmpty()) || (hasDisjunctTerms && !isDisjunctRestricted))
+   {
+      return QString();
+   }
+
+   if (!conjunctQueries.isEmpty())
+   {
+      disjunctQueries.prepend(QStringLiteral("(%1)").arg(conjunctQueries.join(QStringLiteral(" AND "))));
+   }
+
+   return disjunctQueries.join(QStringLiteral(" OR "));
+}
+
 void SearchExpression::compile_(const QString& expression, ImplicitMatch implicitMatch)
 {
    //
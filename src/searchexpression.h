@@ -10,6 +10,8 @@
 #ifndef SEARCHEXPRESSION_H
 #define SEARCHEXPRESSION_H
 
+#include <functional>
+
 #include <QRegularExpression>
 #include <QString>
 #include <QVector>
@@ -74,6 +76,26 @@ public:
     */
    bool matches(const QString& name, const QStringList& tags) const;
 
+   /*!
+    * Returns a full-text query (in the syntax of the SQLite FTS5 extension, using the trigram
+    * tokenizer) for the columns \a nameColumn and \a tagsColumn, which matches at least every
+    * row the search expression matches. The query is built from the longest literal part of
+    * each term, and returns an empty string if no such query can be derived (for instance if a
+    * term is negated or has no literal part of at least three characters), in which case any
+    * row may match.
+    */
+   QString fullTextQuery(const QString& nameColumn, const QString& tagsColumn) const;
+   /*!
+    * Returns an SQL condition for the columns \a nameColumn and \a tagsColumn, which holds for
+    * at least every row the search expression matches, for search expressions no full-text query
+    * can be derived for. The condition is built from the longest literal part of each term, which
+    * may be as short as a single character, but must consist of ASCII characters only (as these
+    * are the only characters SQLite compares case-insensitively). Returns an empty string if no
+    * such condition can be derived (for instance if a term is negated), in which case any row
+    * may match.
+    */
+   QString scanCondition(const QString& nameColumn, const QString& tagsColumn) const;
+
    /*!
     * Returns the list of parameter provided with the search term since the
     * last call to setExpression().
@@ -131,6 +153,13 @@ private:
     */
    void compile_(const QString &expression, ImplicitMatch implicitMatch);
 
+   /*!
+    * Returns the query combining the queries returned by \a termQuery for each term, which must
+    * be an empty string for any term which cannot be expressed, using the operators AND and OR,
+    * or an empty string if the terms which cannot be expressed leave the query unrestricted.
+    */
+   QString query_(const std::function<QString(const Term_& term)>& termQuery) const;
+
    /*!
     * Returns \a true if the name \a name and the tags \a tags match any name search terms.
     */
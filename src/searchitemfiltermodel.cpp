@@ -9,18 +9,34 @@
 
 #include <QVariant>
 
+#include "application.h"
 #include "searchitemfiltermodel.h"
 #include "itemmodel.h"
 #include "searchitemproxymodel.h"
 #include "searchexpression.h"
 
+namespace {
+
+/*!
+ * The default time in milliseconds a search expression has to remain unchanged before
+ * searchable item sources are searched.
+ */
+static const int DEFAULT_SEARCH_DELAY_ = 100;
+
+} // namespace
+
 SearchItemFilterModel::SearchItemFilterModel(QObject* parent) : QSortFilterProxyModel(parent)
 {
+   searchTimer_.setSingleShot(true);
+   searchTimer_.setInterval(static_cast<Application*>(Application::instance())->setting<int>(this, QStringLiteral("searchDelay"), DEFAULT_SEARCH_DELAY_));
+   searchTimer_.connect(&searchTimer_, &QTimer::timeout, this, &SearchItemFilterModel::search_);
 }
 
 LinkItem* SearchItemFilterModel::item(const QModelIndex& proxyIndex)
 {
-   return static_cast<SearchItemProxyModel*>(sourceModel())->item(mapToSource(proxyIndex));
+   auto proxyModel = qobject_cast<SearchItemProxyModel*>(sourceModel());
+
+   return ((proxyModel != nullptr) ? (proxyModel->item(mapToSource(proxyIndex))) : (nullptr));
 }
 
 const LinkItem* SearchItemFilterModel::item(const QModelIndex& proxyIndex) const
@@ -28,20 +44,63 @@ const LinkItem* SearchItemFilterModel::item(const QModelIndex& proxyIndex) const
    return const_cast<const LinkItem*>(const_cast<SearchItemFilterModel*>(this)->item(proxyIndex));
 }
 
+bool SearchItemFilterModel::lessThan(int leftRow, int rightRow, SortAlgorithm sortAlgorithm) const
+{
+   //
+   // The sort algorithm is passed as column of the source indices, just as when sorted by column.
+   //
+
+   return lessThan(mapToSource(index(leftRow, sortAlgorithm)), mapToSource(index(rightRow, sortAlgorithm)));
+}
+
 void SearchItemFilterModel::setSearchExpression(const QString& expression, SearchExpression::ImplicitMatch implicitMatch)
 {
    searchExpression_.setExpression(expression, implicitMatch);
 
+   //
+   // Searchable item sources are searched once the search expression has not been changed for
+   // the search delay, so a query is not run for every key typed. Meanwhile the items created for
+   // the previous search expression are filtered just as any other item.
+   //
+
+   searchTimer_.start();
+
    invalidateFilter();
 }
 
+void SearchItemFilterModel::flushSearch()
+{
+   if (searchTimer_.isActive())
+   {
+      searchTimer_.stop();
+
+      search_();
+   }
+}
+
+void SearchItemFilterModel::search_()
+{
+   //
+   // Searchable item sources create the items matching the search expression on demand, which
+   // are then filtered as they are inserted.
+   //
+
+   if (auto proxyModel = qobject_cast<SearchItemProxyModel*>(sourceModel()))
+   {
+      if (auto itemModel = qobject_cast<ItemModel*>(proxyModel->sourceModel()))
+      {
+         itemModel->search(searchExpression_);
+      }
+   }
+}
+
 bool SearchItemFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const
 {
    bool matches = false;
 
    if (!searchExpression_.isEmpty() || !(filter_ & EmptySearchExpressionFilter))
    {
-      const SearchItemProxyModel* itemModel = static_cast<const SearchItemProxyModel*>(sourceModel());
+      const SearchItemProxyModel* itemModel = qobject_cast<const SearchItemProxyModel*>(sourceModel());
       if (itemModel != nullptr)
       {
          matches = searchExpression_.matches(itemModel->data(itemModel->index(sourceRow, 0, sourceParent), Qt::DisplayRole).toString(),
@@ -11,6 +11,7 @@
 #define SEARCHFILTERMODEL_H
 
 #include <QSortFilterProxyModel>
+#include <QTimer>
 
 #include "searchexpression.h"
 
@@ -19,6 +20,10 @@ class LinkItem;
 /*!
  * \brief A sort filter proxy model filtering an item based on the name and tag by a regular
  *        expression, sorted by type (tagged or not tagged) and name.
+ *
+ * The model may be sorted as a whole using sort(), but as just the first rows are usually shown,
+ * the rows are preferably left unsorted and the first rows are selected using lessThan() instead
+ * (see SearchItemPageModel).
  */
 class SearchItemFilterModel : public QSortFilterProxyModel
 {
@@ -82,11 +87,23 @@ public:
     */
    const LinkItem* item(const QModelIndex& proxyIndex) const;
 
+   /*!
+    * Returns \a true if the row \a leftRow sorts before the row \a rightRow using the sort
+    * algorithm \a sortAlgorithm; \a false otherwise.
+    */
+   bool lessThan(int leftRow, int rightRow, SortAlgorithm sortAlgorithm) const;
+
 public slots:
    /*!
-    * Sets the regular pattern filter to \a regularExpressionPattern.
+    * Sets the regular pattern filter to \a regularExpressionPattern. Searchable item sources are
+    * searched once the search expression has not been changed for the search delay.
     */
    void setSearchExpression(const QString& expression, SearchExpression::ImplicitMatch implicitMatch);
+   /*!
+    * Searches the searchable item sources right away if a search is still delayed, for instance
+    * before the items are acted upon.
+    */
+   void flushSearch();
 
 protected:
    /*!
@@ -108,6 +125,17 @@ private:
     * The filters to be applied when \a filterAcceptsRow() is called.
     */
    Filter filter_ = static_cast<Filter>(EmptySearchExpressionFilter | ParameterMismatchFilter);
+
+   /*!
+    * The timer delaying the search of searchable item sources until the search expression has
+    * not been changed for the search delay.
+    */
+   QTimer searchTimer_;
+
+   /*!
+    * Searches the searchable item sources for the current search expression.
+    */
+   void search_();
 };
 
 Q_DECLARE_METATYPE(SearchItemFilterModel::SortAlgorithm)
@@ -0,0 +1,490 @@
+/*!
+ * \file searchitempagemodel.cpp
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#include <algorithm>
+#include <numeric>
+
+#include <QHash>
+#include <QTimer>
+
+#include "application.h"
+#include "searchitemfiltermodel.h"
+#include "searchitempagemodel.h"
+
+namespace {
+
+/*!
+ * The default number of rows fetched at once, which covers the rows visible in a window filling
+ * the screen along with a margin.
+ */
+static const int DEFAULT_PAGE_SIZE_ = 64;
+
+} // namespace
+
+SearchItemPageModel::SearchItemPageModel(QObject* parent) : QAbstractProxyModel(parent)
+{
+   pageSize_ = qMax(1, static_cast<Application*>(Application::instance())->setting<int>(this, QStringLiteral("pageSize"), DEFAULT_PAGE_SIZE_));
+   fetchedRowCount_ = pageSize_;
+}
+
+int SearchItemPageModel::totalRowCount() const
+{
+   return ((sourceModel() != nullptr) ? (sourceModel()->rowCount()) : (0));
+}
+
+LinkItem* SearchItemPageModel::item(const QModelIndex& proxyIndex)
+{
+   auto filterModel = qobject_cast<SearchItemFilterModel*>(sourceModel());
+
+   return ((filterModel != nullptr) ? (filterModel->item(mapToSource(proxyIndex))) : (nullptr));
+}
+
+void SearchItemPageModel::setSourceModel(QAbstractItemModel* sourceModel)
+{
+   beginResetModel();
+
+   if (auto previousSourceModel = this->sourceModel())
+   {
+      previousSourceModel->disconnect(this);
+   }
+
+   rows_.clear();
+
+   QAbstractProxyModel::setSourceModel(sourceModel);
+
+   if (sourceModel != nullptr)
+   {
+      connect(sourceModel, &QAbstractItemModel::rowsInserted, this, &SearchItemPageModel::sourceRowsInserted_);
+      connect(sourceModel, &QAbstractItemModel::rowsRemoved, this, &SearchItemPageModel::sourceRowsRemoved_);
+      connect(sourceModel, &QAbstractItemModel::rowsMoved, this, &SearchItemPageModel::sourceStructureChanged_);
+      connect(sourceModel, &QAbstractItemModel::columnsInserted, this, &SearchItemPageModel::sourceStructureChanged_);
+      connect(sourceModel, &QAbstractItemModel::columnsRemoved, this, &SearchItemPageModel::sourceStructureChanged_);
+      connect(sourceModel, &QAbstractItemModel::columnsMoved, this, &SearchItemPageModel::sourceStructureChanged_);
+      connect(sourceModel, &QAbstractItemModel::dataChanged, this, &SearchItemPageModel::sourceDataChanged_);
+      connect(sourceModel, &QAbstractItemModel::layoutChanged, this, &SearchItemPageModel::sourceLayoutChanged_);
+      connect(sourceModel, &QAbstractItemModel::modelAboutToBeReset, this, &SearchItemPageModel::sourceModelAboutToBeReset_);
+      connect(sourceModel, &QAbstractItemModel::modelReset, this, &SearchItemPageModel::sourceModelReset_);
+   }
+
+   fetchedRowCount_ = pageSize_;
+   updatePending_ = false;
+
+   for (auto row : selectRows_(true))
+   {
+      rows_.append(QPersistentModelIndex(sourceModel->index(row, 0)));
+   }
+
+   endResetModel();
+}
+
+QModelIndex SearchItemPageModel::mapToSource(const QModelIndex& proxyIndex) const
+{
+   QModelIndex sourceIndex;
+
+   if ((proxyIndex.isValid()) && (proxyIndex.row() < rows_.size()) && (rows_[proxyIndex.row()].isValid()) && (sourceModel() != nullptr))
+   {
+      sourceIndex = sourceModel()->index(rows_[proxyIndex.row()].row(), proxyIndex.column());
+   }
+
+   return sourceIndex;
+}
+
+QModelIndex SearchItemPageModel::mapFromSource(const QModelIndex& sourceIndex) const
+{
+   QModelIndex proxyIndex;
+
+   if (sourceIndex.isValid())
+   {
+      for (int row = 0; row < rows_.size(); ++row)
+      {
+         if ((rows_[row].isValid()) && (rows_[row].row() == sourceIndex.row()))
+         {
+            proxyIndex = createIndex(row, sourceIndex.column());
+
+            break;
+         }
+      }
+   }
+
+   return proxyIndex;
+}
+
+QModelIndex SearchItemPageModel::index(int row, int column, const QModelIndex& parent) const
+{
+   QModelIndex index;
+
+   if ((!parent.isValid()) && (row >= 0) && (row < rows_.size()) && (column >= 0) && (column < columnCount()))
+   {
+      index = createIndex(row, column);
+   }
+
+   return index;
+}
+
+QModelIndex SearchItemPageModel::parent(const QModelIndex& /* index */) const
+{
+   return QModelIndex();
+}
+
+int SearchItemPageModel::rowCount(const QModelIndex& parent) const
+{
+   return ((!parent.isValid()) ? (rows_.size()) : (0));
+}
+
+int SearchItemPageModel::columnCount(const QModelIndex& parent) const
+{
+   return (((!parent.isValid()) && (sourceModel() != nullptr)) ? (sourceModel()->columnCount()) : (0));
+}
+
+bool SearchItemPageModel::canFetchMore(const QModelIndex& parent) const
+{
+   return ((!parent.isValid()) && (rows_.size() < totalRowCount()));
+}
+
+void SearchItemPageModel::fetchMore(const QModelIndex& parent)
+{
+   if (canFetchMore(parent))
+   {
+      //
+      // The rows of the next page follow the rows exposed in sorted order, so they have to be
+      // selected from all rows.
+      //
+
+      fetchedRowCount_ = rows_.size() + pageSize_;
+      selectAllRows_ = true;
+
+      updateRows_();
+   }
+}
+
+void SearchItemPageModel::sort(int column, Qt::SortOrder /* order */)
+{
+   sortColumn_ = column;
+
+   if (sourceModel() != nullptr)
+   {
+      selectAllRows_ = true;
+
+      updateRows_();
+   }
+}
+
+void SearchItemPageModel::resetPages()
+{
+   fetchedRowCount_ = pageSize_;
+
+   //
+   // The rows of the first page are the first rows exposed, so the rows of any further page are
+   // just removed.
+   //
+
+   if (rows_.size() > fetchedRowCount_)
+   {
+      beginRemoveRows(QModelIndex(), fetchedRowCount_, rows_.size() - 1);
+      rows_.resize(fetchedRowCount_);
+      endRemoveRows();
+   }
+}
+
+QVector<int> SearchItemPageModel::selectRows_(bool selectAllRows) const
+{
+   QVector<int> rows;
+
+   if (sourceModel() == nullptr)
+   {
+      return rows;
+   }
+
+   //
+   // The rows exposed are the first rows in sorted order, so the first rows after rows have been
+   // inserted are among the rows exposed and the rows inserted. Otherwise (for instance if rows
+   // exposed have been removed) all rows have to be considered.
+   //
+
+   for (const auto& row : rows_)
+   {
+      selectAllRows |= (!row.isValid());
+   }
+
+   if (selectAllRows)
+   {
+      rows.resize(totalRowCount());
+
+      std::iota(rows.begin(), rows.end(), 0);
+   }
+   else
+   {
+      rows.reserve(rows_.size() + ((insertedFirstRow_ >= 0) ? (insertedLastRow_ - insertedFirstRow_ + 1) : (0)));
+
+      for (const auto& row : rows_)
+      {
+         rows.append(row.row());
+      }
+
+      for (int row = insertedFirstRow_; ((row >= 0) && (row <= insertedLastRow_)); ++row)
+      {
+         rows.append(row);
+      }
+   }
+
+   //
+   // Select the first rows by a partial sort, which just keeps the rows selected so far sorted,
+   // so the effort grows linearly with the number of rows, rather than with n log n. Rows of
+   // equal order are kept in the order of the source model.
+   //
+
+   auto filterModel = qobject_cast<const SearchItemFilterModel*>(sourceModel());
+   auto sortAlgorithm = static_cast<SearchItemFilterModel::SortAlgorithm>(sortColumn_);
+   auto sorted = ((filterModel != nullptr) && (sortColumn_ >= 0));
+
+   auto selectedRowCount = qMin(fetchedRowCount_, rows.size());
+
+   std::partial_sort(rows.begin(), rows.begin() + selectedRowCount, rows.end(), [filterModel, sortAlgorithm, sorted](int leftRow, int rightRow)
+   {
+      if (sorted)
+      {
+         if (filterModel->lessThan(leftRow, rightRow, sortAlgorithm))
+         {
+            return true;
+         }
+         if (filterModel->lessThan(rightRow, leftRow, sortAlgorithm))
+         {
+            return false;
+         }
+      }
+
+      return (leftRow < rightRow);
+   });
+
+   rows.resize(selectedRowCount);
+
+   return rows;
+}
+
+void SearchItemPageModel::updateRows_()
+{
+   auto selectedRows = selectRows_(selectAllRows_);
+
+   updatePending_ = false;
+   selectAllRows_ = false;
+   insertedFirstRow_ = -1;
+   insertedLastRow_ = -1;
+
+   //
+   // Rearrange the rows exposed (moving the persistent indices along with them) unless they are
+   // already in place, then remove or expose the rows the number of rows exposed has changed by.
+   //
+
+   const int rowCount = rows_.size();
+   const int selectedRowCount = selectedRows.size();
+
+   bool rowsChanged = false;
+   for (int row = 0; ((!rowsChanged) && (row < qMin(rowCount, selectedRowCount))); ++row)
+   {
+      rowsChanged = ((!rows_[row].isValid()) || (rows_[row].row() != selectedRows[row]));
+   }
+   for (int row = selectedRowCount; ((!rowsChanged) && (row < rowCount)); ++row)
+   {
+      rowsChanged = (!rows_[row].isValid());
+   }
+
+   if (rowsChanged)
+   {
+      emit layoutAboutToBeChanged();
+
+      QHash<int, int> selectedRowPositions;
+      selectedRowPositions.reserve(selectedRowCount);
+
+      for (int row = 0; row < selectedRowCount; ++row)
+      {
+         selectedRowPositions.insert(selectedRows[row], row);
+      }
+
+      const auto& layoutChangeIndices = persistentIndexList();
+
+      QModelIndexList layoutChangedIndices;
+      layoutChangedIndices.reserve(layoutChangeIndices.size());
+
+      for (const auto& layoutChangeIndex : layoutChangeIndices)
+      {
+         QModelIndex layoutChangedIndex;
+
+         const auto& row = rows_.value(layoutChangeIndex.row());
+         if (row.isValid())
+         {
+            auto selectedRowPosition = selectedRowPositions.value(row.row(), -1);
+            if ((selectedRowPosition >= 0) && (selectedRowPosition < rowCount))
+            {
+               layoutChangedIndex = createIndex(selectedRowPosition, layoutChangeIndex.column());
+            }
+         }
+
+         layoutChangedIndices.append(layoutChangedIndex);
+      }
+
+      for (int row = 0; row < rowCount; ++row)
+      {
+         rows_[row] = ((row < selectedRowCount) ? (QPersistentModelIndex(sourceModel()->index(selectedRows[row], 0))) : (QPersistentModelIndex()));
+      }
+
+      changePersistentIndexList(layoutChangeIndices, layoutChangedIndices);
+
+      emit layoutChanged();
+   }
+
+   if (selectedRowCount < rowCount)
+   {
+      beginRemoveRows(QModelIndex(), selectedRowCount, rowCount - 1);
+      rows_.resize(selectedRowCount);
+      endRemoveRows();
+   }
+   else if (selectedRowCount > rowCount)
+   {
+      beginInsertRows(QModelIndex(), rowCount, selectedRowCount - 1);
+      for (int row = rowCount; row < selectedRowCount; ++row)
+      {
+         rows_.append(QPersistentModelIndex(sourceModel()->index(selectedRows[row], 0)));
+      }
+      endInsertRows();
+   }
+}
+
+void SearchItemPageModel::scheduleUpdateRows_(bool selectAllRows)
+{
+   selectAllRows_ |= selectAllRows;
+
+   //
+   // Changes to the source model usually come in bursts (for instance when filtering, which
+   // removes and inserts many ranges of rows), so the rows exposed are updated once for all.
+   //
+
+   if (!updatePending_)
+   {
+      updatePending_ = true;
+
+      QTimer::singleShot(0, this, [this]()
+      {
+         if (updatePending_)
+         {
+            updateRows_();
+         }
+      });
+   }
+}
+
+void SearchItemPageModel::sourceRowsInserted_(const QModelIndex& sourceParent, int first, int last)
+{
+   if (sourceParent.isValid())
+   {
+      return;
+   }
+
+   //
+   // Keep track of the rows inserted, as long as they are contiguous; otherwise the rows exposed
+   // are selected from all rows.
+   //
+
+   if (insertedFirstRow_ < 0)
+   {
+      insertedFirstRow_ = first;
+      insertedLastRow_ = last;
+   }
+   else if ((first >= insertedFirstRow_) && (first <= (insertedLastRow_ + 1)))
+   {
+      insertedLastRow_ += (last - first + 1);
+   }
+   else
+   {
+      selectAllRows_ = true;
+   }
+
+   scheduleUpdateRows_(false);
+}
+
+void SearchItemPageModel::sourceRowsRemoved_(const QModelIndex& sourceParent, int /* first */, int /* last */)
+{
+   //
+   // Rows removed which are not exposed do not change the rows exposed, whereas a removed row
+   // exposed is invalidated, which is detected by the update. Rows inserted before are no longer
+   // tracked, as their rows may have changed.
+   //
+
+   if (!sourceParent.isValid())
+   {
+      scheduleUpdateRows_(insertedFirstRow_ >= 0);
+   }
+}
+
+void SearchItemPageModel::sourceStructureChanged_()
+{
+   beginResetModel();
+
+   rows_.clear();
+
+   updatePending_ = false;
+   selectAllRows_ = false;
+   insertedFirstRow_ = -1;
+   insertedLastRow_ = -1;
+
+   for (auto row : selectRows_(true))
+   {
+      rows_.append(QPersistentModelIndex(sourceModel()->index(row, 0)));
+   }
+
+   endResetModel();
+}
+
+void SearchItemPageModel::sourceDataChanged_(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles)
+{
+   if (topLeft.parent().isValid())
+   {
+      return;
+   }
+
+   for (int row = 0; row < rows_.size(); ++row)
+   {
+      if ((rows_[row].isValid()) && (rows_[row].row() >= topLeft.row()) && (rows_[row].row() <= bottomRight.row()))
+      {
+         emit dataChanged(index(row, topLeft.column()), index(row, bottomRight.column()), roles);
+      }
+   }
+}
+
+void SearchItemPageModel::sourceLayoutChanged_()
+{
+   //
+   // The persistent indices of the rows exposed have been updated by the source model, but the
+   // rows may have been filtered and the rows inserted are no longer known.
+   //
+
+   scheduleUpdateRows_(true);
+}
+
+void SearchItemPageModel::sourceModelAboutToBeReset_()
+{
+   beginResetModel();
+}
+
+void SearchItemPageModel::sourceModelReset_()
+{
+   rows_.clear();
+
+   fetchedRowCount_ = pageSize_;
+   updatePending_ = false;
+   selectAllRows_ = false;
+   insertedFirstRow_ = -1;
+   insertedLastRow_ = -1;
+
+   for (auto row : selectRows_(true))
+   {
+      rows_.append(QPersistentModelIndex(sourceModel()->index(row, 0)));
+   }
+
+   endResetModel();
+}
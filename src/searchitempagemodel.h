@@ -0,0 +1,206 @@
+/*!
+ * \file searchitempagemodel.h
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#ifndef SEARCHITEMPAGEMODEL_H
+#define SEARCHITEMPAGEMODEL_H
+
+#include <QAbstractProxyModel>
+#include <QPersistentModelIndex>
+#include <QVector>
+
+class LinkItem;
+
+/*!
+ * \brief A proxy model exposing the first rows of a flat source model page by page, in sorted
+ *        order.
+ *
+ * Initially just the first page of rows is exposed, further pages are exposed using fetchMore(),
+ * which is called by the view as soon as the last row becomes visible. The rows exposed are
+ * reset to the first page using resetPages(), for instance before a new search. This way the
+ * view lays out just the rows which are visible, along with a margin, no matter how many rows
+ * the source model provides.
+ *
+ * The source model itself is left unsorted. Instead, the rows exposed are selected from the
+ * source model using a partial sort (see sort()), so the rows not exposed are never sorted. Rows
+ * inserted into the source model are merged with the rows exposed, and changes to the source
+ * model are collected and applied at once when control returns to the event loop.
+ */
+class SearchItemPageModel : public QAbstractProxyModel
+{
+   Q_OBJECT
+
+public:
+   /*!
+    * Constructs a SearchItemPageModel with the parent \a parent.
+    */
+   SearchItemPageModel(QObject* parent = nullptr);
+
+   /*!
+    * Returns the number of rows fetched at once.
+    */
+   int pageSize() const
+   {
+      return pageSize_;
+   }
+
+   /*!
+    * Returns the number of rows provided by the source model, that is the number of rows which
+    * are exposed once all pages have been fetched.
+    */
+   int totalRowCount() const;
+
+   /*!
+    * Returns a pointer to the item at the index \a proxyIndex or \a nullptr if there is no such item.
+    */
+   LinkItem* item(const QModelIndex& proxyIndex);
+
+   /*!
+    * \reimp
+    */
+   void setSourceModel(QAbstractItemModel* sourceModel) override;
+
+   /*!
+    * \reimp
+    */
+   QModelIndex mapToSource(const QModelIndex& proxyIndex) const override;
+   /*!
+    * \reimp
+    */
+   QModelIndex mapFromSource(const QModelIndex& sourceIndex) const override;
+
+   /*!
+    * \reimp
+    */
+   QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+   /*!
+    * \reimp
+    */
+   QModelIndex parent(const QModelIndex& index) const override;
+   /*!
+    * \reimp
+    */
+   int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+   /*!
+    * \reimp
+    */
+   int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+
+   /*!
+    * \reimp
+    */
+   bool canFetchMore(const QModelIndex& parent) const override;
+   /*!
+    * \reimp
+    */
+   void fetchMore(const QModelIndex& parent) override;
+
+   /*!
+    * Sorts the rows using the sort algorithm \a column (see SearchItemFilterModel::SortAlgorithm)
+    * if the source model is a SearchItemFilterModel, or exposes the rows in the order of the
+    * source model if \a column is negative. The order \a order is ignored.
+    */
+   void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+public slots:
+   /*!
+    * Resets the rows exposed to the first page.
+    */
+   void resetPages();
+
+private:
+   /*!
+    * The number of rows fetched at once.
+    */
+   int pageSize_ = 0;
+   /*!
+    * The number of rows fetched, which may exceed the number of rows of the source model.
+    */
+   int fetchedRowCount_ = 0;
+
+   /*!
+    * The sort algorithm or a negative value if the rows are exposed in the order of the source
+    * model.
+    */
+   int sortColumn_ = -1;
+
+   /*!
+    * The rows of the source model exposed, in the order exposed, which are the first rows of
+    * the source model in sorted order (unless an update is pending). The indices are persistent,
+    * so they are kept up to date by the source model, and become invalid if the row is removed.
+    */
+   QVector<QPersistentModelIndex> rows_;
+
+   /*!
+    * Is \a true if an update of the rows exposed is pending.
+    */
+   bool updatePending_ = false;
+   /*!
+    * Is \a true if the rows exposed have to be selected from all rows of the source model by the
+    * pending update, rather than just from the rows exposed and the rows inserted.
+    */
+   bool selectAllRows_ = false;
+   /*!
+    * The first row of the source model inserted since the last update or -1 if none.
+    */
+   int insertedFirstRow_ = -1;
+   /*!
+    * The last row of the source model inserted since the last update or -1 if none.
+    */
+   int insertedLastRow_ = -1;
+
+   /*!
+    * Returns the first rows of the source model in sorted order, up to the number of rows
+    * fetched. If \a selectAllRows is \a false the rows are selected from the rows exposed and
+    * the rows inserted since the last update only, as long as none of the rows exposed has been
+    * removed.
+    */
+   QVector<int> selectRows_(bool selectAllRows) const;
+
+   /*!
+    * Updates the rows exposed, selecting the first rows of the source model in sorted order.
+    */
+   void updateRows_();
+   /*!
+    * Schedules an update of the rows exposed when control returns to the event loop. If
+    * \a selectAllRows is \a true, the rows exposed are selected from all rows of the source model.
+    */
+   void scheduleUpdateRows_(bool selectAllRows);
+
+   /*!
+    * Is called when the rows \a first to \a last have been inserted into the source model.
+    */
+   void sourceRowsInserted_(const QModelIndex& sourceParent, int first, int last);
+   /*!
+    * Is called when the rows \a first to \a last have been removed from the source model.
+    */
+   void sourceRowsRemoved_(const QModelIndex& sourceParent, int first, int last);
+   /*!
+    * Is called when rows or columns have been moved within, or columns have been inserted into
+    * or removed from the source model, which is rare and handled as reset.
+    */
+   void sourceStructureChanged_();
+   /*!
+    * Is called when the data of the source model from \a topLeft to \a bottomRight has changed.
+    */
+   void sourceDataChanged_(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles);
+   /*!
+    * Is called when the layout of the source model has been changed.
+    */
+   void sourceLayoutChanged_();
+   /*!
+    * Is called when the source model is about to be reset.
+    */
+   void sourceModelAboutToBeReset_();
+   /*!
+    * Is called when the source model has been reset.
+    */
+   void sourceModelReset_();
+};
+
+#endif // SEARCHITEMPAGEMODEL_H
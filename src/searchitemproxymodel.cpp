@@ -8,8 +8,12 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <iterator>
 
+#include <QDebug>
+#include <QSet>
+
 #include "groupitem.h"
 #include "itemmodel.h"
 #include "linkgroupitem.h"
@@ -28,8 +32,9 @@ void SearchItemProxyModel::setSourceModel(QAbstractItemModel* sourceModel)
       // If an item model was set previously disconnect from the reset signal, so the cache is
       // no longer rebuilt when this model changes.
       //
-      disconnect(this->sourceModel(), &QAbstractItemModel::rowsInserted, this, &SearchItemProxyModel::reset_);
-      disconnect(this->sourceModel(), &QAbstractItemModel::rowsRemoved, this, &SearchItemProxyModel::reset_);
+      disconnect(this->sourceModel(), &QAbstractItemModel::rowsInserted, this, &SearchItemProxyModel::insert_);
+      disconnect(this->sourceModel(), &QAbstractItemModel::rowsAboutToBeRemoved, this, &SearchItemProxyModel::remove_);
+      disconnect(this->sourceModel(), &QAbstractItemModel::rowsRemoved, this, &SearchItemProxyModel::removed_);
       disconnect(this->sourceModel(), &QAbstractItemModel::modelReset, this, &SearchItemProxyModel::reset_);
    }
 
@@ -44,8 +49,9 @@ void SearchItemProxyModel::setSourceModel(QAbstractItemModel* sourceModel)
       // If a valid item model has been set connect to the reset signal, so the cache is rebuilt
       // when this model changes.
       //
-      connect(this->sourceModel(), &QAbstractItemModel::rowsInserted, this, &SearchItemProxyModel::reset_);
-      connect(this->sourceModel(), &QAbstractItemModel::rowsRemoved, this, &SearchItemProxyModel::reset_);
+      connect(this->sourceModel(), &QAbstractItemModel::rowsInserted, this, &SearchItemProxyModel::insert_);
+      connect(this->sourceModel(), &QAbstractItemModel::rowsAboutToBeRemoved, this, &SearchItemProxyModel::remove_);
+      connect(this->sourceModel(), &QAbstractItemModel::rowsRemoved, this, &SearchItemProxyModel::removed_);
       connect(this->sourceModel(), &QAbstractItemModel::modelReset, this, &SearchItemProxyModel::reset_);
 
       //
@@ -180,8 +186,34 @@ const LinkItem* SearchItemProxyModel::item(const QModelIndex& proxyIndex) const
    return const_cast<const LinkItem*>(const_cast<SearchItemProxyModel*>(this)->item(proxyIndex));
 }
 
+std::size_t SearchItemProxyModel::cacheSize() const
+{
+   //
+   // The tag string is created for the cache entry, whereas the tag string list is the joined
+   // list of the item and group tags, which share their strings with the items.
+   //
+
+   std::size_t size = (static_cast<std::size_t>(cache_.capacity()) * sizeof(CacheEntry_));
+
+   for (const auto& cacheEntry : cache_)
+   {
+      if (cacheEntry.tagString.capacity() > 0)
+      {
+         size += (sizeof(QArrayData) + ((static_cast<std::size_t>(cacheEntry.tagString.capacity()) + 1) * sizeof(QChar)));
+      }
+      if (!cacheEntry.tagStringList.isEmpty())
+      {
+         size += (sizeof(QListData::Data) + (static_cast<std::size_t>(cacheEntry.tagStringList.size()) * sizeof(void*)));
+      }
+   }
+
+   return size;
+}
+
 void SearchItemProxyModel::reset_()
 {
+   auto resetStart = std::chrono::steady_clock::now();
+
    beginResetModel();
 
    //
@@ -196,24 +228,160 @@ void SearchItemProxyModel::reset_()
    {
       itemModel->apply<LinkItem>([this](const QModelIndex& index, LinkItem* item)
       {
-         CacheEntry_ cacheEntry{index, {}, item->tags(), item->brush()};
+         cache_.append(cacheEntry_(index, item));
+      });
+   }
 
-         for (auto parentItem = item->parent<LinkGroupItem>(); parentItem != nullptr; parentItem = parentItem->parent<LinkGroupItem>())
-         {
-            cacheEntry.tagStringList.append(parentItem->tags());
+   endResetModel();
 
-            if (cacheEntry.brush.style() == Qt::NoBrush)
-            {
-               cacheEntry.brush = parentItem->brush();
-            }
-         }
+   qDebug() << "search cache rebuilt" << cache_.size() << "items"
+            << std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - resetStart).count() << "us";
+}
 
-         cacheEntry.tagStringList.sort(Qt::CaseInsensitive);
-         cacheEntry.tagString = cacheEntry.tagStringList.join(QStringLiteral(", "));
+void SearchItemProxyModel::insert_(const QModelIndex& parent, int first, int last)
+{
+   //
+   // Items are inserted into the source model whenever an item source has been read, or while
+   // it is being read, so just the inserted items are added to the cache (at its end, as the
+   // order of the items is determined by the filter model sorting them).
+   //
 
-         cache_.append(cacheEntry);
+   auto itemModel = qobject_cast<ItemModel*>(sourceModel());
+   if (itemModel == nullptr)
+   {
+      return;
+   }
+
+   auto insertStart = std::chrono::steady_clock::now();
+
+   QVector<CacheEntry_> cacheEntries;
+
+   for (int row = first; row <= last; ++row)
+   {
+      itemModel->apply<LinkItem>(itemModel->index(row, 0, parent), [&cacheEntries](const QModelIndex& index, LinkItem* item)
+      {
+         cacheEntries.append(cacheEntry_(index, item));
       });
    }
 
-   endResetModel();
+   if (!cacheEntries.isEmpty())
+   {
+      beginInsertRows(QModelIndex(), cache_.size(), cache_.size() + cacheEntries.size() - 1);
+      cache_.append(cacheEntries);
+      endInsertRows();
+   }
+
+   qDebug() << "search cache extended" << cacheEntries.size() << "items"
+            << std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - insertStart).count() << "us";
+}
+
+void SearchItemProxyModel::remove_(const QModelIndex& parent, int first, int last)
+{
+   //
+   // Items are removed from the source model whenever an item source is removed, or the items
+   // of a searchable item source are replaced, so just the cache entries of the removed items
+   // (and the items contained in them) are removed. The items are still valid at this point.
+   //
+
+   auto itemModel = qobject_cast<ItemModel*>(sourceModel());
+   if ((itemModel == nullptr) || (cacheInvalid_))
+   {
+      return;
+   }
+
+   auto removeStart = std::chrono::steady_clock::now();
+
+   const Item* parentItem = ((parent.isValid()) ? (itemModel->item(parent)) : (static_cast<const Item*>(itemModel)));
+
+   QSet<const Item*> removedItems;
+   for (int row = first; row <= last; ++row)
+   {
+      removedItems.insert(itemModel->item(itemModel->index(row, 0, parent)));
+   }
+
+   auto isRemoved = [&removedItems](const CacheEntry_& cacheEntry)
+   {
+      for (auto item = static_cast<const Item*>(cacheEntry.index.internalPointer()); item != nullptr; item = item->parent())
+      {
+         if (removedItems.contains(item))
+         {
+            return true;
+         }
+      }
+
+      return false;
+   };
+
+   //
+   // Remove contiguous ranges of cache entries, starting at the end, so the rows of the ranges
+   // not yet removed remain unchanged.
+   //
+
+   int removedCount = 0;
+
+   for (int row = cache_.size() - 1; row >= 0; )
+   {
+      if (!isRemoved(cache_[row]))
+      {
+         --row;
+
+         continue;
+      }
+
+      int lastRow = row;
+      for (--row; ((row >= 0) && (isRemoved(cache_[row]))); --row)
+      {
+      }
+
+      beginRemoveRows(QModelIndex(), row + 1, lastRow);
+      cache_.remove(row + 1, lastRow - row);
+      endRemoveRows();
+
+      removedCount += (lastRow - row);
+   }
+
+   //
+   // The source model indexes of cached items following the removed rows within the same parent
+   // are no longer valid once the rows have been removed.
+   //
+
+   cacheInvalid_ = std::any_of(std::cbegin(cache_), std::cend(cache_), [parentItem, last](const CacheEntry_& cacheEntry)
+   {
+      auto item = static_cast<const Item*>(cacheEntry.index.internalPointer());
+
+      return ((item->parent() == parentItem) && (item->row() > last));
+   });
+
+   qDebug() << "search cache reduced" << removedCount << "items"
+            << std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - removeStart).count() << "us";
+}
+
+void SearchItemProxyModel::removed_()
+{
+   if (cacheInvalid_)
+   {
+      cacheInvalid_ = false;
+
+      reset_();
+   }
+}
+
+SearchItemProxyModel::CacheEntry_ SearchItemProxyModel::cacheEntry_(const QModelIndex& index, const LinkItem* item)
+{
+   CacheEntry_ cacheEntry{index, {}, item->tags(), item->brush()};
+
+   for (auto parentItem = item->parent<LinkGroupItem>(); parentItem != nullptr; parentItem = parentItem->parent<LinkGroupItem>())
+   {
+      cacheEntry.tagStringList.append(parentItem->tags());
+
+      if (cacheEntry.brush.style() == Qt::NoBrush)
+      {
+         cacheEntry.brush = parentItem->brush();
+      }
+   }
+
+   cacheEntry.tagStringList.sort(Qt::CaseInsensitive);
+   cacheEntry.tagString = cacheEntry.tagStringList.join(QStringLiteral(", "));
+
+   return cacheEntry;
 }
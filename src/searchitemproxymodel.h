@@ -10,6 +10,8 @@
 #ifndef SEARCHITEMPROXYMODEL_H
 #define SEARCHITEMPROXYMODEL_H
 
+#include <cstddef>
+
 #include <QAbstractProxyModel>
 #include <QBrush>
 #include <QModelIndex>
@@ -76,6 +78,11 @@ public:
     */
    const LinkItem* item(const QModelIndex& proxyIndex) const;
 
+   /*!
+    * Returns the number of bytes occupied by the cache of item properties.
+    */
+   std::size_t cacheSize() const;
+
 private:
    /*!
     * An entry in the cache.
@@ -91,12 +98,37 @@ private:
     * The cache mapping a source model item properties.
     */
    QVector<CacheEntry_> cache_;
+   /*!
+    * Is \a true if the rows of cached items have been changed by rows being removed from the
+    * source model, so the cache is to be rebuilt once they have been removed.
+    */
+   bool cacheInvalid_ = false;
 
    /*!
     * Resets the model, removing all groups from the cache and adding all
     * item groups found in the source model.
     */
    void reset_();
+   /*!
+    * Adds the items in the rows \a first to \a last of the parent \a parent, which have been
+    * inserted into the source model, to the cache.
+    */
+   void insert_(const QModelIndex& parent, int first, int last);
+   /*!
+    * Removes the items in the rows \a first to \a last of the parent \a parent, which are about
+    * to be removed from the source model, from the cache.
+    */
+   void remove_(const QModelIndex& parent, int first, int last);
+   /*!
+    * Rebuilds the cache if rows which have been removed from the source model changed the rows
+    * of any cached item.
+    */
+   void removed_();
+
+   /*!
+    * Returns the cache entry for the item \a item at the source model index \a index.
+    */
+   static CacheEntry_ cacheEntry_(const QModelIndex& index, const LinkItem* item);
 
    /*!
     * Returns \a true if \a row and \a column are valid; \a false otherwise.
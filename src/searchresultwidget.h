@@ -7,6 +7,10 @@
  *          published by the Free Software Foundation.
  */
 
+#include <QEvent>
+#include <QHeaderView>
+#include <QStyle>
+#include <QStyleOptionViewItem>
 #include <QTableView>
 
 #ifndef SEARCHRESULTWIDGET_H
@@ -35,6 +39,97 @@ public:
    {
       return QSize(0, 0);
    }
+
+   /*!
+    * Sets whether all rows have the same height, derived from the font and the style, to
+    * \a uniformRowHeights. If enabled the rows are not measured, so the layout and the size hint
+    * do not depend on the number of rows. Otherwise each row is resized to its contents.
+    */
+   void setUniformRowHeights(bool uniformRowHeights)
+   {
+      uniformRowHeights_ = uniformRowHeights;
+
+      updateRowHeights_();
+   }
+
+   /*!
+    * Returns \a true if all rows have the same height; \a false otherwise.
+    */
+   bool uniformRowHeights() const
+   {
+      return uniformRowHeights_;
+   }
+
+   /*!
+    * Returns the height of a row showing a single line of text, as it results from the font and
+    * the style.
+    */
+   int uniformRowHeight() const
+   {
+      auto option = viewOptions();
+      option.features |= QStyleOptionViewItem::HasDisplay;
+      option.text = QStringLiteral("Xg");
+
+      return (style()->sizeFromContents(QStyle::CT_ItemViewItem, &option, QSize(), this).height() + ((showGrid()) ? (1) : (0)));
+   }
+
+protected:
+   /*!
+    * \reimp
+    */
+   QSize viewportSizeHint() const override
+   {
+      if (!uniformRowHeights_)
+      {
+         return QTableView::viewportSizeHint();
+      }
+
+      //
+      // The height is calculated from the row count rather than summed up row by row.
+      //
+
+      qint64 rowCount = ((model() != nullptr) ? (model()->rowCount(rootIndex())) : (0));
+
+      return QSize(horizontalHeader()->length(), static_cast<int>(qMin(rowCount * verticalHeader()->defaultSectionSize(), static_cast<qint64>(QWIDGETSIZE_MAX))));
+   }
+
+   /*!
+    * \reimp
+    */
+   void changeEvent(QEvent* event) override
+   {
+      if ((event->type() == QEvent::FontChange) || (event->type() == QEvent::StyleChange))
+      {
+         updateRowHeights_();
+      }
+
+      QTableView::changeEvent(event);
+   }
+
+private:
+   /*!
+    * Is \a true if all rows have the same height.
+    */
+   bool uniformRowHeights_ = false;
+
+   /*!
+    * Updates the row heights for the current mode, font and style.
+    */
+   void updateRowHeights_()
+   {
+      if (uniformRowHeights_)
+      {
+         auto rowHeight = uniformRowHeight();
+
+         verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+         verticalHeader()->setMinimumSectionSize(rowHeight);
+         verticalHeader()->setDefaultSectionSize(rowHeight);
+      }
+      else
+      {
+         verticalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+      }
+   }
 };
 
 #endif // SEARCHRESULTWIDGET_H
@@ -14,6 +14,8 @@
 #include <QDebug>
 #include <QDesktopServices>
 #include <QDesktopWidget>
+#include <QDialog>
+#include <QFontDatabase>
 #include <QFontDialog>
 #include <QGraphicsDropShadowEffect>
 #include <QHeaderView>
@@ -22,6 +24,7 @@
 #include <QKeySequenceEdit>
 #include <QMenu>
 #include <QMouseEvent>
+#include <QPlainTextEdit>
 #include <QScrollBar>
 #include <QTableView>
 #include <QUrl>
@@ -30,11 +33,13 @@
 
 #include "application.h"
 #include "event.h"
+#include "itemdelegate.h"
 #include "itemmodel.h"
 #include "itemsourceeditor.h"
 #include "metatype.h"
 #include "searchbarwidget.h"
 #include "searchitemfiltermodel.h"
+#include "searchitempagemodel.h"
 #include "searchitemproxymodel.h"
 #include "searchresultwidget.h"
 #include "searchwindow.h"
@@ -85,10 +90,13 @@ SearchWindow::SearchWindow(ItemModel* itemModel, QWidget *parent) : QWidget(pare
 
    searchItemFilterModel_ = new SearchItemFilterModel(this);
    searchItemFilterModel_->setSourceModel(searchItemProxyModel_);
-   searchItemFilterModel_->sort(sortAlgorithm);
 
    searchItemFilterModelImplicitMatch_ = application->setting<SearchExpression::ImplicitMatch>(this, "implicitMatch", SearchExpression::ParameterImplicitMatch);
 
+   searchItemPageModel_ = new SearchItemPageModel(this);
+   searchItemPageModel_->setSourceModel(searchItemFilterModel_);
+   searchItemPageModel_->sort(sortAlgorithm);
+
    auto searchResultWidgetShadowEffect = new QGraphicsDropShadowEffect;
    searchResultWidgetShadowEffect->setColor(QColor(QStringLiteral("#1f3242")));
    searchResultWidgetShadowEffect->setBlurRadius(16.0);
@@ -97,12 +105,13 @@ SearchWindow::SearchWindow(ItemModel* itemModel, QWidget *parent) : QWidget(pare
    searchResultWidget_ = new SearchResultWidget(this);
    searchResultWidget_->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
    searchResultWidget_->horizontalHeader()->hide();
-   searchResultWidget_->verticalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
    searchResultWidget_->verticalHeader()->hide();
    searchResultWidget_->setContextMenuPolicy(Qt::CustomContextMenu);
    searchResultWidget_->setGraphicsEffect(searchResultWidgetShadowEffect);
+   searchResultWidget_->setItemDelegate(new ItemDelegate(searchResultWidget_));
+   searchResultWidget_->setUniformRowHeights(application->setting<bool>(this, "uniformRowHeights", true));
    searchResultWidget_->setFocusPolicy(Qt::NoFocus);
-   searchResultWidget_->setModel(searchItemFilterModel_);
+   searchResultWidget_->setModel(searchItemPageModel_);
    searchResultWidget_->setSelectionBehavior(QAbstractItemView::SelectRows);
    searchResultWidget_->setShowGrid(false);
    searchResultWidget_->setStyleSheet(QStringLiteral("SearchResultWidget { border: none; margin-left: 2px; margin-right: 2px; } "
@@ -114,7 +123,7 @@ SearchWindow::SearchWindow(ItemModel* itemModel, QWidget *parent) : QWidget(pare
       // Show the item-specific context menu if a valid item has been selected.
       //
 
-      if (auto item = searchItemFilterModel_->item(searchResultWidget_->indexAt(position)))
+      if (auto item = searchItemPageModel_->item(searchResultWidget_->indexAt(position)))
       {
          if (auto itemSource = item->parent<ItemSource>())
          {
@@ -145,9 +154,21 @@ SearchWindow::SearchWindow(ItemModel* itemModel, QWidget *parent) : QWidget(pare
    searchBarWidget_->setStyleSheet(QStringLiteral("QLineEdit { border: none; padding: 4px; }"));
    searchBarWidget_->connect(searchBarWidget_, &SearchBarWidget::textChanged, [this](const QString& text)
    {
+      //
+      // Drop any page fetched for the previous search expression before filtering, so the view
+      // is just updated for the rows of the first page.
+      //
+
+      searchItemPageModel_->resetPages();
       searchItemFilterModel_->setSearchExpression(text, searchItemFilterModelImplicitMatch_);
    });
    searchBarWidget_->connect(searchBarWidget_, &SearchBarWidget::returnPressed, [this](){
+      //
+      // Complete any delayed search first, so the items acted upon match the search expression.
+      //
+
+      searchItemFilterModel_->flushSearch();
+
       const auto& currentIndex = searchResultWidget_->currentIndex();
       if (currentIndex.isValid())
       {
@@ -156,7 +177,7 @@ SearchWindow::SearchWindow(ItemModel* itemModel, QWidget *parent) : QWidget(pare
          // could be opened. Remain shown otherwise so the error can be seen.
          //
 
-         if (openUrl_(searchItemFilterModel_->item(currentIndex), searchItemFilterModel_->searchExpression().parameters()))
+         if (openUrl_(searchItemPageModel_->item(currentIndex), searchItemFilterModel_->searchExpression().parameters()))
          {
             searchBarWidget_->removeIndication(QStringLiteral("openUrlError:*"));
 
@@ -193,6 +214,7 @@ SearchWindow::SearchWindow(ItemModel* itemModel, QWidget *parent) : QWidget(pare
    });
    searchBarWidget_->connect(searchBarWidget_, &SearchBarWidget::keyDownPressed, [this](){
       const auto& currentIndex = searchResultWidget_->currentIndex();
+      fetchResultRows_(currentIndex.row() + 1);
       searchResultWidget_->setCurrentIndex(currentIndex.isValid() ?
                                     searchResultWidget_->model()->index(qMin(searchResultWidget_->model()->rowCount() - 1, currentIndex.row() + 1), 0) :
                                     searchResultWidget_->model()->index(0, 0));
@@ -203,6 +225,7 @@ SearchWindow::SearchWindow(ItemModel* itemModel, QWidget *parent) : QWidget(pare
    });
    searchBarWidget_->connect(searchBarWidget_, &SearchBarWidget::keyPageDownPressed, [this](){
       const auto& currentIndex = searchResultWidget_->currentIndex();
+      fetchResultRows_(currentIndex.row() + 10);
       searchResultWidget_->setCurrentIndex(currentIndex.isValid() ?
                                     searchResultWidget_->model()->index(qMin(searchResultWidget_->model()->rowCount() - 1, currentIndex.row() + 10), 0) :
                                     searchResultWidget_->model()->index(0, 0));
@@ -214,6 +237,22 @@ SearchWindow::SearchWindow(ItemModel* itemModel, QWidget *parent) : QWidget(pare
 
       hide();
    });
+
+   //
+   // Show the number of items matching the search expression, which is known as soon as the
+   // items have been filtered, even though just the first page of them is shown. If the items
+   // of a searchable item source have been limited the number is just a lower bound.
+   //
+
+   auto updateMatchCount = [this]()
+   {
+      searchBarWidget_->setMatchCount(searchItemFilterModel_->rowCount(), itemModel_->isSearchTruncated());
+   };
+   searchBarWidget_->connect(searchItemFilterModel_, &SearchItemFilterModel::rowsInserted, updateMatchCount);
+   searchBarWidget_->connect(searchItemFilterModel_, &SearchItemFilterModel::rowsRemoved, updateMatchCount);
+   searchBarWidget_->connect(searchItemFilterModel_, &SearchItemFilterModel::modelReset, updateMatchCount);
+   searchBarWidget_->connect(itemModel_, &ItemModel::searched, updateMatchCount);
+
    searchBarWidget_->connect(itemModel_, &ItemModel::sourceFailedToLoad,
                                   [this](const QString& source, const QString& errorString)
    {
@@ -235,7 +274,7 @@ SearchWindow::SearchWindow(ItemModel* itemModel, QWidget *parent) : QWidget(pare
       // If an item is clicked open the link and remain shown (so multiple items can be clicked).
       //
 
-      openUrl_(searchItemFilterModel_->item(index), searchItemFilterModel_->searchExpression().parameters());
+      openUrl_(searchItemPageModel_->item(index), searchItemFilterModel_->searchExpression().parameters());
    });
 
    //
@@ -280,6 +319,25 @@ SearchWindow::SearchWindow(ItemModel* itemModel, QWidget *parent) : QWidget(pare
    {
       itemModel_->read(itemModel_->itemSourceIdentifier());
    });
+   searchExpressionEditContextMenu->addAction(tr("Statistics..."), [this]()
+   {
+      //
+      // Show the memory and size statistics of the items currently loaded.
+      //
+
+      auto statisticsEdit = new QPlainTextEdit;
+      statisticsEdit->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+      statisticsEdit->setLineWrapMode(QPlainTextEdit::NoWrap);
+      statisticsEdit->setPlainText(ItemSourceStatistics::report(itemModel_->itemSourceStatistics(), searchItemProxyModel_->cacheSize()));
+      statisticsEdit->setReadOnly(true);
+
+      QDialog statisticsDialog(this);
+      statisticsDialog.setLayout(new QVBoxLayout);
+      statisticsDialog.layout()->addWidget(statisticsEdit);
+      statisticsDialog.setWindowTitle(tr("Statistics"));
+      statisticsDialog.resize(480, 640);
+      statisticsDialog.exec();
+   });
 
    searchExpressionEditContextMenu->addSeparator();
 
@@ -288,7 +346,7 @@ SearchWindow::SearchWindow(ItemModel* itemModel, QWidget *parent) : QWidget(pare
    {
       application->setSetting(this, "sortAlgorithm", Enum::toString(SearchItemFilterModel::NameSortAlgorithm));
 
-      searchItemFilterModel_->sort(SearchItemFilterModel::NameSortAlgorithm);
+      searchItemPageModel_->sort(SearchItemFilterModel::NameSortAlgorithm);
    });
    sortAlgorithmMenuNameAction->setCheckable(true);
    sortAlgorithmMenuNameAction->setChecked(sortAlgorithm == SearchItemFilterModel::NameSortAlgorithm);
@@ -296,7 +354,7 @@ SearchWindow::SearchWindow(ItemModel* itemModel, QWidget *parent) : QWidget(pare
    {
       application->setSetting(this, "sortAlgorithm", Enum::toString(SearchItemFilterModel::TagSortAlgorithm));
 
-      searchItemFilterModel_->sort(SearchItemFilterModel::TagSortAlgorithm);
+      searchItemPageModel_->sort(SearchItemFilterModel::TagSortAlgorithm);
    });
    sortAlgorithmMenuTagAction->setCheckable(true);
    sortAlgorithmMenuTagAction->setChecked(sortAlgorithm == SearchItemFilterModel::TagSortAlgorithm);
@@ -355,6 +413,16 @@ SearchWindow::SearchWindow(ItemModel* itemModel, QWidget *parent) : QWidget(pare
 
    auto itemHotkey = new SystemHotkey(this);
    itemHotkey->connect(itemHotkey, &SystemHotkey::hotkeyPressed, [this](){
+      //
+      // Measure the time from the hotkey being received to the window being painted, unless the
+      // window is already shown (in which case it might not be painted at all).
+      //
+
+      if (!isVisible())
+      {
+         hotkeyLatencyTimer_.start();
+      }
+
       showNormal();
    });
 
@@ -439,7 +507,41 @@ bool SearchWindow::event(QEvent* event)
 {
    if (/* auto layoutRequestEvent = */ Event::cast<QEvent>(event, QEvent::LayoutRequest))
    {
-      resize(sizeHint());
+      auto size = sizeHint();
+      if (size != this->size())
+      {
+         resize(size);
+      }
+
+      //
+      // The layout is just activated for a visible window, so a layout requested while the window
+      // is hidden (for instance because the items have been reloaded) would otherwise be done
+      // when the window is shown again. Activate it right away instead, so showing the window
+      // does not require any relayout.
+      //
+
+      if ((!isVisible()) && (layout() != nullptr))
+      {
+         layout()->activate();
+      }
+   }
+   else if (/* auto hideEvent = */ Event::cast<QEvent>(event, QEvent::Hide))
+   {
+      //
+      // Drop any further page of search results while the window is hidden, so just the first
+      // page has to be painted as soon as the window is shown again.
+      //
+
+      searchItemPageModel_->resetPages();
+   }
+   else if (/* auto paintEvent = */ Event::cast<QEvent>(event, QEvent::Paint))
+   {
+      if (hotkeyLatencyTimer_.isValid())
+      {
+         qInfo() << "hotkey latency:" << (hotkeyLatencyTimer_.nsecsElapsed() / 1000000.0) << "ms";
+
+         hotkeyLatencyTimer_.invalidate();
+      }
    }
 
    return QWidget::event(event);
@@ -586,6 +688,14 @@ bool SearchWindow::eventFilter(QObject* object, QEvent* event)
    return consumeEvent;
 }
 
+void SearchWindow::fetchResultRows_(int row)
+{
+   while ((row >= searchItemPageModel_->rowCount()) && (searchItemPageModel_->canFetchMore(QModelIndex())))
+   {
+      searchItemPageModel_->fetchMore(QModelIndex());
+   }
+}
+
 bool SearchWindow::openSource_(const QString& source, const ItemSourcePosition& position)
 {
    qInfo() << "open source" << source << position.lineNumber() << position.columnNumber() << position.size();
@@ -624,7 +734,7 @@ bool SearchWindow::openUrl_(LinkItem* item, const QStringList& parameters)
    {
    case LinkItem::LinkMatch::SufficientParameters:
    {
-      auto url = QUrl::fromUserInput(item->link(parameters));
+      auto url = item->url(parameters);
 
       qInfo() << "open url" << url;
 
@@ -10,6 +10,7 @@
 #ifndef SEARCHWINDOW_H
 #define SEARCHWINDOW_H
 
+#include <QElapsedTimer>
 #include <QPoint>
 #include <QWidget>
 
@@ -21,6 +22,7 @@ class LinkItem;
 class QTableView;
 class SearchBarWidget;
 class SearchItemFilterModel;
+class SearchItemPageModel;
 class SearchItemProxyModel;
 class SearchResultWidget;
 
@@ -84,6 +86,15 @@ private:
     * The implicit matching strategy for the search item filter model.
     */
    SearchExpression::ImplicitMatch searchItemFilterModelImplicitMatch_ = SearchExpression::ParameterImplicitMatch;
+   /*!
+    * The search item page model.
+    */
+   SearchItemPageModel* searchItemPageModel_ = nullptr;
+
+   /*!
+    * The time since the hotkey has been received, which is valid until the window is painted.
+    */
+   QElapsedTimer hotkeyLatencyTimer_;
 
    /*!
     * The item edit used to enter a search expression.
@@ -104,6 +115,12 @@ private:
     */
    bool eventFilter(QObject* object, QEvent* event) override;
 
+   /*!
+    * Fetches further pages of search results until the row \a row is shown or there are no
+    * further results.
+    */
+   void fetchResultRows_(int row);
+
    /*!
     * Opens the source \a source at position \a position.
     */
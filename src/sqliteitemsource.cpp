@@ -0,0 +1,336 @@
+/*!
+ * \file sqliteitemsource.cpp
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+#include <QDebug>
+#include <QIODevice>
+#include <QObject>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QUuid>
+
+#include "itempalette.h"
+#include "linkitem.h"
+#include "searchexpression.h"
+#include "sqliteitemsource.h"
+#include "stringpool.h"
+
+namespace {
+
+/*!
+ * The header every SQLite database file starts with.
+ */
+static const char SQLITE_HEADER_[] = "SQLite format 3";
+/*!
+ * The size of the header of an SQLite database, which includes the file change counter, so a
+ * change to the database changes the header as well.
+ */
+static const qint64 SQLITE_HEADER_SIZE_ = 100;
+
+/*!
+ * The delimiter between multiple tags within a field.
+ */
+static const QChar TAG_DELIMITER_ = QLatin1Char(';');
+
+/*!
+ * The maximum number of items created for a search expression.
+ */
+std::atomic<int> searchLimit_(1000);
+
+/*!
+ * The number of rows looked up at once for each item to be created. Rows are looked up for the
+ * literal parts of the search terms only, so not every row is matched by the search expression
+ * itself, and further pages are looked up until enough items have been created.
+ */
+static const int SEARCH_CANDIDATE_FACTOR_ = 4;
+
+/*!
+ * Returns a unique name for a database connection.
+ */
+QString uniqueConnectionName()
+{
+   return QStringLiteral("SqliteItemSource-%1").arg(QUuid::createUuid().toString());
+}
+
+/*!
+ * Opens the database \a file read-only using the connection \a connectionName and returns the
+ * database.
+ */
+QSqlDatabase openDatabase(const QString& file, const QString& connectionName)
+{
+   auto database = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connectionName);
+   database.setDatabaseName(file);
+   database.setConnectOptions(QStringLiteral("QSQLITE_OPEN_READONLY"));
+   database.open();
+
+   return database;
+}
+
+} // namespace
+
+SqliteItemSource::~SqliteItemSource()
+{
+   if (!connectionName_.isEmpty())
+   {
+      QSqlDatabase::database(connectionName_, false).close();
+      QSqlDatabase::removeDatabase(connectionName_);
+   }
+}
+
+bool SqliteItemSource::read(QIODevice* device, const QString& identifier)
+{
+   ItemSource::setIdentifier(identifier);
+
+   if ((device == nullptr) || (device->peek(sizeof(SQLITE_HEADER_)) != QByteArray(SQLITE_HEADER_, sizeof(SQLITE_HEADER_))))
+   {
+      errorString_ = QObject::tr("Not an SQLite database");
+
+      return false;
+   }
+
+   return validate_(identifier);
+}
+
+bool SqliteItemSource::read(const char* data, qint64 size, const QString& identifier)
+{
+   ItemSource::setIdentifier(identifier);
+
+   //
+   // The database is accessed through SQLite, so just the header is read (see readSize()), which
+   // is used to check the format only (and for the content hash recorded by the reader).
+   //
+
+   if ((size < static_cast<qint64>(sizeof(SQLITE_HEADER_))) || (std::memcmp(data, SQLITE_HEADER_, sizeof(SQLITE_HEADER_)) != 0))
+   {
+      errorString_ = QObject::tr("Not an SQLite database");
+
+      return false;
+   }
+
+   return validate_(identifier);
+}
+
+bool SqliteItemSource::write(QIODevice* /* device */) const
+{
+   return false;
+}
+
+qint64 SqliteItemSource::readSize() const
+{
+   return SQLITE_HEADER_SIZE_;
+}
+
+bool SqliteItemSource::isSearchable() const
+{
+   return true;
+}
+
+QVector<Item*> SqliteItemSource::search(const SearchExpression& searchExpression)
+{
+   QVector<Item*> items;
+
+   searchTruncated_ = false;
+
+   //
+   // An empty search expression is not searched, as the items would not be shown anyway (see
+   // SearchItemFilterModel::EmptySearchExpressionFilter).
+   //
+
+   if (searchExpression.isEmpty())
+   {
+      return items;
+   }
+
+   auto searchStart = std::chrono::steady_clock::now();
+
+   if (connectionName_.isEmpty())
+   {
+      connectionName_ = uniqueConnectionName();
+
+      openDatabase(identifier(), connectionName_);
+   }
+
+   auto database = QSqlDatabase::database(connectionName_, false);
+   if (!database.isOpen())
+   {
+      qWarning() << "database not open" << identifier() << database.lastError().text();
+
+      return items;
+   }
+
+   //
+   // Only rows containing the literal parts of the search terms are looked up, in the full-text
+   // index if the literal parts are long enough, or by scanning the table otherwise. Each row is
+   // then matched against the search expression itself, so the items created are exactly the
+   // items matched by the search expression. The rows are looked up page by page in the order of
+   // their row identifiers, until enough items have been created or there are no more rows, so
+   // no matching row is skipped, but SQLite stops as soon as enough items have been created.
+   //
+
+   const auto& fullTextQuery = searchExpression.fullTextQuery(QStringLiteral("name"), QStringLiteral("tags"));
+   const auto& scanCondition = ((fullTextQuery.isEmpty()) ? (searchExpression.scanCondition(QStringLiteral("name"), QStringLiteral("tags"))) : (QString()));
+
+   QSqlQuery query(database);
+   query.setForwardOnly(true);
+
+   if (!fullTextQuery.isEmpty())
+   {
+      query.prepare(QStringLiteral("SELECT items.rowid, items.name, items.url, items.tags, items.color FROM items_fts "
+                                   "JOIN items ON (items.rowid = items_fts.rowid) WHERE (items_fts MATCH ?) AND (items_fts.rowid > ?) "
+                                   "ORDER BY items_fts.rowid LIMIT ?"));
+      query.bindValue(0, fullTextQuery);
+   }
+   else
+   {
+      query.prepare(QStringLiteral("SELECT rowid, name, url, tags, color FROM items WHERE (%1) AND (rowid > ?) ORDER BY rowid LIMIT ?")
+                    .arg((scanCondition.isEmpty()) ? (QStringLiteral("1")) : (scanCondition)));
+   }
+
+   const int cursorBindIndex = ((!fullTextQuery.isEmpty()) ? (1) : (0));
+
+   int rowCount = 0;
+   int pageCount = 0;
+   int searchLimit = searchLimit_.load();
+   qint64 pageSize = std::max(static_cast<qint64>(searchLimit) * SEARCH_CANDIDATE_FACTOR_, static_cast<qint64>(1));
+   qint64 rowIdentifier = std::numeric_limits<qint64>::min();
+
+   bool rowsExhausted = false;
+   while ((items.size() < searchLimit) && (!rowsExhausted))
+   {
+      query.bindValue(cursorBindIndex, rowIdentifier);
+      query.bindValue(cursorBindIndex + 1, pageSize);
+
+      if (!query.exec())
+      {
+         qWarning() << "database search failed" << identifier() << query.lastError().text();
+
+         break;
+      }
+
+      ++pageCount;
+
+      qint64 pageRowCount = 0;
+      while ((items.size() < searchLimit) && (query.next()))
+      {
+         ++rowCount;
+         ++pageRowCount;
+
+         rowIdentifier = query.value(0).toLongLong();
+
+         const auto& name = query.value(1).toString().trimmed();
+         const auto& tags = query.value(3).toString().split(TAG_DELIMITER_, QString::SkipEmptyParts);
+
+         QStringList trimmedTags;
+         for (const auto& tag : tags)
+         {
+            trimmedTags.append(tag.trimmed());
+         }
+
+         if (!searchExpression.matches(name, trimmedTags))
+         {
+            continue;
+         }
+
+         auto item = createItem<LinkItem>();
+         item->setName(name);
+         item->setLink(query.value(2).toString());
+         for (const auto& tag : trimmedTags)
+         {
+            item->appendTag(StringPool::intern(tag));
+         }
+         item->setBrushIndex(ItemPalette::index(query.value(4).toString().trimmed()));
+
+         items.append(item);
+      }
+
+      rowsExhausted = ((items.size() < searchLimit) && (pageRowCount < pageSize));
+
+      query.finish();
+   }
+
+   //
+   // If the search limit has been reached there may be further rows matching.
+   //
+
+   searchTruncated_ = ((searchLimit > 0) && (items.size() >= searchLimit));
+
+   qDebug() << "database searched" << identifier() << ((!fullTextQuery.isEmpty()) ? ("index") : ("scan")) << pageCount << "pages"
+            << rowCount << "rows" << items.size() << "items" << (searchTruncated_ ? ("truncated") : (""))
+            << std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - searchStart).count() << "us";
+
+   return items;
+}
+
+bool SqliteItemSource::isSearchTruncated() const
+{
+   return searchTruncated_;
+}
+
+QString SqliteItemSource::errorString() const
+{
+   return errorString_;
+}
+
+QPoint SqliteItemSource::errorPosition() const
+{
+   return QPoint();
+}
+
+void SqliteItemSource::setSearchLimit(int searchLimit)
+{
+   searchLimit_ = std::max(searchLimit, 0);
+}
+
+int SqliteItemSource::searchLimit()
+{
+   return searchLimit_;
+}
+
+bool SqliteItemSource::validate_(const QString& file)
+{
+   bool result = false;
+
+   //
+   // The item source is read by another thread than the one searching it, so a temporary
+   // connection is used.
+   //
+
+   auto connectionName = uniqueConnectionName();
+
+   {
+      auto database = openDatabase(file, connectionName);
+      if (database.isOpen())
+      {
+         QSqlQuery query(database);
+
+         result = ((query.exec(QStringLiteral("SELECT name, url, tags, color FROM items LIMIT 0"))) &&
+                   (query.exec(QStringLiteral("SELECT rowid FROM items_fts WHERE items_fts MATCH 'xyz' LIMIT 0"))));
+         if (!result)
+         {
+            errorString_ = QObject::tr("Invalid database schema: ").append(query.lastError().text());
+         }
+      }
+      else
+      {
+         errorString_ = database.lastError().text();
+      }
+
+      database.close();
+   }
+
+   QSqlDatabase::removeDatabase(connectionName);
+
+   return result;
+}
@@ -0,0 +1,110 @@
+/*!
+ * \file sqliteitemsource.h
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#ifndef SQLITEITEMSOURCE_H
+#define SQLITEITEMSOURCE_H
+
+#include "itemsource.h"
+
+/*!
+ * \brief An item source represented as SQLite database, searched using a full-text index.
+ *
+ * The database contains a table \a items with the columns \a name, \a url, \a tags (separated
+ * by semicolons) and \a color, and an FTS5 table \a items_fts indexing the columns \a name and
+ * \a tags of the table \a items using the trigram tokenizer. The items are not read as a whole,
+ * instead the rows matching a search expression are looked up in the full-text index and only
+ * those are created, up to the limit set by setSearchLimit(). Search expressions which cannot be
+ * looked up in the full-text index (as a term has less than three literal characters, for
+ * instance) are looked up by scanning the table instead. The rows are looked up page by page,
+ * until enough items have been created, so SQLite stops as soon as the limit is reached, and
+ * isSearchTruncated() reports whether it has been reached. The database is opened read-only.
+ */
+class SqliteItemSource : public ItemSource
+{
+public:
+   /*!
+    * Destructs the item source, closing the database if open.
+    */
+   ~SqliteItemSource();
+
+   /*!
+    * \reimp
+    */
+   bool read(QIODevice* device, const QString& identifier) override;
+   /*!
+    * \reimp
+    */
+   bool read(const char* data, qint64 size, const QString& identifier) override;
+   /*!
+    * \reimp
+    */
+   bool write(QIODevice* device) const override;
+
+   /*!
+    * \reimp
+    */
+   qint64 readSize() const override;
+   /*!
+    * \reimp
+    */
+   bool isSearchable() const override;
+   /*!
+    * \reimp
+    */
+   QVector<Item*> search(const SearchExpression& searchExpression) override;
+   /*!
+    * \reimp
+    */
+   bool isSearchTruncated() const override;
+
+   /*!
+    * \reimp
+    */
+   QString errorString() const override;
+   /*!
+    * \reimp
+    */
+   QPoint errorPosition() const override;
+
+   /*!
+    * Sets the maximum number of items created for a search expression to \a searchLimit. The
+    * default is 1000.
+    */
+   static void setSearchLimit(int searchLimit);
+   /*!
+    * Returns the maximum number of items created for a search expression.
+    */
+   static int searchLimit();
+
+private:
+   /*!
+    * The database error.
+    */
+   QString errorString_;
+
+   /*!
+    * Is \a true if the items created by the last search have been limited by the search limit.
+    */
+   bool searchTruncated_ = false;
+
+   /*!
+    * The name of the database connection used for searching, which is opened by the first search
+    * (as a connection can only be used by the thread which opened it), or an empty string if the
+    * connection has not been opened yet.
+    */
+   QString connectionName_;
+
+   /*!
+    * Validates the schema of the database \a file and returns \a true if it is valid; \a false
+    * otherwise.
+    */
+   bool validate_(const QString& file);
+};
+
+#endif // SQLITEITEMSOURCE_H
@@ -0,0 +1,164 @@
+/*!
+ * \file stringpool.cpp
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#include <QAtomicInteger>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+
+#include "stringpool.h"
+
+namespace {
+
+/*!
+ * The number of shards the pool is divided into, which must be a power of two.
+ */
+static const uint SHARD_COUNT_ = 16;
+
+/*!
+ * \brief A shard of the pool.
+ */
+struct Shard
+{
+   /*!
+    * The lock guarding the shard.
+    */
+   QMutex lock;
+   /*!
+    * The strings of the shard.
+    */
+   QSet<QString> strings;
+};
+
+/*!
+ * The shards of the pool.
+ */
+Shard shards_[SHARD_COUNT_];
+
+/*!
+ * The number of strings interned which were already present.
+ */
+QAtomicInteger<quint64> hitCount_;
+/*!
+ * The number of strings interned which were not yet present.
+ */
+QAtomicInteger<quint64> missCount_;
+/*!
+ * The number of bytes saved by sharing strings.
+ */
+QAtomicInteger<quint64> savedSize_;
+
+/*!
+ * Returns the number of bytes occupied by the string \a string.
+ */
+quint64 stringSize(const QString& string)
+{
+   return (sizeof(QArrayData) + (static_cast<quint64>(string.capacity() + 1) * sizeof(QChar)));
+}
+
+} // namespace
+
+QString StringPool::intern(const QString& string)
+{
+   if (string.isEmpty())
+   {
+      return string;
+   }
+
+   //
+   // The shard is selected by the hash of the string, so equal strings always end up in the
+   // same shard. The upper bits are used as the lower bits are used by the sets themselves.
+   //
+
+   auto& shard = shards_[(qHash(string) >> 16) & (SHARD_COUNT_ - 1)];
+
+   QMutexLocker shardLocker(&shard.lock);
+
+   auto shardString = shard.strings.constFind(string);
+   if (shardString != shard.strings.constEnd())
+   {
+      hitCount_.fetchAndAddRelaxed(1);
+      savedSize_.fetchAndAddRelaxed(stringSize(string));
+
+      return *shardString;
+   }
+
+   //
+   // Store the string with no excess capacity, as it is going to be shared for its lifetime.
+   //
+
+   QString poolString = string;
+   if (poolString.capacity() > poolString.size())
+   {
+      poolString.squeeze();
+   }
+
+   shard.strings.insert(poolString);
+
+   missCount_.fetchAndAddRelaxed(1);
+
+   return poolString;
+}
+
+QStringList StringPool::intern(const QStringList& strings)
+{
+   QStringList poolStrings;
+   poolStrings.reserve(strings.size());
+
+   for (const auto& string : strings)
+   {
+      poolStrings.append(intern(string));
+   }
+
+   return poolStrings;
+}
+
+void StringPool::squeeze()
+{
+   for (auto& shard : shards_)
+   {
+      QMutexLocker shardLocker(&shard.lock);
+
+      for (auto shardString = shard.strings.begin(); shardString != shard.strings.end(); )
+      {
+         if (shardString->isDetached())
+         {
+            shardString = shard.strings.erase(shardString);
+         }
+         else
+         {
+            ++shardString;
+         }
+      }
+   }
+}
+
+StringPool::Statistics StringPool::statistics()
+{
+   Statistics statistics;
+   statistics.hitCount = hitCount_.load();
+   statistics.missCount = missCount_.load();
+   statistics.savedSize = savedSize_.load();
+
+   for (auto& shard : shards_)
+   {
+      QMutexLocker shardLocker(&shard.lock);
+
+      statistics.count += static_cast<quint64>(shard.strings.size());
+      statistics.tableSize += ((static_cast<quint64>(shard.strings.capacity()) * sizeof(void*)) +
+                               (static_cast<quint64>(shard.strings.size()) * sizeof(QHashNode<QString, QHashDummyValue>)));
+
+      for (const auto& shardString : shard.strings)
+      {
+         statistics.size += stringSize(shardString);
+      }
+   }
+
+   return statistics;
+}
@@ -0,0 +1,89 @@
+/*!
+ * \file stringpool.h
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+
+/*!
+ * \brief A pool of interned strings.
+ *
+ * Strings of equal content returned by intern() share the very same immutable data, so they
+ * can be compared by pointer (QString::constData()) and are stored just once. The pool is
+ * shared by all item sources and can be safely used from multiple threads; it is divided into
+ * shards, each guarded by a lock of its own, so concurrent readers rarely contend.
+ */
+class StringPool
+{
+public:
+   /*!
+    * \brief The statistics of the pool.
+    */
+   struct Statistics
+   {
+      /*!
+       * The number of strings interned which were already present in the pool.
+       */
+      quint64 hitCount = 0;
+      /*!
+       * The number of strings interned which were not yet present in the pool.
+       */
+      quint64 missCount = 0;
+      /*!
+       * The number of bytes saved by sharing strings already present in the pool.
+       */
+      quint64 savedSize = 0;
+      /*!
+       * The number of strings in the pool.
+       */
+      quint64 count = 0;
+      /*!
+       * The number of bytes occupied by the strings in the pool.
+       */
+      quint64 size = 0;
+      /*!
+       * The estimated number of bytes occupied by the tables of the pool (the buckets and nodes
+       * of the sets the shards consist of), not including the strings themselves.
+       */
+      quint64 tableSize = 0;
+
+      /*!
+       * Returns the ratio of hits to interned strings.
+       */
+      double hitRate() const
+      {
+         return (((hitCount + missCount) > 0) ? (static_cast<double>(hitCount) / (hitCount + missCount)) : 0.0);
+      }
+   };
+
+   /*!
+    * Returns the string of the pool equal to \a string, adding \a string to the pool if no such
+    * string is present yet.
+    */
+   static QString intern(const QString& string);
+   /*!
+    * Returns the list of strings \a strings with each string interned.
+    */
+   static QStringList intern(const QStringList& strings);
+
+   /*!
+    * Removes all strings from the pool which are no longer referenced outside of the pool.
+    */
+   static void squeeze();
+
+   /*!
+    * Returns the statistics of the pool.
+    */
+   static Statistics statistics();
+};
+
+#endif // STRINGPOOL_H
@@ -15,9 +15,11 @@
 #include "importitem.h"
 #include "importgroupitem.h"
 #include "item.h"
+#include "itempalette.h"
 #include "groupitem.h"
 #include "linkitem.h"
 #include "linkgroupitem.h"
+#include "stringpool.h"
 #include "xmlitemsource.h"
 
 namespace {
@@ -96,13 +98,13 @@ void XmlItemSource::readItem_(QXmlStreamReader* reader, GroupItem* parent)
    Q_ASSERT(reader != nullptr);
    Q_ASSERT(parent != nullptr);
 
-   auto item = new LinkItem;
+   auto item = createItem<LinkItem>();
 
    while (reader->readNextStartElement())
    {
       if (reader->name() == "name")
       {
-         item->setName(reader->readElementText().trimmed());
+         item->setName(StringPool::intern(reader->readElementText().trimmed()));
       }
       else if (reader->name() == "url")
       {
@@ -119,11 +121,11 @@ void XmlItemSource::readItem_(QXmlStreamReader* reader, GroupItem* parent)
       }
       else if (reader->name() == "color")
       {
-         item->setBrush(QBrush(QColor(reader->readElementText().trimmed())));
+         item->setBrushIndex(ItemPalette::index(reader->readElementText().trimmed()));
       }
       else if (reader->name() == "tag")
       {
-         item->appendTag(reader->readElementText().trimmed());
+         item->appendTag(StringPool::intern(reader->readElementText().trimmed()));
       }
       else
       {
@@ -131,14 +133,14 @@ void XmlItemSource::readItem_(QXmlStreamReader* reader, GroupItem* parent)
       }
    }
 
-   parent->insertItem(item, parent->itemCount());
+   appendItem(parent, item);
 }
 
 void XmlItemSource::readGroup_(QXmlStreamReader* reader, GroupItem* parent)
 {
    Q_ASSERT(reader != nullptr);
 
-   auto itemGroup = new LinkGroupItem;
+   auto itemGroup = createItem<LinkGroupItem>();
 
    while (reader->readNextStartElement())
    {
@@ -148,15 +150,15 @@ void XmlItemSource::readGroup_(QXmlStreamReader* reader, GroupItem* parent)
       }
       else if (reader->name() == "name")
       {
-         itemGroup->setName(reader->readElementText().trimmed());
+         itemGroup->setName(StringPool::intern(reader->readElementText().trimmed()));
       }
       else if (reader->name() == "color")
       {
-         itemGroup->setBrush(QBrush(QColor(reader->readElementText().trimmed())));
+         itemGroup->setBrushIndex(ItemPalette::index(reader->readElementText().trimmed()));
       }
       else if (reader->name() == "tag")
       {
-         itemGroup->appendTag(reader->readElementText().trimmed());
+         itemGroup->appendTag(StringPool::intern(reader->readElementText().trimmed()));
       }
       else if (reader->name() == "group")
       {
@@ -168,23 +170,33 @@ void XmlItemSource::readGroup_(QXmlStreamReader* reader, GroupItem* parent)
       }
    }
 
-   parent->insertItem(itemGroup, parent->itemCount());
+   appendItem(parent, itemGroup);
 }
 
 void XmlItemSource::readImport_(QXmlStreamReader* reader)
 {
    Q_ASSERT(reader != nullptr);
 
-   auto itemGroup = new ImportGroupItem;
+   auto itemGroup = createItem<ImportGroupItem>();
 
    while (reader->readNextStartElement())
    {
       if (reader->name() == "file")
       {
-         itemGroup->insertItem(new ImportItem(reader->readElementText().trimmed(),
-                                              reader->attributes().hasAttribute(QStringLiteral("contentType")) ?
-                                              reader->attributes().value(QStringLiteral("contentType")).toString().trimmed() :
-                                              QStringLiteral("text/xml")), itemGroup->itemCount());
+         //
+         // The attributes must be read before the element text, which advances the reader.
+         //
+
+         auto attributes = reader->attributes();
+
+         auto item = createItem<ImportItem>(QString(),
+                                            attributes.hasAttribute(QStringLiteral("contentType")) ?
+                                            StringPool::intern(attributes.value(QStringLiteral("contentType")).toString().trimmed()) :
+                                            QStringLiteral("text/xml"));
+         item->setContentEncoding(StringPool::intern(attributes.value(QStringLiteral("contentEncoding")).toString().trimmed().toLower()));
+         item->setFile(reader->readElementText().trimmed());
+
+         itemGroup->insertItem(item, itemGroup->itemCount());
       }
       else
       {
@@ -192,5 +204,5 @@ void XmlItemSource::readImport_(QXmlStreamReader* reader)
       }
    }
 
-   insertItem(itemGroup, itemCount());
+   appendItem(this, itemGroup);
 }
@@ -22,6 +22,8 @@ class QXmlStreamReader;
 class XmlItemSource : public ItemSource
 {
 public:
+   using ItemSource::read;
+
    /*!
     * \reimp
     */
@@ -40,7 +42,7 @@ public:
     */
    QPoint errorPosition() const override;
 
-private:
+protected:
    /*!
     * The XML document error.
     */
@@ -50,6 +52,8 @@ private:
     */
    mutable QPoint errorPosition_;
 
+private:
+
    /*!
     * Reads an item from the XML stream \a reader and adds it to the list of items.
     */
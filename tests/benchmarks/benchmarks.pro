@@ -0,0 +1,22 @@
+#
+# \file benchmarks.pro
+#
+# \copyright 2016 Lukas Geyer. All rights reseverd.
+# \license This program is free software; you can redistribute it and/or modify
+#          it under the terms of the GNU General Public License version 3 as
+#          published by the Free Software Foundation.
+#
+
+include(../tests.pri)
+
+#
+# The benchmarks take a while and require a display (the search window grabs its hotkey), so
+# they are not run by 'make check', but have to be run explicitly.
+#
+
+CONFIG -= testcase
+
+TARGET = tst_benchmarks
+
+SOURCES += \
+    tst_benchmarks.cpp
@@ -0,0 +1,1107 @@
+/*!
+ * \file tst_benchmarks.cpp
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#include <algorithm>
+#include <memory>
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QProcessEnvironment>
+#include <QScrollBar>
+#include <QSignalSpy>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStandardItemModel>
+#include <QStandardPaths>
+#include <QString>
+#include <QStyledItemDelegate>
+#include <QTemporaryDir>
+#include <QUuid>
+#include <QVector>
+#include <QtTest>
+
+#include "application.h"
+#include "catalogsnapshot.h"
+#include "csvitemsource.h"
+#include "fastxmlitemsource.h"
+#include "importitem.h"
+#include "importitemreader.h"
+#include "item.h"
+#include "itemdelegate.h"
+#include "itemmodel.h"
+#include "jsonitemsource.h"
+#include "linkgroupitem.h"
+#include "linkitem.h"
+#include "searchexpression.h"
+#include "searchresultwidget.h"
+#include "searchwindow.h"
+#include "sqliteitemsource.h"
+#include "xmlitemsource.h"
+
+namespace {
+
+/*!
+ * The number of items of the catalog loaded.
+ */
+static const int DEFAULT_CATALOG_ITEM_COUNT_ = 250000;
+/*!
+ * The number of items per group of the documents generated.
+ */
+static const int DEFAULT_GROUP_SIZE_ = 16;
+
+/*!
+ * The number of distinct files imported.
+ */
+static const int DEFAULT_IMPORT_FILE_COUNT_ = 32;
+/*!
+ * The number of items of each file imported.
+ */
+static const int DEFAULT_IMPORT_ITEM_COUNT_ = 4096;
+/*!
+ * The number of times each file is imported if imports are duplicated.
+ */
+static const int DEFAULT_DUPLICATE_IMPORT_COUNT_ = 8;
+/*!
+ * The time the item model may take to load all item sources, in milliseconds.
+ */
+static const int DEFAULT_LOAD_TIMEOUT_ = 60000;
+
+/*!
+ * The number of items of the trees traversed.
+ */
+static const int DEFAULT_TRAVERSAL_ITEM_COUNT_ = 1000000;
+/*!
+ * The depth of the deep tree traversed.
+ */
+static const int DEFAULT_TRAVERSAL_DEPTH_ = 100000;
+
+/*!
+ * The number of links the environment variables are resolved for.
+ */
+static const int DEFAULT_LINK_COUNT_ = 100000;
+
+/*!
+ * The number of items of the documents the parse throughput is measured for.
+ */
+static const int DEFAULT_PARSE_ITEM_COUNT_ = 250000;
+/*!
+ * The maximum number of threads a document is read concurrently by.
+ */
+static const int DEFAULT_MAXIMUM_THREAD_COUNT_ = 16;
+/*!
+ * The size from which documents are read concurrently.
+ */
+static const int DEFAULT_CONCURRENT_READ_SIZE_ = (8 * 1024 * 1024);
+
+/*!
+ * The number of rows of the database searched.
+ */
+static const int DEFAULT_DATABASE_ROW_COUNT_ = 1000000;
+/*!
+ * The number of rows of the large database searched, which is only created if the environment
+ * variable LAUNCHER_LARGE_BENCHMARKS is set, as creating it takes minutes and gigabytes.
+ */
+static const int DEFAULT_LARGE_DATABASE_ROW_COUNT_ = 10000000;
+
+/*!
+ * The number of rows of the result view scrolled.
+ */
+static const int DEFAULT_RESULT_ROW_COUNT_ = 100000;
+/*!
+ * The size of the result view scrolled.
+ */
+static const QSize DEFAULT_RESULT_VIEW_SIZE_ = {800, 600};
+
+/*!
+ * The number of times the search window is shown to measure the hotkey latency.
+ */
+static const int DEFAULT_HOTKEY_SAMPLE_COUNT_ = 32;
+/*!
+ * The time the search window should be painted in once the hotkey has been received, in
+ * milliseconds, which is a single frame at 60 Hz.
+ */
+static const qreal DEFAULT_HOTKEY_LATENCY_TARGET_ = 16.0;
+
+/*!
+ * Returns an XML document with \a itemCount items, grouped in groups of DEFAULT_GROUP_SIZE_
+ * items, each with a distinct name and link and a shared color and tag.
+ */
+QByteArray xmlDocument(int itemCount)
+{
+   QByteArray document;
+   document.append("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<items>\n");
+
+   for (int item = 0; item < itemCount; ++item)
+   {
+      const auto& itemNumber = QByteArray::number(item);
+
+      if ((item % DEFAULT_GROUP_SIZE_) == 0)
+      {
+         if (item > 0)
+         {
+            document.append("   </group>\n");
+         }
+
+         document.append("   <group>\n      <name>Group " + itemNumber + "</name>\n      <color>#0000ff</color>\n");
+      }
+
+      document.append("      <item>\n");
+      document.append("         <name>Item " + itemNumber + "</name>\n");
+      document.append("         <url>https://example.com/" + itemNumber + "/{0}?q={%*}</url>\n");
+      document.append("         <tag>tag" + QByteArray::number(item % 7) + "</tag>\n");
+      document.append("      </item>\n");
+   }
+
+   if (itemCount > 0)
+   {
+      document.append("   </group>\n");
+   }
+
+   document.append("</items>\n");
+
+   return document;
+}
+
+/*!
+ * Returns a CSV document with \a itemCount items, grouped in groups of DEFAULT_GROUP_SIZE_
+ * items, each with a distinct name and link and a shared color and tags. Every other name is
+ * quoted.
+ */
+QByteArray csvDocument(int itemCount)
+{
+   QByteArray document;
+   document.append("name,url,tags,color,group\n");
+
+   for (int item = 0; item < itemCount; ++item)
+   {
+      const auto& itemNumber = QByteArray::number(item);
+
+      document.append(((item % 2) == 0) ? ("Item " + itemNumber) : ("\"Item " + itemNumber + ", \"\"quoted\"\"\""));
+      document.append(",https://example.com/" + itemNumber + "/{0}?q={%*},tag" + QByteArray::number(item % 7) + ";shared,#0000ff,");
+      document.append("Group " + QByteArray::number(item / DEFAULT_GROUP_SIZE_) + "\n");
+   }
+
+   return document;
+}
+
+/*!
+ * Returns a JSON document with \a itemCount items, grouped in groups of DEFAULT_GROUP_SIZE_
+ * items, each with a distinct name and link and a shared color and tag.
+ */
+QByteArray jsonDocument(int itemCount)
+{
+   QByteArray document;
+   document.append("{\n   \"items\": [\n");
+
+   for (int item = 0; item < itemCount; ++item)
+   {
+      const auto& itemNumber = QByteArray::number(item);
+
+      if ((item % DEFAULT_GROUP_SIZE_) == 0)
+      {
+         if (item > 0)
+         {
+            document.append("\n      ] },\n");
+         }
+
+         document.append("      { \"name\": \"Group " + itemNumber + "\", \"color\": \"#0000ff\", \"items\": [\n");
+      }
+      else
+      {
+         document.append(",\n");
+      }
+
+      document.append("         { \"name\": \"Item " + itemNumber + "\", \"url\": \"https://example.com/" + itemNumber + "/{0}?q={%*}\", "
+                      "\"tags\": [\"tag" + QByteArray::number(item % 7) + "\"] }");
+   }
+
+   if (itemCount > 0)
+   {
+      document.append("\n      ] }\n");
+   }
+
+   document.append("   ]\n}\n");
+
+   return document;
+}
+
+/*!
+ * Creates the SQLite database \a fileName with \a rowCount items, each with a distinct name and
+ * link and shared tags, indexed for full-text search, and returns \a true if the database could
+ * be created; \a false otherwise.
+ */
+bool createDatabase(const QString& fileName, int rowCount)
+{
+   static const QString connectionName = QStringLiteral("benchmark");
+
+   bool result = false;
+
+   {
+      auto database = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connectionName);
+      database.setDatabaseName(fileName);
+
+      if (database.open())
+      {
+         {
+            QSqlQuery query(database);
+
+            result = ((query.exec(QStringLiteral("CREATE TABLE items (name TEXT NOT NULL, url TEXT NOT NULL, tags TEXT, color TEXT)"))) &&
+                      (query.exec(QStringLiteral("CREATE VIRTUAL TABLE items_fts USING fts5(name, tags, content='items', tokenize='trigram')"))) &&
+                      (database.transaction()) &&
+                      (query.prepare(QStringLiteral("INSERT INTO items (name, url, tags, color) VALUES (?, ?, ?, ?)"))));
+
+            for (int row = 0; ((result) && (row < rowCount)); ++row)
+            {
+               query.bindValue(0, QStringLiteral("Item %1").arg(row));
+               query.bindValue(1, QStringLiteral("https://example.com/%1/{0}").arg(row));
+               query.bindValue(2, QStringLiteral("tag%1;shared").arg(row % 7));
+               query.bindValue(3, QStringLiteral("#0000ff"));
+
+               result = query.exec();
+            }
+
+            result = ((result) && (database.commit()) && (query.exec(QStringLiteral("INSERT INTO items_fts(items_fts) VALUES ('rebuild')"))));
+         }
+
+         database.close();
+      }
+   }
+
+   QSqlDatabase::removeDatabase(connectionName);
+
+   return result;
+}
+
+/*!
+ * Reports the throughput for \a size bytes read in \a nanoseconds.
+ */
+void reportThroughput(qint64 size, qint64 nanoseconds)
+{
+   qInfo() << "throughput" << ((nanoseconds > 0) ? ((size * 1000.0) / nanoseconds) : (0.0)) << "MB/s";
+}
+
+/*!
+ * Returns the string \a string with the environment variables of the process environment
+ * \a processEnvironment resolved by replacing each variable in turn, as done before the
+ * environment has been snapshot, for comparison.
+ */
+QString applyProcessEnvironmentByReplacing(const QString& string, const QProcessEnvironment& processEnvironment)
+{
+   QString appliedString = string;
+
+   const auto& keys = processEnvironment.keys();
+   for (const auto& key : keys)
+   {
+      appliedString.replace((QStringLiteral("{") + key + QStringLiteral("}")), processEnvironment.value(key));
+   }
+
+   return appliedString;
+}
+
+/*!
+ * \brief An item exposing the resolution of environment variables.
+ */
+class ProcessEnvironmentItem : public Item
+{
+public:
+   using Item::applyProcessEnvironment;
+};
+
+/*!
+ * Writes the content \a content to the file \a fileName and returns \a true if the file could be
+ * written; \a false otherwise.
+ */
+bool writeFile(const QString& fileName, const QByteArray& content)
+{
+   QFile file(fileName);
+
+   return ((file.open(QIODevice::WriteOnly)) && (file.write(content) == content.size()));
+}
+
+/*!
+ * Returns the content of the file \a fileName or an empty byte array if it cannot be read.
+ */
+QByteArray readFile(const QString& fileName)
+{
+   QFile file(fileName);
+
+   return ((file.open(QIODevice::ReadOnly)) ? (file.readAll()) : (QByteArray()));
+}
+
+/*!
+ * \brief An event filter measuring the time until the object filtered is painted.
+ */
+class PaintLatencyFilter : public QObject
+{
+public:
+   /*!
+    * Starts measuring the time until the object filtered is painted.
+    */
+   void start()
+   {
+      latency_ = -1;
+      latencyTimer_.start();
+   }
+
+   /*!
+    * Returns the time from start() until the object filtered has been painted, in nanoseconds,
+    * or -1 if it has not been painted yet.
+    */
+   qint64 latency() const
+   {
+      return latency_;
+   }
+
+   /*!
+    * \reimp
+    */
+   bool eventFilter(QObject* object, QEvent* event) override
+   {
+      if ((event->type() == QEvent::Paint) && (latency_ < 0) && (latencyTimer_.isValid()))
+      {
+         latency_ = latencyTimer_.nsecsElapsed();
+      }
+
+      return QObject::eventFilter(object, event);
+   }
+
+private:
+   /*!
+    * The time since start() has been called.
+    */
+   QElapsedTimer latencyTimer_;
+   /*!
+    * The time until the object filtered has been painted, in nanoseconds, or -1 if not yet painted.
+    */
+   qint64 latency_ = -1;
+};
+
+} // namespace
+
+/*!
+ * \brief The benchmarks of the launcher.
+ *
+ * The inputs are generated into a temporary directory, outside of the measurements.
+ */
+class TestBenchmarks : public QObject
+{
+   Q_OBJECT
+
+private slots:
+   /*!
+    * Verifies that the inputs can be generated.
+    */
+   void initTestCase()
+   {
+      QVERIFY(directory_.isValid());
+   }
+
+   /*!
+    * Provides whether the catalog is loaded from its snapshot or parsed.
+    */
+   void loadCatalog_data()
+   {
+      QTest::addColumn<bool>("snapshot");
+
+      QTest::newRow("parse") << false;
+      QTest::newRow("snapshot") << true;
+   }
+   /*!
+    * Measures loading a catalog of DEFAULT_CATALOG_ITEM_COUNT_ items, by either parsing the
+    * catalog file or decoding the catalog snapshot.
+    */
+   void loadCatalog()
+   {
+      QFETCH(bool, snapshot);
+
+      const auto& file = directory_.filePath(QStringLiteral("catalog.xml"));
+      if (!QFile::exists(file))
+      {
+         QVERIFY(writeFile(file, xmlDocument(DEFAULT_CATALOG_ITEM_COUNT_)));
+      }
+
+      if (!snapshot)
+      {
+         QBENCHMARK
+         {
+            const auto& content = readFile(file);
+
+            XmlItemSource itemSource;
+            QVERIFY(itemSource.read(content.constData(), content.size(), file));
+         }
+      }
+      else
+      {
+         const auto& content = readFile(file);
+
+         XmlItemSource itemSource;
+         QVERIFY(itemSource.read(content.constData(), content.size(), file));
+
+         QFileInfo fileInfo(file);
+
+         CatalogSnapshot::Dependency dependency;
+         dependency.file = fileInfo.canonicalFilePath();
+         dependency.identifier = file;
+         dependency.mimeType = QStringLiteral("text/xml");
+         dependency.size = fileInfo.size();
+         dependency.lastModified = fileInfo.lastModified();
+         dependency.hash = CatalogSnapshot::hash(content);
+
+         CatalogSnapshot catalogSnapshot(file);
+         QVERIFY(catalogSnapshot.write({&itemSource}, {dependency}));
+
+         QBENCHMARK
+         {
+            CatalogSnapshot readCatalogSnapshot(file);
+            QVERIFY2(readCatalogSnapshot.read(), qPrintable(readCatalogSnapshot.errorString()));
+         }
+
+         catalogSnapshot.remove();
+      }
+   }
+
+   /*!
+    * Provides the number of times each file is imported.
+    */
+   void loadImports_data()
+   {
+      QTest::addColumn<int>("importCount");
+
+      QTest::newRow("distinct") << 1;
+      QTest::newRow("duplicates") << DEFAULT_DUPLICATE_IMPORT_COUNT_;
+   }
+   /*!
+    * Measures loading a catalog importing DEFAULT_IMPORT_FILE_COUNT_ files, each imported
+    * either once or several times. As duplicate imports are detected before they are read, both
+    * should take about the same time.
+    */
+   void loadImports()
+   {
+      QFETCH(int, importCount);
+
+      QVERIFY(QDir(directory_.path()).mkpath(QStringLiteral("imports")));
+
+      QByteArray catalog = "<items>\n";
+
+      for (int file = 0; file < DEFAULT_IMPORT_FILE_COUNT_; ++file)
+      {
+         const auto& importFile = directory_.filePath(QStringLiteral("imports/import%1.xml").arg(file));
+         if (!QFile::exists(importFile))
+         {
+            QVERIFY(writeFile(importFile, xmlDocument(DEFAULT_IMPORT_ITEM_COUNT_)));
+         }
+
+         //
+         // Each duplicate is spelled differently, so it is just detected by its canonical path.
+         //
+
+         for (int import = 0; import < importCount; ++import)
+         {
+            const auto& importPath = directory_.filePath(QStringLiteral("imports") + QStringLiteral("/../imports").repeated(import) +
+                                                         QStringLiteral("/import%1.xml").arg(file));
+
+            catalog.append("   <import><file>" + importPath.toUtf8() + "</file></import>\n");
+         }
+      }
+
+      catalog.append("</items>\n");
+
+      const auto& catalogFile = directory_.filePath(QStringLiteral("imports.xml"));
+      QVERIFY(writeFile(catalogFile, catalog));
+
+      QBENCHMARK
+      {
+         ItemModel itemModel;
+         QSignalSpy sourcesLoadedSpy(&itemModel, &ItemModel::sourcesLoaded);
+
+         itemModel.read(catalogFile, ItemModel::ReadMode::IgnoreSnapshot);
+
+         QVERIFY((sourcesLoadedSpy.count() > 0) || (sourcesLoadedSpy.wait(DEFAULT_LOAD_TIMEOUT_)));
+      }
+   }
+
+   /*!
+    * Provides the depth of the trees traversed and the number of items per level.
+    */
+   void traverseItems_data()
+   {
+      QTest::addColumn<int>("depth");
+      QTest::addColumn<int>("width");
+
+      QTest::newRow("wide") << 1 << DEFAULT_TRAVERSAL_ITEM_COUNT_;
+      QTest::newRow("deep") << DEFAULT_TRAVERSAL_DEPTH_ << (DEFAULT_TRAVERSAL_ITEM_COUNT_ / DEFAULT_TRAVERSAL_DEPTH_);
+   }
+   /*!
+    * Measures applying a function to all link items of a tree, which is either a single group
+    * of items or a chain of nested groups (far deeper than any recursion would allow for).
+    */
+   void traverseItems()
+   {
+      QFETCH(int, depth);
+      QFETCH(int, width);
+
+      XmlItemSource itemSource;
+
+      GroupItem* parent = &itemSource;
+      for (int level = 0; level < depth; ++level)
+      {
+         if (level > 0)
+         {
+            auto groupItem = itemSource.createItem<LinkGroupItem>();
+            parent->insertItem(groupItem, parent->itemCount());
+
+            parent = groupItem;
+         }
+
+         for (int item = 0; item < width; ++item)
+         {
+            parent->insertItem(itemSource.createItem<LinkItem>(), parent->itemCount());
+         }
+      }
+
+      int itemCount = 0;
+
+      QBENCHMARK
+      {
+         itemCount = 0;
+
+         itemSource.apply<LinkItem>([&itemCount](LinkItem* /* item */)
+         {
+            ++itemCount;
+         });
+      }
+
+      QCOMPARE(itemCount, (depth * width));
+   }
+
+   /*!
+    * Provides whether the environment variables are resolved using the snapshot or by replacing
+    * each variable in turn.
+    */
+   void resolveProcessEnvironment_data()
+   {
+      QTest::addColumn<bool>("snapshot");
+
+      QTest::newRow("replace") << false;
+      QTest::newRow("snapshot") << true;
+   }
+   /*!
+    * Measures resolving the environment variables of DEFAULT_LINK_COUNT_ links, a quarter of
+    * them referring to a variable.
+    */
+   void resolveProcessEnvironment()
+   {
+      QFETCH(bool, snapshot);
+
+      qputenv("LAUNCHER_BENCHMARK_HOST", "example.com");
+
+      Item::updateProcessEnvironment();
+
+      QStringList links;
+      for (int link = 0; link < DEFAULT_LINK_COUNT_; ++link)
+      {
+         links.append(((link % 4) == 0) ? (QStringLiteral("https://{LAUNCHER_BENCHMARK_HOST}/%1/{0}").arg(link)) :
+                                          (QStringLiteral("https://example.com/%1/{0}").arg(link)));
+      }
+
+      QCOMPARE(ProcessEnvironmentItem::applyProcessEnvironment(links.first()),
+               applyProcessEnvironmentByReplacing(links.first(), QProcessEnvironment::systemEnvironment()));
+
+      int resolvedSize = 0;
+
+      if (snapshot)
+      {
+         QBENCHMARK
+         {
+            for (const auto& link : links)
+            {
+               resolvedSize += ProcessEnvironmentItem::applyProcessEnvironment(link).size();
+            }
+         }
+      }
+      else
+      {
+         //
+         // The process environment used to be copied for every link.
+         //
+
+         QBENCHMARK
+         {
+            for (const auto& link : links)
+            {
+               resolvedSize += applyProcessEnvironmentByReplacing(link, QProcessEnvironment::systemEnvironment()).size();
+            }
+         }
+      }
+
+      QVERIFY(resolvedSize > 0);
+   }
+
+   /*!
+    * Provides whether the links are expanded using the parsed links kept by the item source or
+    * are parsed every time.
+    */
+   void expandLinks_data()
+   {
+      QTest::addColumn<bool>("linkTemplates");
+
+      QTest::newRow("parse") << false;
+      QTest::newRow("template") << true;
+   }
+   /*!
+    * Measures expanding the parameters of DEFAULT_LINK_COUNT_ links. Link items not part of an
+    * item source parse their link every time.
+    */
+   void expandLinks()
+   {
+      QFETCH(bool, linkTemplates);
+
+      XmlItemSource itemSource;
+
+      QVector<LinkItem*> items;
+      for (int link = 0; link < DEFAULT_LINK_COUNT_; ++link)
+      {
+         auto item = itemSource.createItem<LinkItem>();
+         item->setLink(QStringLiteral("https://example.com/%1/{0}?q={%*}").arg(link));
+
+         if (linkTemplates)
+         {
+            itemSource.insertItem(item, itemSource.itemCount());
+         }
+
+         items.append(item);
+      }
+
+      const QStringList parameters = { QStringLiteral("first"), QStringLiteral("second & third") };
+
+      int expandedSize = 0;
+
+      QBENCHMARK
+      {
+         for (auto item : items)
+         {
+            expandedSize += item->link(parameters).size();
+         }
+      }
+
+      QVERIFY(expandedSize > 0);
+   }
+
+   /*!
+    * Measures the throughput of reading a CSV document of DEFAULT_PARSE_ITEM_COUNT_ items.
+    */
+   void readCsv()
+   {
+      const auto& document = csvDocument(DEFAULT_PARSE_ITEM_COUNT_);
+
+      qint64 readSize = 0;
+
+      QElapsedTimer readTimer;
+      readTimer.start();
+
+      QBENCHMARK
+      {
+         CsvItemSource itemSource;
+         QVERIFY2(itemSource.read(document.constData(), document.size(), QStringLiteral("document")), qPrintable(itemSource.errorString()));
+
+         readSize += document.size();
+      }
+
+      reportThroughput(readSize, readTimer.nsecsElapsed());
+   }
+
+   /*!
+    * Provides whether the JSON document is read by the item source or just parsed into a JSON
+    * document (for reference).
+    */
+   void readJson_data()
+   {
+      QTest::addColumn<bool>("itemSource");
+
+      QTest::newRow("document") << false;
+      QTest::newRow("itemSource") << true;
+   }
+   /*!
+    * Measures the throughput of reading a JSON document of DEFAULT_PARSE_ITEM_COUNT_ items.
+    */
+   void readJson()
+   {
+      QFETCH(bool, itemSource);
+
+      const auto& document = jsonDocument(DEFAULT_PARSE_ITEM_COUNT_);
+
+      qint64 readSize = 0;
+
+      QElapsedTimer readTimer;
+      readTimer.start();
+
+      if (itemSource)
+      {
+         QBENCHMARK
+         {
+            JsonItemSource jsonItemSource;
+            QVERIFY2(jsonItemSource.read(document.constData(), document.size(), QStringLiteral("document")), qPrintable(jsonItemSource.errorString()));
+
+            readSize += document.size();
+         }
+      }
+      else
+      {
+         QBENCHMARK
+         {
+            QJsonParseError parseError;
+            QVERIFY(!QJsonDocument::fromJson(document, &parseError).isNull());
+
+            readSize += document.size();
+         }
+      }
+
+      reportThroughput(readSize, readTimer.nsecsElapsed());
+   }
+
+   /*!
+    * Provides whether the import file is mapped into memory by the import item reader or read
+    * and copied into a buffer, as done before.
+    */
+   void readImport_data()
+   {
+      QTest::addColumn<bool>("mapped");
+
+      QTest::newRow("read") << false;
+      QTest::newRow("mapped") << true;
+   }
+   /*!
+    * Measures the throughput of reading an imported CSV file of DEFAULT_PARSE_ITEM_COUNT_ items,
+    * including the content hash recorded for the file.
+    */
+   void readImport()
+   {
+      QFETCH(bool, mapped);
+
+      const auto& file = directory_.filePath(QStringLiteral("import.csv"));
+      if (!QFile::exists(file))
+      {
+         QVERIFY(writeFile(file, csvDocument(DEFAULT_PARSE_ITEM_COUNT_)));
+      }
+
+      const auto fileSize = QFileInfo(file).size();
+
+      qint64 readSize = 0;
+
+      QElapsedTimer readTimer;
+      readTimer.start();
+
+      if (mapped)
+      {
+         QBENCHMARK
+         {
+            ImportItemReader importItemReader(ImportItem(file, QStringLiteral("text/csv")), std::unique_ptr<ItemSource>(new CsvItemSource), QUuid());
+            QSignalSpy sourceLoadedSpy(&importItemReader, &ImportItemReader::sourceLoaded);
+
+            importItemReader.run();
+
+            QCOMPARE(sourceLoadedSpy.count(), 1);
+
+            readSize += fileSize;
+         }
+      }
+      else
+      {
+         QBENCHMARK
+         {
+            QFile importFile(file);
+            QVERIFY(importFile.open(QIODevice::ReadOnly | QIODevice::Text));
+
+            auto fileContent = importFile.readAll();
+            QVERIFY(!CatalogSnapshot::hash(fileContent).isEmpty());
+
+            QBuffer fileBuffer(&fileContent);
+            fileBuffer.open(QIODevice::ReadOnly);
+
+            CsvItemSource itemSource;
+            QVERIFY(itemSource.read(&fileBuffer, file));
+
+            readSize += fileSize;
+         }
+      }
+
+      reportThroughput(readSize, readTimer.nsecsElapsed());
+   }
+
+   /*!
+    * Provides the number of threads the XML document is read by, where 0 refers to the
+    * general-purpose reader (for reference).
+    */
+   void readXmlConcurrently_data()
+   {
+      QTest::addColumn<int>("threadCount");
+
+      QTest::newRow("XmlItemSource") << 0;
+
+      for (int threadCount = 1; threadCount <= DEFAULT_MAXIMUM_THREAD_COUNT_; threadCount *= 2)
+      {
+         QTest::newRow(QByteArray::number(threadCount).append((threadCount == 1) ? (" thread") : (" threads")).constData()) << threadCount;
+      }
+   }
+   /*!
+    * Measures the throughput of reading an XML document of DEFAULT_PARSE_ITEM_COUNT_ items, which
+    * exceeds the size from which documents are read concurrently, and the speedup over reading
+    * it by a single thread.
+    */
+   void readXmlConcurrently()
+   {
+      QFETCH(int, threadCount);
+
+      const auto& document = xmlDocument(DEFAULT_PARSE_ITEM_COUNT_);
+      QVERIFY(document.size() >= DEFAULT_CONCURRENT_READ_SIZE_);
+
+      FastXmlItemSource::setThreadCount(qMax(threadCount, 1));
+
+      qint64 readSize = 0;
+      qint64 readCount = 0;
+
+      QElapsedTimer readTimer;
+      readTimer.start();
+
+      QBENCHMARK
+      {
+         std::unique_ptr<XmlItemSource> itemSource((threadCount > 0) ? (new FastXmlItemSource) : (new XmlItemSource));
+         QVERIFY2(itemSource->read(document.constData(), document.size(), QStringLiteral("document")), qPrintable(itemSource->errorString()));
+
+         readSize += document.size();
+         readCount += 1;
+      }
+
+      const auto readTime = readTimer.nsecsElapsed();
+
+      FastXmlItemSource::setThreadCount(1);
+
+      reportThroughput(readSize, readTime);
+
+      if (threadCount == 1)
+      {
+         singleThreadReadTime_ = (readTime / readCount);
+      }
+      else if ((threadCount > 1) && (singleThreadReadTime_ > 0))
+      {
+         qInfo() << "speedup" << (static_cast<double>(singleThreadReadTime_) / (readTime / readCount));
+      }
+   }
+
+   /*!
+    * Provides the number of rows of the database and the search expression searched for, which
+    * matches either most rows, few rows or a tag.
+    */
+   void searchDatabase_data()
+   {
+      QTest::addColumn<int>("rowCount");
+      QTest::addColumn<QString>("expression");
+
+      for (auto rowCount : { DEFAULT_DATABASE_ROW_COUNT_, DEFAULT_LARGE_DATABASE_ROW_COUNT_ })
+      {
+         const auto& rowCountName = QByteArray::number(rowCount / 1000000).append("M rows");
+
+         QTest::newRow(QByteArray(rowCountName).append("/common").constData()) << rowCount << QStringLiteral("Item");
+         QTest::newRow(QByteArray(rowCountName).append("/rare").constData()) << rowCount << QStringLiteral("999999");
+         QTest::newRow(QByteArray(rowCountName).append("/tag").constData()) << rowCount << QStringLiteral("@tag3");
+         QTest::newRow(QByteArray(rowCountName).append("/scan").constData()) << rowCount << QStringLiteral("@g3");
+      }
+   }
+   /*!
+    * Measures the latency of searching a database of \a rowCount rows, including the creation
+    * of the items matching.
+    */
+   void searchDatabase()
+   {
+      QFETCH(int, rowCount);
+      QFETCH(QString, expression);
+
+      if ((rowCount > DEFAULT_DATABASE_ROW_COUNT_) && (qEnvironmentVariableIsEmpty("LAUNCHER_LARGE_BENCHMARKS")))
+      {
+         QSKIP("Set LAUNCHER_LARGE_BENCHMARKS to search the large database");
+      }
+
+      const auto& file = directory_.filePath(QStringLiteral("items%1.sqlite").arg(rowCount));
+      if (!QFile::exists(file))
+      {
+         QVERIFY(createDatabase(file, rowCount));
+      }
+
+      //
+      // The item source is passed just the header of the database, as by the import item reader.
+      //
+
+      SqliteItemSource itemSource;
+
+      QFile databaseFile(file);
+      QVERIFY(databaseFile.open(QIODevice::ReadOnly));
+
+      const auto& header = databaseFile.read(itemSource.readSize());
+      QVERIFY2(itemSource.read(header.constData(), header.size(), file), qPrintable(itemSource.errorString()));
+
+      SearchExpression searchExpression(expression, SearchExpression::TermImplicitMatch);
+
+      int itemCount = 0;
+
+      QBENCHMARK
+      {
+         itemSource.reset();
+
+         itemCount = itemSource.search(searchExpression).size();
+      }
+
+      qInfo() << "items" << itemCount;
+
+      QVERIFY(itemCount > 0);
+   }
+
+   /*!
+    * Provides whether the result view paints its rows using the item delegate or the default
+    * delegate (for reference).
+    */
+   void scrollResults_data()
+   {
+      QTest::addColumn<bool>("itemDelegate");
+
+      QTest::newRow("QStyledItemDelegate") << false;
+      QTest::newRow("ItemDelegate") << true;
+   }
+   /*!
+    * Measures the time of a frame when scrolling the result view by a page, that is the time it
+    * takes to paint a page of rows which have not been painted before.
+    */
+   void scrollResults()
+   {
+      QFETCH(bool, itemDelegate);
+
+      QStandardItemModel resultModel(DEFAULT_RESULT_ROW_COUNT_, 2);
+      for (int row = 0; row < DEFAULT_RESULT_ROW_COUNT_; ++row)
+      {
+         resultModel.setData(resultModel.index(row, 0), QStringLiteral("Item %1 with a name long enough to be elided in the result view").arg(row));
+         resultModel.setData(resultModel.index(row, 1), QStringLiteral("tag%1, shared").arg(row % 7));
+      }
+
+      SearchResultWidget resultWidget;
+      resultWidget.setUniformRowHeights(true);
+      resultWidget.setItemDelegate((itemDelegate) ? (new ItemDelegate(&resultWidget)) : (new QStyledItemDelegate(&resultWidget)));
+      resultWidget.setModel(&resultModel);
+      resultWidget.resize(DEFAULT_RESULT_VIEW_SIZE_);
+      resultWidget.show();
+
+      QVERIFY(QTest::qWaitForWindowExposed(&resultWidget));
+
+      auto scrollBar = resultWidget.verticalScrollBar();
+
+      QBENCHMARK
+      {
+         scrollBar->setValue((scrollBar->value() + scrollBar->pageStep()) % scrollBar->maximum());
+
+         resultWidget.viewport()->repaint();
+      }
+   }
+
+   /*!
+    * Measures the time from the search window being shown, as it is when the hotkey has been
+    * received, to the search window being painted, with a catalog of DEFAULT_CATALOG_ITEM_COUNT_
+    * items loaded, and reports whether the median stays within DEFAULT_HOTKEY_LATENCY_TARGET_.
+    */
+   void showSearchWindow()
+   {
+      const auto& file = directory_.filePath(QStringLiteral("catalog.xml"));
+      if (!QFile::exists(file))
+      {
+         QVERIFY(writeFile(file, xmlDocument(DEFAULT_CATALOG_ITEM_COUNT_)));
+      }
+
+      ItemModel itemModel;
+      QSignalSpy sourcesLoadedSpy(&itemModel, &ItemModel::sourcesLoaded);
+
+      itemModel.read(file, ItemModel::ReadMode::IgnoreSnapshot);
+
+      QVERIFY((sourcesLoadedSpy.count() > 0) || (sourcesLoadedSpy.wait(DEFAULT_LOAD_TIMEOUT_)));
+
+      SearchWindow searchWindow(&itemModel);
+
+      //
+      // The search window is shown once beforehand, as it is created and polished once at startup
+      // but shown and hidden whenever the hotkey is pressed.
+      //
+
+      searchWindow.show();
+      QVERIFY(QTest::qWaitForWindowExposed(&searchWindow));
+      searchWindow.hide();
+      QCoreApplication::processEvents();
+
+      PaintLatencyFilter paintLatencyFilter;
+      searchWindow.installEventFilter(&paintLatencyFilter);
+
+      QVector<qint64> latencies;
+      latencies.reserve(DEFAULT_HOTKEY_SAMPLE_COUNT_);
+
+      for (int sample = 0; sample < DEFAULT_HOTKEY_SAMPLE_COUNT_; ++sample)
+      {
+         paintLatencyFilter.start();
+
+         searchWindow.showNormal();
+
+         QTRY_VERIFY_WITH_TIMEOUT((paintLatencyFilter.latency() >= 0), DEFAULT_LOAD_TIMEOUT_);
+
+         latencies.append(paintLatencyFilter.latency());
+
+         searchWindow.hide();
+         QCoreApplication::processEvents();
+      }
+
+      std::sort(latencies.begin(), latencies.end());
+
+      const auto latency = (latencies.at(latencies.size() / 2) / 1000000.0);
+
+      QTest::setBenchmarkResult(latency, QTest::WalltimeMilliseconds);
+
+      qInfo() << "hotkey latency" << latency << "ms, target" << DEFAULT_HOTKEY_LATENCY_TARGET_ << "ms";
+
+      if (latency > DEFAULT_HOTKEY_LATENCY_TARGET_)
+      {
+         qWarning() << "hotkey latency exceeds target by" << (latency - DEFAULT_HOTKEY_LATENCY_TARGET_) << "ms";
+      }
+   }
+
+private:
+   /*!
+    * The directory the inputs are generated into.
+    */
+   QTemporaryDir directory_;
+
+   /*!
+    * The time it takes a single thread to read the XML document, in nanoseconds, or 0 if not
+    * yet measured.
+    */
+   qint64 singleThreadReadTime_ = 0;
+};
+
+int main(int argc, char* argv[])
+{
+   //
+   // The benchmarks use the application, but neither its settings nor its cache.
+   //
+
+   QStandardPaths::setTestModeEnabled(true);
+
+   Application application(argc, argv);
+
+   TestBenchmarks benchmarks;
+   return QTest::qExec(&benchmarks, argc, argv);
+}
+
+#include "tst_benchmarks.moc"
@@ -0,0 +1,510 @@
+/*!
+ * \file tst_fastxmlitemsource.cpp
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#include <random>
+
+#include <QByteArray>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QtTest>
+
+#include "fastxmlitemsource.h"
+#include "importgroupitem.h"
+#include "importitem.h"
+#include "linkgroupitem.h"
+#include "linkitem.h"
+#include "xmlitemsource.h"
+
+namespace {
+
+/*!
+ * The number of mutated documents derived from each document of the corpus.
+ */
+static const int DEFAULT_MUTATION_COUNT_ = 64;
+/*!
+ * The number of mutated documents derived from the large document.
+ */
+static const int DEFAULT_LARGE_MUTATION_COUNT_ = 8;
+/*!
+ * The seed of the mutations, so the very same documents are read on every run.
+ */
+static const std::mt19937::result_type DEFAULT_MUTATION_SEED_ = 2016;
+
+/*!
+ * The number of items of the large document, which exceeds the size read concurrently.
+ */
+static const int DEFAULT_LARGE_DOCUMENT_ITEM_COUNT_ = 120000;
+/*!
+ * The number of items per group of the large document.
+ */
+static const int DEFAULT_LARGE_DOCUMENT_GROUP_SIZE_ = 16;
+/*!
+ * The size from which documents are read concurrently.
+ */
+static const int DEFAULT_CONCURRENT_READ_SIZE_ = (8 * 1024 * 1024);
+/*!
+ * The number of threads the large document is read by.
+ */
+static const int DEFAULT_THREAD_COUNT_ = 4;
+
+/*!
+ * Returns the documents read by both item sources, along with their names.
+ */
+QList<QPair<QByteArray, QByteArray>> corpus()
+{
+   QList<QPair<QByteArray, QByteArray>> documents;
+
+   documents.append({"empty", "<items/>"});
+   documents.append({"declaration",
+                     "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                     "<items>\n"
+                     "   <item>\n"
+                     "      <name>Name</name>\n"
+                     "      <url>http://example.com/{0}</url>\n"
+                     "      <color>#ff0000</color>\n"
+                     "      <tag>first</tag>\n"
+                     "      <tag>second</tag>\n"
+                     "   </item>\n"
+                     "</items>\n"});
+   documents.append({"groups",
+                     "<items>\n"
+                     "   <group>\n"
+                     "      <name>Outer</name>\n"
+                     "      <color>blue</color>\n"
+                     "      <tag>outer</tag>\n"
+                     "      <item><name>A</name><url>http://a/{*}</url></item>\n"
+                     "      <group>\n"
+                     "         <name>Inner</name>\n"
+                     "         <item><name>B</name><url>http://b/{%0}/{1}</url><color>green</color></item>\n"
+                     "         <group><name>Innermost</name><item><name>C</name><url>c</url></item></group>\n"
+                     "      </group>\n"
+                     "      <item><name>D</name><url>http://d</url><tag>d</tag></item>\n"
+                     "   </group>\n"
+                     "   <item><name>E</name><url>http://e</url></item>\n"
+                     "</items>\n"});
+   documents.append({"entities",
+                     "<items>\n"
+                     "   <item>\n"
+                     "      <name>A &amp; B &lt;&gt; &quot;&apos;</name>\n"
+                     "      <url>http://example.com/?a=1&amp;b=2&#38;c=&#x33;</url>\n"
+                     "      <tag>&#228;&#x1F600;</tag>\n"
+                     "   </item>\n"
+                     "</items>\n"});
+   documents.append({"characterData",
+                     "<items>\n"
+                     "   <item>\n"
+                     "      <name><![CDATA[<Name> & more]]></name>\n"
+                     "      <url>http://example.com/<![CDATA[?a=<1>&b=2]]>/{0}</url>\n"
+                     "   </item>\n"
+                     "</items>\n"});
+   documents.append({"comments",
+                     "<!-- leading comment -->\n"
+                     "<items>\n"
+                     "   <!-- <item><name>Commented</name></item> -->\n"
+                     "   <item>\n"
+                     "      <name>Na<!-- within -->me</name>\n"
+                     "      <url><!-- before -->http://example.com<!-- after --></url>\n"
+                     "   </item>\n"
+                     "</items>\n"
+                     "<!-- trailing comment -->\n"});
+   documents.append({"processingInstructions",
+                     "<?xml version=\"1.0\"?>\n"
+                     "<?launcher first?>\n"
+                     "<items>\n"
+                     "   <?launcher second?>\n"
+                     "   <item><name>Na<?launcher third?>me</name><url>http://example.com</url></item>\n"
+                     "</items>\n"});
+   documents.append({"imports",
+                     "<items>\n"
+                     "   <import>\n"
+                     "      <file>first.xml</file>\n"
+                     "      <file contentType=\" text/csv \" contentEncoding=\"GZIP\">second.csv.gz</file>\n"
+                     "      <file contentType='application/json'>  third.json  </file>\n"
+                     "      <other>ignored</other>\n"
+                     "   </import>\n"
+                     "   <import/>\n"
+                     "</items>\n"});
+   documents.append({"carriageReturns",
+                     "<items>\r\n"
+                     "   <item>\r\n"
+                     "      <name>Name</name>\r\n"
+                     "      <url>http://example.com/\r\nsecond line</url>\r\n"
+                     "   </item>\r\n"
+                     "   <item><name>Other</name>\r<url>http://example.com/other</url></item>\r\n"
+                     "</items>\r\n"});
+   documents.append({"multibyte",
+                     "<items>\n"
+                     "   <item><name>\xc3\xa4\xc3\xb6\xc3\xbc</name><url>http://example.com/\xc3\xa4</url></item>\n"
+                     "   <item><name>\xe6\x97\xa5\xe6\x9c\xac</name><url>http://\xe6\x97\xa5\xe6\x9c\xac.example.com</url></item>\n"
+                     "   <item><name>\xf0\x9f\x98\x80</name><url>\xf0\x9f\x98\x80/{0}</url><tag>\xf0\x9f\x98\x80</tag></item>\n"
+                     "</items>\n"});
+   documents.append({"byteOrderMark",
+                     "\xef\xbb\xbf<items><item><name>Name</name><url>http://example.com</url></item></items>"});
+   documents.append({"emptyElements",
+                     "<items>\n"
+                     "   <item/>\n"
+                     "   <item><name/><url/><color/><tag/></item>\n"
+                     "   <group/>\n"
+                     "   <group><name></name><item></item></group>\n"
+                     "</items>\n"});
+   documents.append({"unknownElements",
+                     "<items>\n"
+                     "   <unknown><item><name>Hidden</name><url>hidden</url></item></unknown>\n"
+                     "   <item>\n"
+                     "      <other a=\"1\"><name>Hidden</name><deeper/></other>\n"
+                     "      <name>Name</name>\n"
+                     "      <url>http://example.com</url>\n"
+                     "   </item>\n"
+                     "   <group><other/><name>Group</name></group>\n"
+                     "</items>\n"});
+   documents.append({"whitespace",
+                     "<items>\n"
+                     "   <item>\n"
+                     "      <name>\n         Name  \t\n      </name>\n"
+                     "      <url>  http://example.com  </url>\n"
+                     "      <color>  red  </color>\n"
+                     "      <tag>  tag  </tag>\n"
+                     "   </item>\n"
+                     "</items>\n"});
+   documents.append({"attributes",
+                     "<items version=\"1\">\n"
+                     "   <item id=\"a&gt;b\" note='\"quoted\"' >\n"
+                     "      <name lang = \"en\">Name</name>\n"
+                     "      <url\n         kind=\"web\">http://example.com</url>\n"
+                     "   </item>\n"
+                     "</items>\n"});
+   documents.append({"documentType",
+                     "<?xml version=\"1.0\"?>\n"
+                     "<!DOCTYPE items>\n"
+                     "<items><item><name>Name</name><url>http://example.com</url></item></items>\n"});
+   documents.append({"documentTypeEntity",
+                     "<?xml version=\"1.0\"?>\n"
+                     "<!DOCTYPE items [\n"
+                     "   <!ENTITY host \"example.com\">\n"
+                     "]>\n"
+                     "<items><item><name>Name</name><url>http://&host;/{0}</url></item></items>\n"});
+   documents.append({"latin1",
+                     "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n"
+                     "<items><item><name>\xe4\xf6\xfc</name><url>http://example.com/\xe4</url></item></items>\n"});
+   documents.append({"singleLine",
+                     "<items><item><name>A</name><url>a</url></item><item><name>B</name><url>b</url></item>"
+                     "<group><name>G</name><item><name>C</name><url>c</url></item></group>"
+                     "<item><name>D</name><url>d</url></item></items>"});
+   documents.append({"noRootElement", "<other><item><name>Name</name><url>url</url></item></other>"});
+   documents.append({"noElement", "<!-- just a comment -->"});
+   documents.append({"extraContent", "<items><item><name>Name</name><url>url</url></item></items><items/>"});
+   documents.append({"tagMismatch", "<items><item><name>Name</url></item></items>"});
+   documents.append({"undefinedEntity", "<items><item><name>&undefined;</name><url>url</url></item></items>"});
+   documents.append({"invalidCharacterReference", "<items><item><name>&#xZZ;</name><url>url</url></item></items>"});
+   documents.append({"unterminatedComment", "<items><!-- <item><name>Name</name></item></items>"});
+   documents.append({"unterminatedCharacterData", "<items><item><name><![CDATA[Name</name></item></items>"});
+   documents.append({"prematureEnd", "<items>\n   <item>\n      <name>Name</name>\n"});
+
+   return documents;
+}
+
+/*!
+ * Returns the large document, which is read concurrently.
+ */
+QByteArray largeDocument()
+{
+   QByteArray document;
+   document.append("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<items>\n");
+
+   for (int item = 0; item < DEFAULT_LARGE_DOCUMENT_ITEM_COUNT_; ++item)
+   {
+      const auto& itemNumber = QByteArray::number(item);
+
+      if ((item % DEFAULT_LARGE_DOCUMENT_GROUP_SIZE_) == 0)
+      {
+         if (item > 0)
+         {
+            document.append("   </group>\n");
+         }
+
+         document.append("   <group>\n      <name>Group " + itemNumber + "</name>\n      <color>#00" + QByteArray::number(item % 256, 16).rightJustified(2, '0') + "00</color>\n");
+      }
+
+      document.append("      <item>\n");
+      document.append("         <name>Item " + itemNumber + " &amp; \xc3\xa4</name>\n");
+      document.append("         <url>http://example.com/" + itemNumber + "/{0}?q={%*}</url>\n");
+      document.append("         <tag>tag" + QByteArray::number(item % 7) + "</tag>\n");
+      document.append("      </item>\n");
+
+      if ((item % 1000) == 0)
+      {
+         document.append("   <!-- " + itemNumber + " -->\n   <import><file>" + itemNumber + ".xml</file></import>\n");
+      }
+   }
+
+   document.append("   </group>\n</items>\n");
+
+   return document;
+}
+
+/*!
+ * Returns the document \a document mutated by a single random change drawn from \a generator,
+ * which either truncates the document, or deletes, inserts or replaces a character. Multibyte
+ * UTF-8 sequences are never split, except by truncating the document.
+ */
+QByteArray mutate(const QByteArray& document, std::mt19937* generator)
+{
+   static const char characters[] = "<>/&;=\"' \n\r\t!?-[]#xa";
+
+   std::uniform_int_distribution<int> mutationDistribution(0, 3);
+   std::uniform_int_distribution<int> positionDistribution(0, document.size() - 1);
+   std::uniform_int_distribution<int> characterDistribution(0, sizeof(characters) - 2);
+
+   auto mutation = mutationDistribution(*generator);
+   auto position = positionDistribution(*generator);
+   auto character = characters[characterDistribution(*generator)];
+
+   auto mutatedDocument = document;
+
+   if (mutation == 0)
+   {
+      mutatedDocument.truncate(position);
+   }
+   else
+   {
+      for (; ((position < mutatedDocument.size()) && (static_cast<quint8>(mutatedDocument[position]) >= 0x80)); ++position)
+      {
+      }
+
+      if (mutation == 1)
+      {
+         mutatedDocument.remove(position, 1);
+      }
+      else if (mutation == 2)
+      {
+         mutatedDocument.insert(position, character);
+      }
+      else if (position < mutatedDocument.size())
+      {
+         mutatedDocument[position] = character;
+      }
+   }
+
+   return mutatedDocument;
+}
+
+/*!
+ * Appends a description of the items of the group item \a groupItem, indented by \a depth, to
+ * \a description.
+ */
+void describeItems(const GroupItem* groupItem, int depth, QStringList* description)
+{
+   const auto indent = QString((depth * 3), QLatin1Char(' '));
+
+   for (auto item : groupItem->items())
+   {
+      switch (item->type())
+      {
+      case Item::Type::Link:
+      {
+         auto linkItem = static_cast<const LinkItem*>(item);
+         auto linkPosition = linkItem->linkPosition();
+
+         description->append(indent + QStringLiteral("link \"%1\" \"%2\" %3:%4:%5 %6 \"%7\"").arg(linkItem->name(), linkItem->link(),
+                                                                                                  QString::number(linkPosition.lineNumber()),
+                                                                                                  QString::number(linkPosition.columnNumber()),
+                                                                                                  QString::number(linkPosition.size()),
+                                                                                                  QString::number(linkItem->brushIndex()),
+                                                                                                  linkItem->tags().join(QStringLiteral("\", \""))));
+         break;
+      }
+      case Item::Type::LinkGroup:
+      {
+         auto linkGroupItem = static_cast<const LinkGroupItem*>(item);
+
+         description->append(indent + QStringLiteral("group \"%1\" %2 \"%3\"").arg(linkGroupItem->name(),
+                                                                                    QString::number(linkGroupItem->brushIndex()),
+                                                                                    linkGroupItem->tags().join(QStringLiteral("\", \""))));
+
+         describeItems(linkGroupItem, (depth + 1), description);
+         break;
+      }
+      case Item::Type::ImportGroup:
+      {
+         description->append(indent + QStringLiteral("import"));
+
+         describeItems(static_cast<const ImportGroupItem*>(item), (depth + 1), description);
+         break;
+      }
+      case Item::Type::Import:
+      {
+         auto importItem = static_cast<const ImportItem*>(item);
+
+         description->append(indent + QStringLiteral("file \"%1\" \"%2\" \"%3\"").arg(importItem->file(), importItem->mimeType(), importItem->contentEncoding()));
+         break;
+      }
+      default:
+      {
+         description->append(indent + QStringLiteral("item %1").arg(static_cast<int>(item->type())));
+         break;
+      }
+      }
+   }
+}
+
+/*!
+ * Reads the document \a document using the item source \a itemSource and returns a description
+ * of the items read, or of the error if the document could not be read.
+ */
+QStringList read(ItemSource* itemSource, const QByteArray& document)
+{
+   QStringList description;
+
+   if (itemSource->read(document.constData(), document.size(), QStringLiteral("document")))
+   {
+      description.append(QStringLiteral("read"));
+
+      describeItems(itemSource, 0, &description);
+   }
+   else
+   {
+      description.append(QStringLiteral("error \"%1\" %2:%3").arg(itemSource->errorString(),
+                                                                   QString::number(itemSource->errorPosition().x()),
+                                                                   QString::number(itemSource->errorPosition().y())));
+   }
+
+   return description;
+}
+
+/*!
+ * Reads the document \a document using both the FastXmlItemSource and the XmlItemSource and
+ * verifies that the items read, including their link positions, or the errors are identical.
+ */
+void compareItemSources(const QByteArray& document)
+{
+   FastXmlItemSource fastXmlItemSource;
+   const auto& fastDescription = read(&fastXmlItemSource, document);
+
+   XmlItemSource xmlItemSource;
+   const auto& description = read(&xmlItemSource, document);
+
+   for (int line = 0; line < qMin(fastDescription.size(), description.size()); ++line)
+   {
+      QCOMPARE(fastDescription.at(line), description.at(line));
+   }
+
+   QCOMPARE(fastDescription.size(), description.size());
+}
+
+} // namespace
+
+/*!
+ * \brief Verifies that the FastXmlItemSource reads documents just like the XmlItemSource.
+ */
+class TestFastXmlItemSource : public QObject
+{
+   Q_OBJECT
+
+private slots:
+   /*!
+    * Restores the number of threads used to read a single document.
+    */
+   void cleanup()
+   {
+      FastXmlItemSource::setThreadCount(1);
+   }
+
+   /*!
+    * Provides the documents of the corpus.
+    */
+   void readCorpus_data()
+   {
+      QTest::addColumn<QByteArray>("document");
+
+      for (const auto& document : corpus())
+      {
+         QTest::newRow(document.first.constData()) << document.second;
+      }
+   }
+   /*!
+    * Verifies that the documents of the corpus are read identically.
+    */
+   void readCorpus()
+   {
+      QFETCH(QByteArray, document);
+
+      compareItemSources(document);
+   }
+
+   /*!
+    * Provides the mutated documents of the corpus.
+    */
+   void readMutated_data()
+   {
+      QTest::addColumn<QByteArray>("document");
+
+      std::mt19937 generator(DEFAULT_MUTATION_SEED_);
+
+      for (const auto& document : corpus())
+      {
+         for (int mutation = 0; mutation < DEFAULT_MUTATION_COUNT_; ++mutation)
+         {
+            QTest::newRow((document.first + '/' + QByteArray::number(mutation)).constData()) << mutate(document.second, &generator);
+         }
+      }
+   }
+   /*!
+    * Verifies that the mutated documents of the corpus are read identically, failing with the
+    * same error at the same position.
+    */
+   void readMutated()
+   {
+      QFETCH(QByteArray, document);
+
+      compareItemSources(document);
+   }
+
+   /*!
+    * Provides the large document, along with mutations of it, and the number of threads it is
+    * read by.
+    */
+   void readLarge_data()
+   {
+      QTest::addColumn<QByteArray>("document");
+      QTest::addColumn<int>("threadCount");
+
+      const auto& document = largeDocument();
+
+      QVERIFY(document.size() >= DEFAULT_CONCURRENT_READ_SIZE_);
+
+      QTest::newRow("sequential") << document << 1;
+      QTest::newRow("concurrent") << document << DEFAULT_THREAD_COUNT_;
+
+      std::mt19937 generator(DEFAULT_MUTATION_SEED_);
+
+      for (int mutation = 0; mutation < DEFAULT_LARGE_MUTATION_COUNT_; ++mutation)
+      {
+         QTest::newRow(("concurrent/" + QByteArray::number(mutation)).constData()) << mutate(document, &generator) << DEFAULT_THREAD_COUNT_;
+      }
+   }
+   /*!
+    * Verifies that the large document is read identically, no matter whether it is read
+    * sequentially or concurrently.
+    */
+   void readLarge()
+   {
+      QFETCH(QByteArray, document);
+      QFETCH(int, threadCount);
+
+      FastXmlItemSource::setThreadCount(threadCount);
+
+      compareItemSources(document);
+   }
+};
+
+QTEST_GUILESS_MAIN(TestFastXmlItemSource)
+
+#include "tst_fastxmlitemsource.moc"
@@ -0,0 +1,15 @@
+#
+# \file linkitem.pro
+#
+# \copyright 2016 Lukas Geyer. All rights reseverd.
+# \license This program is free software; you can redistribute it and/or modify
+#          it under the terms of the GNU General Public License version 3 as
+#          published by the Free Software Foundation.
+#
+
+include(../tests.pri)
+
+TARGET = tst_linkitem
+
+SOURCES += \
+    tst_linkitem.cpp
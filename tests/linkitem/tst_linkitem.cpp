@@ -0,0 +1,114 @@
+/*!
+ * \file tst_linkitem.cpp
+ *
+ * \copyright 2016 Lukas Geyer. All rights reseverd.
+ * \license This program is free software; you can redistribute it and/or modify
+ *          it under the terms of the GNU General Public License version 3 as
+ *          published by the Free Software Foundation.
+ */
+
+#include <cstddef>
+
+#include <QSet>
+#include <QString>
+#include <QtTest>
+
+#include "itempalette.h"
+#include "itemsourcestatistics.h"
+#include "linkgroupitem.h"
+#include "linkitem.h"
+#include "stringpool.h"
+#include "xmlitemsource.h"
+
+namespace {
+
+/*!
+ * The number of link items the bytes per item are measured for.
+ */
+static const int DEFAULT_ITEM_COUNT_ = 1000000;
+/*!
+ * The number of distinct tags attached to the link items.
+ */
+static const int DEFAULT_TAG_COUNT_ = 16;
+
+/*!
+ * The colors of the link items.
+ */
+static const char* DEFAULT_COLORS_[] = { "red", "green", "blue", "#ff8000", "#0080ff", "#808080", "black", "white" };
+
+} // namespace
+
+/*!
+ * \brief Reports the size of link items and verifies that they stay within their budget.
+ */
+class TestLinkItem : public QObject
+{
+   Q_OBJECT
+
+private slots:
+   /*!
+    * Reports the size of the items and verifies that a link item stays within its budget.
+    */
+   void itemSize()
+   {
+      qInfo() << "sizeof(Item)" << sizeof(Item);
+      qInfo() << "sizeof(LinkItem)" << sizeof(LinkItem);
+      qInfo() << "sizeof(LinkGroupItem)" << sizeof(LinkGroupItem);
+      qInfo() << "sizeof(ItemSourcePosition)" << sizeof(ItemSourcePosition);
+
+      QVERIFY(sizeof(LinkItem) <= (sizeof(Item) + (3 * sizeof(void*)) + 24));
+   }
+
+   /*!
+    * Reports the bytes per link item for an item source of a million items, each with a
+    * distinct name and link, a shared color and a shared tag, and verifies that colors and tags
+    * are stored once and the items are allocated without overhead.
+    */
+   void bytesPerItem()
+   {
+      const auto paletteCount = ItemPalette::count();
+
+      XmlItemSource itemSource;
+
+      for (int itemIndex = 0; itemIndex < DEFAULT_ITEM_COUNT_; ++itemIndex)
+      {
+         auto item = itemSource.createItem<LinkItem>();
+         item->setName(QStringLiteral("Item %1").arg(itemIndex));
+         item->setLink(QStringLiteral("http://example.com/%1/{0}").arg(itemIndex));
+         item->setBrushIndex(ItemPalette::index(QString::fromLatin1(DEFAULT_COLORS_[itemIndex % (sizeof(DEFAULT_COLORS_) / sizeof(DEFAULT_COLORS_[0]))])));
+         item->appendTag(StringPool::intern(QStringLiteral("tag%1").arg(itemIndex % DEFAULT_TAG_COUNT_)));
+
+         itemSource.appendItem(&itemSource, item);
+      }
+
+      QSet<const void*> strings;
+      const auto& statistics = ItemSourceStatistics::collect(&itemSource, &strings);
+
+      const auto itemCount = statistics.itemCount[static_cast<std::size_t>(Item::Type::Link)];
+
+      qInfo() << "link items" << itemCount;
+      qInfo() << "arena bytes per item" << (static_cast<double>(statistics.arenaSize) / itemCount);
+      qInfo() << "string bytes per item" << (static_cast<double>(statistics.stringSize) / itemCount);
+      qInfo() << "container bytes per item" << (static_cast<double>(statistics.containerSize) / itemCount);
+      qInfo() << "heap bytes per item" << (static_cast<double>(statistics.size()) / itemCount);
+
+      QCOMPARE(itemCount, static_cast<std::size_t>(DEFAULT_ITEM_COUNT_));
+
+      //
+      // The items are allocated from the arena back to back, and any name and link is distinct,
+      // whereas each color and tag is stored just once.
+      //
+
+      QCOMPARE(statistics.heapSize, static_cast<std::size_t>(0));
+      QVERIFY((statistics.arenaSize / itemCount) <= (sizeof(LinkItem) + alignof(LinkItem)));
+
+      QVERIFY(ItemPalette::count() <= (paletteCount + static_cast<int>(sizeof(DEFAULT_COLORS_) / sizeof(DEFAULT_COLORS_[0]))));
+
+      QCOMPARE(statistics.tagCount, static_cast<std::size_t>(DEFAULT_ITEM_COUNT_));
+      QVERIFY(statistics.stringCount <= static_cast<std::size_t>((2 * DEFAULT_ITEM_COUNT_) + DEFAULT_TAG_COUNT_));
+   }
+};
+
+QTEST_GUILESS_MAIN(TestLinkItem)
+
+#include "tst_linkitem.moc"
@@ -0,0 +1,49 @@
+#
+# \file tests.pri
+#
+# \copyright 2016 Lukas Geyer. All rights reseverd.
+# \license This program is free software; you can redistribute it and/or modify
+#          it under the terms of the GNU General Public License version 3 as
+#          published by the Free Software Foundation.
+#
+
+#
+# The tests are built against the sources of the launcher (except for its entry point), so they
+# share its configuration.
+#
+
+QT += core gui widgets sql testlib
+
+TEMPLATE = app
+
+QMAKE_TARGET_PRODUCT = "Launcher"
+QMAKE_TARGET_COMPANY = "Lukas Geyer"
+QMAKE_TARGET_DOMAIN = "https://github.com/lukasgeyer/launcher"
+
+CONFIG += c++11 warn_on testcase
+CONFIG -= app_bundle
+
+DEFINES += APPLICATION_NAME=\\\"\"$$QMAKE_TARGET_PRODUCT\\\"\"
+DEFINES += APPLICATION_VERSION=\\\"\"1.5.0\\\"\"
+DEFINES += ORGANIZATION_NAME=\\\"\"$$QMAKE_TARGET_COMPANY\\\"\"
+DEFINES += ORGANIZATION_DOMAIN=\\\"\"$$QMAKE_TARGET_DOMAIN\\\"\"
+
+INCLUDEPATH += $$PWD/../src
+
+SOURCES += $$files($$PWD/../src/*.cpp)
+SOURCES -= $$PWD/../src/main.cpp
+
+HEADERS += $$files($$PWD/../src/*.h)
+
+RESOURCES += \
+    $$PWD/../resources/resources.qrc
+
+unix {
+   LIBS += -lxcb -lz
+   QT += x11extras
+}
+
+win32 {
+   LIBS += user32.lib
+   INCLUDEPATH += $$[QT_INSTALL_HEADERS]/QtZlib
+}
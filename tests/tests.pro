@@ -0,0 +1,15 @@
+#
+# \file tests.pro
+#
+# \copyright 2016 Lukas Geyer. All rights reseverd.
+# \license This program is free software; you can redistribute it and/or modify
+#          it under the terms of the GNU General Public License version 3 as
+#          published by the Free Software Foundation.
+#
+
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    benchmarks \
+    fastxmlitemsource \
+    linkitem